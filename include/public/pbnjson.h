@@ -111,6 +111,8 @@ The following examples will show how to use it.
 #include "pbnjson/c/jparse_stream.h"
 #include "pbnjson/c/jvalue_stringify.h"
 #include "pbnjson/c/jquery.h"
+#include "pbnjson/c/jindex.h"
+#include "pbnjson/c/jtape.h"
 
 
 #endif /* PJSONC_H_ */
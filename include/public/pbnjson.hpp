@@ -100,6 +100,7 @@ The following examples will show how to use it.
 #include "pbnjson/cxx/JGenerator.h"
 #include "pbnjson/cxx/JSchema.h"
 #include "pbnjson/cxx/JDomParser.h"
+#include "pbnjson/cxx/JSaxParser.h"
 #include "pbnjson/cxx/JSchemaFile.h"
 #include "pbnjson/cxx/JSchemaFragment.h"
 #include "pbnjson/cxx/JResolver.h"
@@ -49,6 +49,12 @@ typedef enum {
 	 * structure will be m_len + 1 (m_str[m_len] is 0)
 	 */
 	DOMOPT_INPUT_NULL_TERMINATED,
+	/**
+	 * Indicates that the DOM won't leave the thread, which parses it, until
+	 * it's passed to jvalue_share(). Its reference counts aren't updated
+	 * atomically.
+	 */
+	DOMOPT_THREAD_CONFINED = 4,
 } JDOMOptimization;
 
 /**
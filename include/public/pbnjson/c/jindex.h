@@ -0,0 +1,88 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef INCLUDE_PUBLIC_PBNJSON_C_JINDEX_H_
+#define INCLUDE_PUBLIC_PBNJSON_C_JINDEX_H_
+
+#include <sys/types.h>
+#include "japi.h"
+#include "jtypes.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * Secondary indexes over long-lived DOMs.
+ *
+ * An index finds the object members with the key anywhere in the DOM by their
+ * values, without walking the DOM. It's built, when it's created, and dropped
+ * when any container of the DOM is modified (jobject_set(), jobject_remove(),
+ * jarray_put() etc.), to be built again on the next use. The index may be used
+ * from several threads, as long as the DOM isn't modified meanwhile.
+ *
+ * Frozen DOMs (see jvalue_freeze()) can't be indexed. The frozen values within
+ * an indexed DOM are indexed, but aren't watched: thawing and modifying them
+ * needs a new index.
+ *
+ * jquery_init() uses the index of its JSON for the queries ".key:val(value)".
+ */
+
+typedef struct jindex *jindex_ref;
+
+/**
+ * @brief Create an index of the members with the key in the DOM
+ *
+ * @param root The DOM to index. The index holds a reference to it.
+ * @param key The key of the members to index
+ * @return The index to be freed with jindex_free(), or NULL if the DOM is frozen
+ */
+PJSON_API jindex_ref jindex_create(jvalue_ref root, raw_buffer key);
+
+/**
+ * @brief Release the index
+ *
+ * @param index The index, may be NULL
+ */
+PJSON_API void jindex_free(jindex_ref index);
+
+/**
+ * @brief Count the members with the key, which are equal to the value
+ *
+ * @param index The index
+ * @param value The value to look for
+ * @return Number of the members
+ */
+PJSON_API ssize_t jindex_count(jindex_ref index, jvalue_ref value);
+
+/**
+ * @brief Find an object, whose member with the key is equal to the value
+ *
+ * The objects come in the order, in which jquery visits them.
+ *
+ * @param index The index
+ * @param value The value to look for
+ * @param i Number of the object, from 0 to jindex_count() - 1
+ * @return The object owned by the DOM, or invalid value (see jis_valid)
+ */
+PJSON_API jvalue_ref jindex_get(jindex_ref index, jvalue_ref value, ssize_t i);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_PUBLIC_PBNJSON_C_JINDEX_H_ */
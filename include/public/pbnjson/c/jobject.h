@@ -96,6 +96,68 @@ extern "C" {
  */
 PJSON_API jvalue_ref jvalue_copy(jvalue_ref val);
 
+/**
+ * @brief Prepare a thread-confined DOM to be used by other threads.
+ *
+ * The reference counts of a DOM created with #DOMOPT_THREAD_CONFINED aren't
+ * updated atomically, so it must be used only by the thread, that created it.
+ * This switches the value and everything in it to atomic counting. A confined
+ * value, that is put into a shared container, is shared automatically.
+ *
+ * @note Call it before the value, or any value within it, becomes visible
+ *       to another thread.
+ *
+ * @param val The value to share
+ */
+PJSON_API void jvalue_share(jvalue_ref val);
+
+/**
+ * @brief Turn the value into an immutable snapshot, that can be read by any
+ *        number of threads without reference counting.
+ *
+ * The value and everything in it is frozen in place. jvalue_copy() and
+ * j_release() leave frozen values untouched, so readers don't contend for
+ * their reference counts, and the functions modifying containers
+ * (jobject_put(), jarray_remove() etc.) fail for them. The snapshot is
+ * immortal until jvalue_thaw() is called for it. The keys of the objects,
+ * which are immutable and may be shared with other DOMs, stay reference
+ * counted.
+ *
+ * The library doesn't store anything within the frozen values: they're
+ * serialized without the fragment cache, and jindex_create() refuses them.
+ * Only jvalue_stringify() and jvalue_prettify() still keep their result in
+ * the value, use jvalue_stringify_to() or jvalue_stringify_sink() from
+ * several threads instead. Freezing is idempotent.
+ *
+ * @note Call it before the value becomes visible to other threads.
+ *
+ * @param val The value to freeze
+ */
+PJSON_API void jvalue_freeze(jvalue_ref val);
+
+/**
+ * @brief Make the frozen value mutable and reference counted again.
+ *
+ * The reference count of the value is the one it had, when it was frozen:
+ * the references taken while it was frozen aren't counted, and mustn't be
+ * released after it. Call it when no other thread uses the snapshot anymore,
+ * and release the snapshot with j_release() afterwards, if needed.
+ *
+ * @note Thawing a value, that is also a part of another frozen value, is not
+ *       supported: the other snapshot would become mutable too.
+ *
+ * @param val The value to thaw
+ */
+PJSON_API void jvalue_thaw(jvalue_ref val);
+
+/**
+ * @brief Check whether the value is frozen (see jvalue_freeze()).
+ *
+ * @param val The value to check
+ * @return true if the value is frozen
+ */
+PJSON_API bool jvalue_is_frozen(jvalue_ref val);
+
 /**
  * @brief Create a deep copy of the JSON value.
  *
@@ -253,6 +315,29 @@ PJSON_API bool jvalue_apply_schema(jvalue_ref val, const JSchemaInfoRef schema)
  */
 PJSON_API bool jvalue_validate_apply(jvalue_ref val, const jschema_ref schema, jerror **err) NON_NULL(1, 2);
 
+/**
+ * @brief Check validity of several values against the same schema.
+ *
+ * The values are checked one after another in the calling thread, or split
+ * between @p threads worker threads. The schema is frozen (see jschema_freeze)
+ * before it is shared by the threads; if that fails, the values are checked in the
+ * calling thread. Freezing is idempotent, so the same schema may be used by
+ * several batches at once.
+ *
+ * @param vals Values to check
+ * @param count Number of the values
+ * @param schema A schema
+ * @param results Array of @p count elements to store the validity of every value into
+ * @param errs Array of @p count elements to store the errors of the invalid values into
+ *             (may be NULL). The caller frees them with jerror_free.
+ * @param threads Number of the worker threads, 0 or 1 to check in the calling thread
+ * @return Number of the valid values
+ *
+ * @see jvalue_validate
+ */
+PJSON_API size_t jvalue_validate_batch(const jvalue_ref *vals, size_t count, const jschema_ref schema,
+                                       bool *results, jerror **errs, unsigned threads) NON_NULL(1, 3, 4);
+
 /**
  * @brief Equivalent to JSON.stringify within Javascript.
  *
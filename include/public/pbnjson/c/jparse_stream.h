@@ -85,6 +85,23 @@ PJSON_API jvalue_ref jdom_parse_file(const char *file, JSchemaInfoRef schemaInfo
  */
 PJSON_API jvalue_ref jdom_create(raw_buffer input, const jschema_ref schema, jerror **err) NON_NULL(2);
 
+/**
+ * @brief Returns the DOM structure of the JSON document.
+ *
+ * The same as jdom_create(), with additional information about the DOM.
+ *
+ * @param input The input string to parse.
+ * @param schema The schema to use for validation of the input.
+ * @param optimizationMode Only #DOMOPT_THREAD_CONFINED is taken into account, the input is always copied.
+ * @param err Error pointer. Will be set to non-null value in case of failure.
+ * @return An opaque reference handle to the DOM.  Use jis_valid to determine whether or
+ *         not parsing succeeded.
+ *
+ * @see jvalue_share
+ */
+PJSON_API jvalue_ref jdom_create_ex(raw_buffer input, const jschema_ref schema,
+                                    JDOMOptimizationFlags optimizationMode, jerror **err) NON_NULL(2);
+
 /**
  * @brief Returns the DOM structure of the JSON document.
  *
@@ -126,6 +143,27 @@ PJSON_API bool jsax_parse_with_callbacks(raw_buffer input, const jschema_ref sch
                                          PJSAXCallbacks *callbacks, void *callback_ctxt,
                                          jerror **err) NON_NULL(2);
 
+/**
+ * @brief Check validity of several JSON texts against the same schema.
+ *
+ * Every input is parsed without building a DOM, like jsax_parse_with_callbacks
+ * without callbacks. The inputs are split between @p threads worker threads the
+ * same way as by jvalue_validate_batch.
+ *
+ * @param inputs Texts to check
+ * @param count Number of the texts
+ * @param schema The schema to use for validation of the inputs
+ * @param results Array of @p count elements to store the validity of every input into
+ * @param errs Array of @p count elements to store the errors of the invalid inputs into
+ *             (may be NULL). The caller frees them with jerror_free.
+ * @param threads Number of the worker threads, 0 or 1 to check in the calling thread
+ * @return Number of the valid inputs
+ *
+ * @see jvalue_validate_batch
+ */
+PJSON_API size_t jsax_validate_batch(const raw_buffer *inputs, size_t count, const jschema_ref schema,
+                                     bool *results, jerror **errs, unsigned threads) NON_NULL(1, 3, 4);
+
 /**
  * @brief Parse the input using SAX callbacks.  Much faster in that no memory is allocated for a DOM & data is
  * processed on the fly, but less flexible & more complicated to handle in some cases.
@@ -19,6 +19,7 @@
 
 #include "jerror.h"
 #include "jobject.h"
+#include "jschema_types.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -63,6 +64,102 @@ jvalue_ref jquery_next(jquery_ptr query);
  */
 void jquery_free(jquery_ptr query);
 
+typedef struct jquery_cursor* jquery_cursor_ref;
+
+/**
+ * @brief Start an evaluation of the compiled query over the JSON.
+ *
+ * The cursor keeps the state of the evaluation on its own, the query itself
+ * isn't changed. So any number of cursors may be created from one query and
+ * used independently, also from different threads. The compiled query and the
+ * selector contexts are shared with the query, so it must outlive the cursors.
+ *
+ * @param query Compiled query
+ * @param JSON JSON to evaluate the query over. The cursor holds a reference to it.
+ * @param err pbnjson error information.
+ * @return Pointer to the cursor, or NULL on error
+ */
+jquery_cursor_ref jquery_cursor_new(jquery_ptr query, jvalue_ref JSON, jerror **err);
+
+/**
+ * @brief Get next query result
+ * @param cursor Pointer to the cursor
+ * @return next jvalue owned by the JSON, or invalid value (see jis_valid) at the end
+ */
+jvalue_ref jquery_cursor_next(jquery_cursor_ref cursor);
+
+/**
+ * @brief Copy the cursor. The copy continues from the same position on its own.
+ * @param cursor Pointer to the cursor
+ * @return New cursor
+ */
+jquery_cursor_ref jquery_cursor_copy(jquery_cursor_ref cursor);
+
+/**
+ * @brief Free the cursor
+ * @param cursor Pointer to the cursor, it's set to NULL
+ */
+void jquery_cursor_release(jquery_cursor_ref *cursor);
+
+typedef struct jquery_stream* jquery_stream_ref;
+
+/**
+ * @brief Create a parser, that evaluates the query while the JSON text is fed.
+ *
+ * No DOM is built for the document, only the matched values are. Selectors,
+ * which depend on the following part of the document (":has", ":empty",
+ * ":only-child", ":last-child", ":nth-last-child", ":expr", ":val" with an object
+ * or an array, and the sibling combinator "~") can't be decided on the fly.
+ * Queries with them are evaluated over the whole document once it's parsed.
+ *
+ * @param query Query to evaluate. It must outlive the stream, and mustn't be
+ *              used for anything else until the stream is released.
+ * @param schema The schema to use for validation of the input.
+ * @param err pbnjson error information.
+ * @return Pointer to the stream, or NULL on error
+ */
+jquery_stream_ref jquery_stream_new(jquery_ptr query, const jschema_ref schema, jerror **err);
+
+/**
+ * @brief Parse the next part of the JSON text
+ * @param stream Pointer to the stream
+ * @param buf Input buffer
+ * @param buf_len Input buffer length
+ * @return false on error
+ */
+bool jquery_stream_feed(jquery_stream_ref stream, const char *buf, int buf_len);
+
+/**
+ * @brief Finalize parsing of the JSON text
+ * @param stream Pointer to the stream
+ * @return false on error
+ */
+bool jquery_stream_end(jquery_stream_ref stream);
+
+/**
+ * @brief Take the next value matched by the query.
+ *
+ * The values come in the document order, as soon as they're parsed completely.
+ *
+ * @param stream Pointer to the stream
+ * @return The value to be released with j_release, or invalid value
+ *         (see jis_valid) if no more values are ready yet
+ */
+jvalue_ref jquery_stream_next(jquery_stream_ref stream);
+
+/**
+ * @brief Return error description, when jquery_stream_feed/jquery_stream_end has returned false
+ * @param stream Pointer to the stream
+ * @return Pointer to string with error description, owned by the stream
+ */
+const char *jquery_stream_get_error(jquery_stream_ref stream);
+
+/**
+ * @brief Release the stream with the values not taken yet
+ * @param stream Pointer to the stream
+ */
+void jquery_stream_release(jquery_stream_ref *stream);
+
 #ifdef __cplusplus
 }
 #endif
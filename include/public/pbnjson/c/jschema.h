@@ -214,6 +214,93 @@ PJSON_API jschema_ref jschema_jcreate(jvalue_ref input, jerror **err);
  */
 PJSON_API jschema_ref jschema_fcreate(const char *file, jerror **err);
 
+/**
+ * Creates schemas from a set of files, which refer to each other.
+ *
+ * The files are parsed simultaneously by a pool of worker threads. Then references
+ * between them are resolved in one pass without calling the resolver: every schema
+ * is known by its name in @p files, and "$ref"s are relative to that name. For instance,
+ * "../common.json#/definitions/id" in "net/config.json" refers to "common.json". The
+ * names should be normalized relative paths. The schemas are frozen (see jschema_freeze)
+ * afterwards.
+ *
+ * @param dir The directory, which contains the files (may be NULL)
+ * @param files Names of the schema files relative to @p dir
+ * @param count Number of the files
+ * @param schemas Array of @p count elements to store the created schemas into
+ * @param resolver Resolver for the documents missing from the set (may be NULL)
+ * @param err pbnjson error information
+ * @return true if all the schemas have been created and resolved. Otherwise none is
+ *         returned, all the elements of @p schemas are NULL.
+ */
+PJSON_API bool jschema_fcreate_batch(const char *dir, const char * const *files, size_t count,
+                                     jschema_ref *schemas, JSchemaResolverRef resolver, jerror **err);
+
+/**
+ * Makes the schema safe to use from several threads simultaneously.
+ *
+ * All the references of the schema get bound to their targets, so that validation
+ * never modifies the schema. Call it after jschema_resolve, the schema can be
+ * shared between any number of threads afterwards. Schemas from the cache
+ * (see jschema_cache_clear) are frozen already. Freezing is idempotent: the
+ * references are bound by the first successful call only, the later ones
+ * return right away and may be made while other threads use the schema.
+ *
+ * @param schema The schema to freeze
+ * @param err pbnjson error information
+ * @return false if the schema has unresolved external references, or
+ *         references to missing definitions
+ */
+PJSON_API bool jschema_freeze(jschema_ref schema, jerror **err);
+
+/** @brief Number of the schemas kept by the schema cache by default, see jschema_cache_set_capacity() */
+#define JSCHEMA_CACHE_DEFAULT_CAPACITY 64
+
+/**
+ * Drops all the schemas remembered by the process-wide schema cache.
+ *
+ * Self-contained schemas (ones without unresolved external references) created by
+ * jschema_create, jschema_fcreate, jschema_parse and friends are kept in the cache
+ * keyed by the hash of their text and root scope, so that the same schema isn't
+ * parsed twice. The schemas already handed out stay valid.
+ */
+PJSON_API void jschema_cache_clear(void);
+
+/**
+ * Limits the number of the schemas remembered by the process-wide schema cache.
+ *
+ * When the cache is full, the least recently used schema is dropped from it.
+ * The schemas already handed out stay valid. The capacity is
+ * #JSCHEMA_CACHE_DEFAULT_CAPACITY by default, 0 turns the caching off.
+ *
+ * @param capacity Maximum number of the cached schemas
+ */
+PJSON_API void jschema_cache_set_capacity(size_t capacity);
+
+/**
+ * Stores the schema in the precompiled binary form.
+ *
+ * The precompiled schema can be loaded with jschema_fload_compiled without parsing
+ * and resolving the schema text again. The schema must not have unresolved external
+ * references. The format depends on the library version and the architecture.
+ *
+ * @param schema The schema to store
+ * @param file The file path to write the precompiled schema to
+ * @param err pbnjson error information
+ * @return true if the schema was stored successfully
+ */
+PJSON_API bool jschema_fsave_compiled(jschema_ref schema, const char *file, jerror **err);
+
+/**
+ * Loads the schema stored by jschema_fsave_compiled.
+ *
+ * @param file The file path to the precompiled schema
+ * @param err pbnjson error information
+ * @return A reference to the schema that can be used, or NULL, if the file can't be read,
+ *         is corrupted or was produced by an incompatible library build
+ */
+PJSON_API jschema_ref jschema_fload_compiled(const char *file, jerror **err);
+
 #ifdef __cplusplus
 }
 #endif
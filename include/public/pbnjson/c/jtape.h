@@ -0,0 +1,266 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef INCLUDE_PUBLIC_PBNJSON_C_JTAPE_H_
+#define INCLUDE_PUBLIC_PBNJSON_C_JTAPE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "japi.h"
+#include "jobject.h"
+#include "jerror.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * Compact read-only documents.
+ *
+ * A tape keeps a parsed JSON as a flat array of 64-bit words, one per value,
+ * and a slab with the texts of the strings, keys and numbers. Arrays and
+ * objects know where they end, so any value is skipped in one step, without
+ * looking into it. Keys and short values, which repeat, share their texts.
+ * A tape takes a fraction of the memory of the DOM created by jdom_create().
+ *
+ * The tape is stored in a single block of memory (see jtape_image()), which
+ * can be written to a file, and read back with jtape_fopen() or jtape_open()
+ * without any parsing. The image uses the byte order of the
+ * host, an image written on a host of the other byte order is rejected as
+ * damaged.
+ *
+ * The values are reached through cursors. A cursor is a small structure
+ * passed by value, it stays valid as long as the tape does.
+ *
+ * @code
+ * jtape_ref tape = jtape_create(j_cstr_to_buffer("{\"a\": [1, \"two\"]}"), jschema_all(), NULL);
+ * jtape_cursor two = jtape_array_get(jtape_object_get(jtape_root(tape), J_CSTR_TO_BUF("a")), 1);
+ * raw_buffer text = jtape_get_string(two);
+ * jtape_free(tape);
+ * @endcode
+ */
+
+typedef struct jtape *jtape_ref;
+
+/**
+ * @brief Position of a value within a tape.
+ *
+ * The fields are internal. A cursor, that doesn't point to a value, is
+ * invalid (see jtape_is_valid()).
+ */
+typedef struct {
+	jtape_ref m_tape;
+	size_t m_pos;      ///< Word of the value
+	size_t m_key;      ///< Word of the key of an object member, or 0
+	size_t m_end;      ///< Word after the last sibling of the value
+} jtape_cursor;
+
+/**
+ * @brief Parse the input into a tape
+ *
+ * @param input The input string to parse
+ * @param schema The schema to validate the input against
+ * @param err pbnjson error information
+ * @return The tape to be freed with jtape_free(), or NULL if the input isn't
+ *         valid JSON, or isn't accepted by the schema
+ */
+PJSON_API jtape_ref jtape_create(raw_buffer input, const jschema_ref schema, jerror **err) NON_NULL(2);
+
+/**
+ * @brief Read the tape stored by jtape_image()
+ *
+ * The image isn't copied, it has to outlive the tape. It has to be aligned
+ * to 8 bytes, like the memory returned by malloc() and mmap() is.
+ *
+ * @param image The image of a tape
+ * @param err pbnjson error information
+ * @return The tape to be freed with jtape_free(), or NULL if the image is
+ *         damaged
+ */
+PJSON_API jtape_ref jtape_open(raw_buffer image, jerror **err);
+
+/**
+ * @brief Map the file with the tape stored by jtape_image()
+ *
+ * @param file The path to the file
+ * @param err pbnjson error information
+ * @return The tape to be freed with jtape_free(), which unmaps the file, or
+ *         NULL if the file can't be mapped or is damaged
+ */
+PJSON_API jtape_ref jtape_fopen(const char *file, jerror **err) NON_NULL(1);
+
+/**
+ * @brief Release the tape
+ *
+ * @param tape The tape, may be NULL
+ */
+PJSON_API void jtape_free(jtape_ref tape);
+
+/**
+ * @brief Get the memory block with the tape
+ *
+ * @param tape The tape, may be NULL
+ * @return The image owned by the tape, to be read with jtape_open(), or an
+ *         empty buffer if the tape is NULL
+ */
+PJSON_API raw_buffer jtape_image(jtape_ref tape);
+
+/**
+ * @brief Get the top-level value of the tape
+ *
+ * @param tape The tape
+ * @return The cursor of the value
+ */
+PJSON_API jtape_cursor jtape_root(jtape_ref tape) NON_NULL(1);
+
+/**
+ * @brief Check whether the cursor points to a value
+ *
+ * @param cur The cursor
+ * @return false for the cursors returned for missing values
+ */
+PJSON_API bool jtape_is_valid(jtape_cursor cur);
+
+/**
+ * @brief Get the type of the value
+ *
+ * @param cur The cursor
+ * @return The type of the value, JV_NULL for invalid cursors
+ */
+PJSON_API JValueType jtape_type(jtape_cursor cur);
+
+/**
+ * @brief Get the number of the elements of an array, or members of an object
+ *
+ * @param cur The cursor
+ * @return The size of the container, or -1 if the value isn't a container
+ */
+PJSON_API ssize_t jtape_size(jtape_cursor cur);
+
+/**
+ * @brief Get the element of the array
+ *
+ * The elements before it are skipped without looking into them, so the cost
+ * grows with the index. Walk the array with jtape_first() and jtape_next() to
+ * visit every element.
+ *
+ * @param cur The cursor of an array
+ * @param index The index of the element
+ * @return The cursor of the element, invalid if there's no such element
+ */
+PJSON_API jtape_cursor jtape_array_get(jtape_cursor cur, ssize_t index);
+
+/**
+ * @brief Get the value of the member of the object
+ *
+ * Objects with many members keep a sorted table of their keys in the tape,
+ * and are searched by it in logarithmic time. The smaller ones are searched
+ * member by member. The first one of the members with the same key is found.
+ *
+ * @param cur The cursor of an object
+ * @param key The key of the member
+ * @return The cursor of the value, invalid if there's no such member
+ */
+PJSON_API jtape_cursor jtape_object_get(jtape_cursor cur, raw_buffer key);
+
+/**
+ * @brief Get the first element of an array, or the value of the first member
+ *        of an object
+ *
+ * @param cur The cursor of a container
+ * @return The cursor of the child, invalid for empty containers
+ */
+PJSON_API jtape_cursor jtape_first(jtape_cursor cur);
+
+/**
+ * @brief Get the next element of the array, or the value of the next member
+ *        of the object
+ *
+ * @param cur The cursor of a child of a container
+ * @return The cursor of the next child, invalid after the last one
+ */
+PJSON_API jtape_cursor jtape_next(jtape_cursor cur);
+
+/**
+ * @brief Get the key of the object member
+ *
+ * @param cur The cursor of the value of the member
+ * @return The key, or NULL buffer, if the value isn't an object member
+ */
+PJSON_API raw_buffer jtape_key(jtape_cursor cur);
+
+/**
+ * @brief Get the text of the string
+ *
+ * The text is terminated with zero, and is owned by the tape.
+ *
+ * @param cur The cursor of a string
+ * @return The text, or NULL buffer, if the value isn't a string
+ */
+PJSON_API raw_buffer jtape_get_string(jtape_cursor cur);
+
+/**
+ * @brief Get the number as it's written in the input
+ *
+ * @param cur The cursor of a number
+ * @return The text, or NULL buffer, if the value isn't a number
+ */
+PJSON_API raw_buffer jtape_get_number_raw(jtape_cursor cur);
+
+/**
+ * @brief Convert the number to 64-bit integer
+ *
+ * @param cur The cursor of a number
+ * @param number The result of the conversion
+ * @return The conversion result, as jnumber_get_i64() does
+ */
+PJSON_API ConversionResultFlags jtape_get_i64(jtape_cursor cur, int64_t *number) NON_NULL(2);
+
+/**
+ * @brief Convert the number to double
+ *
+ * @param cur The cursor of a number
+ * @param number The result of the conversion
+ * @return The conversion result, as jnumber_get_f64() does
+ */
+PJSON_API ConversionResultFlags jtape_get_f64(jtape_cursor cur, double *number) NON_NULL(2);
+
+/**
+ * @brief Get the value of the boolean
+ *
+ * @param cur The cursor
+ * @return true if the value is true, false otherwise
+ */
+PJSON_API bool jtape_get_bool(jtape_cursor cur);
+
+/**
+ * @brief Build a DOM of the value
+ *
+ * The nesting depth of the value isn't limited, the conversion doesn't recurse.
+ *
+ * @param cur The cursor
+ * @return The new value owned by the caller, invalid value for invalid
+ *         cursors (see jis_valid)
+ */
+PJSON_API jvalue_ref jtape_to_jvalue(jtape_cursor cur);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INCLUDE_PUBLIC_PBNJSON_C_JTAPE_H_ */
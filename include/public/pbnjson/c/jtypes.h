@@ -38,6 +38,7 @@ typedef struct jvalue* jvalue_ref;
 
 typedef struct jsaxparser *jsaxparser_ref;
 typedef struct jdomparser *jdomparser_ref;
+typedef struct jserializer *jserializer_ref;
 
 /**
   * @brief Iterator through JSON DOM object
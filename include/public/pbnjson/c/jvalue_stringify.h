@@ -17,7 +17,13 @@
 #ifndef INCLUDE_PUBLIC_PBNJSON_C_JVALUE_STRINGIFY_H_
 #define INCLUDE_PUBLIC_PBNJSON_C_JVALUE_STRINGIFY_H_
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
 #include "japi.h"
+#include "jtypes.h"
+#include "jerror.h"
+#include "jschema_types.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,6 +34,13 @@ extern "C" {
  *        to it's equivalent string representation that is ready to be transferred
  *        across the wire (with all appropriate escaping and quoting performed).
  *
+ * This is the caching call: the result is kept in the value until the next call or
+ * modification of the value, so that a full copy of the text lives as long as the value.
+ * Use jvalue_stringify_drop() to release it earlier. Callers, which don't need the text
+ * to live with the value, use jvalue_stringify_to(), jvalue_stringify_sink() or
+ * jvalue_prettify_sink() instead, which store nothing in the value, as the library
+ * itself does.
+ *
  * @param val A reference to the JSON object to convert to a string
  * @return The string representation of the value with a life-time limited by life-time of jvalue_ref or moment of its modification
  */
@@ -39,6 +52,9 @@ PJSON_API const char* jvalue_stringify(jvalue_ref val);
  *        across the wire (with all appropriate escaping and quoting performed).
  *        Like jvalue_stringify, but with pretty-print option.
  *
+ * The result is cached in the value like by jvalue_stringify(), see
+ * jvalue_prettify_sink() for the serialization without it.
+ *
  * @param val     A reference to the JSON object to convert to a string
  * @param indent  An Indent for pretty-printed format. Allowed symbols: \\n, \\v, \\f, \\t, \\r and space.
  *                  Combinations of them are permitted as well.
@@ -46,6 +62,151 @@ PJSON_API const char* jvalue_stringify(jvalue_ref val);
  */
 PJSON_API const char* jvalue_prettify(jvalue_ref val, const char *indent);
 
+/**
+ * @brief Like jvalue_stringify, but serializes again only the containers modified since the last call.
+ *
+ * Every array and object in the value keeps its own text without the nested
+ * containers. The text is dropped when the container is modified (jobject_set(),
+ * jobject_remove(), jarray_put() etc.), and the unchanged containers are copied
+ * from the cache. This pays off for big values, which are published again after
+ * small changes, at the cost of about one more copy of the text in memory.
+ *
+ * @param val A reference to the JSON value to convert to a string
+ * @return The string representation of the value with a life-time limited by life-time of jvalue_ref or moment of its modification
+ */
+PJSON_API const char* jvalue_stringify_incremental(jvalue_ref val);
+
+/**
+ * @brief Serialization plan compiled from a schema, see jstringify_plan_new()
+ */
+typedef struct jstringify_plan *jstringify_plan_ref;
+
+/**
+ * @brief Compile a serialization plan for the values described by the schema.
+ *
+ * The plan keeps the escaped keys of the properties from "properties" and the
+ * expected types of the values, so that jvalue_stringify_planned() copies the
+ * keys instead of escaping them and skips the type checks. The plan doesn't refer
+ * to the schema, and can be used from several threads simultaneously.
+ *
+ * @param schema The schema, all the external references must be resolved
+ * @param err pbnjson error information
+ * @return The plan to be released with jstringify_plan_release(), or NULL on error
+ */
+PJSON_API jstringify_plan_ref jstringify_plan_new(jschema_ref schema, jerror **err);
+
+/**
+ * @brief Release the plan created by jstringify_plan_new
+ *
+ * @param plan The pointer to the plan, set to NULL afterwards
+ */
+PJSON_API void jstringify_plan_release(jstringify_plan_ref *plan);
+
+/**
+ * @brief Like jvalue_stringify, but follows the serialization plan.
+ *
+ * The output is the same as of jvalue_stringify() for any value. The parts of the
+ * value, which don't match the plan (unknown keys, unexpected types), are serialized
+ * generically.
+ *
+ * @param val A reference to the JSON value to convert to a string
+ * @param plan The plan created by jstringify_plan_new
+ * @return The string representation of the value with a life-time limited by life-time of jvalue_ref or moment of its modification
+ */
+PJSON_API const char* jvalue_stringify_planned(jvalue_ref val, jstringify_plan_ref plan);
+
+/**
+ * @brief Release the strings cached by jvalue_stringify(), jvalue_prettify() or jvalue_stringify_incremental().
+ *
+ * @param val A reference to the JSON value, NULL is allowed
+ */
+PJSON_API void jvalue_stringify_drop(jvalue_ref val);
+
+/**
+ * @brief Like jvalue_stringify, but writes into the caller's buffer and caches nothing.
+ *
+ * The output is null-terminated if it fits into the buffer. Otherwise the buffer contents
+ * is unspecified, and the required length is returned, so that the call may be repeated
+ * with a buffer at least (*len + 1) bytes long.
+ *
+ * @param val A reference to the JSON value to convert to a string
+ * @param buf The buffer for the output
+ * @param cap Size of the buffer
+ * @param[out] len Length of the output without the terminating zero (may be NULL)
+ * @return true if the output fits into the buffer
+ */
+PJSON_API bool jvalue_stringify_to(jvalue_ref val, char *buf, size_t cap, size_t *len);
+
+/**
+ * @brief Receiver of the jvalue_stringify_sink() output.
+ *
+ * @param ctxt The context passed to jvalue_stringify_sink()
+ * @param data The next piece of the output, not null-terminated
+ * @param len Length of the piece
+ * @return false to stop the serialization
+ */
+typedef bool (*jvalue_output_cb)(void *ctxt, const char *data, size_t len);
+
+/**
+ * @brief Like jvalue_stringify, but passes the output in pieces to the callback and caches nothing.
+ *
+ * Concatenation of the pieces is the same as the jvalue_stringify() result. Short
+ * pieces are collected in a small buffer on stack, long strings are passed through
+ * without copying.
+ *
+ * @param val A reference to the JSON value to convert to a string
+ * @param output The receiver of the output
+ * @param ctxt The context for the receiver
+ * @return false if the value is NULL or the receiver stopped the serialization
+ */
+PJSON_API bool jvalue_stringify_sink(jvalue_ref val, jvalue_output_cb output, void *ctxt);
+
+/**
+ * @brief Like jvalue_prettify, but passes the output to the callback and caches nothing.
+ *
+ * @param val A reference to the JSON value to convert to a string
+ * @param indent An indent for pretty-printed format as for jvalue_prettify(), or NULL
+ *               for the compact output of jvalue_stringify_sink()
+ * @param output The receiver of the output
+ * @param ctxt The context for the receiver
+ * @return false if the value is NULL or the receiver stopped the serialization
+ */
+PJSON_API bool jvalue_prettify_sink(jvalue_ref val, const char *indent, jvalue_output_cb output, void *ctxt);
+
+/**
+ * @brief Create a serializer, that produces the jvalue_stringify() output on demand.
+ *
+ * Unlike jvalue_stringify_sink(), the caller pulls the output when it is ready to
+ * accept it, e.g. when a non-blocking socket becomes writable. The memory used by the
+ * serializer depends on the depth of the value, not on the size of the output. Long
+ * strings are escaped in slices.
+ *
+ * The serializer keeps a reference to the value. The value must not be modified
+ * until the serializer is released.
+ *
+ * @param val A reference to the JSON value to serialize
+ * @return The serializer to be released with jserializer_release(), or NULL
+ */
+PJSON_API jserializer_ref jserializer_new(jvalue_ref val);
+
+/**
+ * @brief Take the next chunk of the output.
+ *
+ * @param serializer The serializer created by jserializer_new()
+ * @param buf The buffer for the chunk, not null-terminated
+ * @param cap Size of the buffer
+ * @return Count of bytes written to the buffer, which is less than cap only at the end of
+ *         the output, 0 if the output is over, or -1 on error
+ */
+PJSON_API ssize_t jserializer_read(jserializer_ref serializer, char *buf, size_t cap);
+
+/**
+ * @brief Release the serializer created by jserializer_new
+ *
+ * @param serializer The pointer to the serializer, set to NULL afterwards
+ */
+PJSON_API void jserializer_release(jserializer_ref *serializer);
+
 #ifdef __cplusplus
 }
 #endif
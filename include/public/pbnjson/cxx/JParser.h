@@ -43,6 +43,7 @@ class JSchemaResolverWrapper;
  * into JSON primitives that the caller is responsible for handling.
  *
  * @see JDomParser
+ * @see JSaxParser for the callbacks, that don't copy the strings
  */
 class PJSONCXX_API JParser
 {
@@ -83,24 +83,60 @@ public:
 
 	/**
 	 * JQuery iterator
+	 *
+	 * Every iterator returned by JQuery::begin keeps its own state of the
+	 * evaluation, so several iterators of one query may be used at once, also
+	 * from different threads. A copy of an iterator continues from the same
+	 * position on its own.
 	 */
 	class iterator : public std::iterator<std::forward_iterator_tag, JValue>
 	{
 	private:
 		jvalue_ref _c;
 		jquery_ptr _q;
+		jquery_cursor_ref _cursor;
 
 	public:
 		iterator(jquery_ptr q)
 			: _q(q)
+			, _cursor(NULL)
 		{
 			if (_q) _c = jquery_next(_q);
 			else    _c = jinvalid();
 		}
 
+		/**
+		 * Start a new evaluation of the query over the JSON
+		 */
+		iterator(jquery_ptr q, jvalue_ref JSON)
+			: _q(NULL)
+			, _cursor(jquery_cursor_new(q, JSON, NULL))
+		{
+			_c = _cursor ? jquery_cursor_next(_cursor) : jinvalid();
+		}
+
+		iterator(const iterator& other)
+			: _c(other._c)
+			, _q(other._q)
+			, _cursor(other._cursor ? jquery_cursor_copy(other._cursor) : NULL)
+		{ }
+
+		~iterator()
+		{
+			jquery_cursor_release(&_cursor);
+		}
+
+		iterator& operator=(iterator other)
+		{
+			std::swap(_c, other._c);
+			std::swap(_q, other._q);
+			std::swap(_cursor, other._cursor);
+			return *this;
+		}
+
 		iterator& operator++()
 		{
-			_c = jquery_next(_q);
+			_c = _cursor ? jquery_cursor_next(_cursor) : jquery_next(_q);
 			return *this;
 		}
 
@@ -116,10 +152,24 @@ public:
 	 *
 	 * \retval iterator
 	 */
-	iterator begin()
+	iterator begin() const
+	{
+		return m_query && m_jval
+			? iterator(m_query, m_jval)
+			: iterator(0);
+	}
+
+	/**
+	 * Returns an iterator to the first query result for the JSON.
+	 * Doesn't change the query, so it may be called from different threads.
+	 *
+	 * \param JSON JSON object
+	 * \retval iterator
+	 */
+	iterator begin(const JValue& JSON) const
 	{
-		return m_query && jquery_init(m_query, m_jval, 0)
-			? iterator(m_query)
+		return m_query
+			? iterator(m_query, JSON.m_jval)
 			: iterator(0);
 	}
 
@@ -129,7 +179,7 @@ public:
 	 *
 	 * \retval iterator
 	 */
-	iterator end()
+	iterator end() const
 	{ return iterator(0); }
 };
 
@@ -0,0 +1,193 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef JSAXPARSER_H_
+#define JSAXPARSER_H_
+
+#include <limits>
+
+#include "pbnjson.h"
+#include "JSchema.h"
+#include "JInput.h"
+
+namespace pbnjson {
+
+/**
+ * The JSaxParser class template represents SAX JSON parser with statically
+ * dispatched callbacks.
+ *
+ * Unlike JParser, the keys, strings and numbers are passed to the callbacks as
+ * views of the parser buffers, and no std::string is built for them. The views
+ * are valid only during the call. The handler derives publicly from
+ * JSaxParser<Handler> and hides the callbacks it's interested in, the rest of
+ * them accept anything. There're no virtual calls, so the callbacks of the
+ * handler can be inlined.
+ *
+ * @code
+ * struct KeyCounter : JSaxParser<KeyCounter>
+ * {
+ *     size_t count = 0;
+ *     bool jsonObjectKey(raw_buffer key) { ++count; return true; }
+ * };
+ *
+ * KeyCounter counter;
+ * counter.parse(R"({"a": 1, "b": {"c": 2}})");
+ * @endcode
+ *
+ * @see JParser
+ */
+template <typename Handler>
+class JSaxParser
+{
+public:
+	/**
+	 * Initialize a parser with the concrete schema.
+	 */
+	explicit JSaxParser(const JSchema &schema = JSchema::AllSchema())
+		: m_schema(schema)
+		, m_parser(NULL)
+	{}
+
+	JSaxParser(const JSaxParser &) = delete;
+	JSaxParser &operator=(const JSaxParser &) = delete;
+
+	~JSaxParser()
+	{
+		reset();
+	}
+
+	/**
+	 * @brief Parse the input
+	 *
+	 * @param input The input string to parse
+	 *
+	 * @retval true if the JSON input was valid and accepted by the schema.
+	 * @retval false if the JSON input was mailformed, wasn't accepted by the schema, or a callback has returned false.
+	 */
+	bool parse(const JInput &input)
+	{
+		return jsax_parse_with_callbacks(input, m_schema.peek(), saxCallbacks(), static_cast<Handler *>(this), NULL);
+	}
+
+	/**
+	 * @brief Feed next chunk of the JSON from the stream.
+	 *
+	 * @param input data input buffer
+	 *
+	 * @retval true on success
+	 * @retval false on error
+	 */
+	bool feed(const JInput &input)
+	{
+		if (input.m_len > static_cast<size_t>(std::numeric_limits<int>::max()))
+			return false;
+		return saxStream() && jsaxparser_feed(m_parser, input.m_str, static_cast<int>(input.m_len));
+	}
+
+	/**
+	 * @brief Finalize stream parsing. This indicates the end of
+	 * the JSON. Perform final schema check.
+	 *
+	 * @retval true on success
+	 * @retval false on error
+	 */
+	bool end()
+	{
+		return saxStream() && jsaxparser_end(m_parser);
+	}
+
+	/**
+	 * @brief Prepare the parser to parse the next JSON from a stream.
+	 */
+	void reset()
+	{
+		if (m_parser)
+			jsaxparser_release(&m_parser);
+	}
+
+	/**
+	 * @brief Return error description if feed or end have returned false.
+	 *
+	 * @return error description, or NULL
+	 */
+	char const *getError() const
+	{
+		return m_parser ? jsaxparser_get_error(m_parser) : NULL;
+	}
+
+	/*
+	 * SAX parser callbacks. Each of them returns true if parsing should continue
+	 * and false if parsing should be discontinued. Schema validation occurs just
+	 * before they are called.
+	 */
+
+	/// Called when a valid object open token { is encountered
+	bool jsonObjectOpen() { return true; }
+	/// Called when a valid property instance name is encountered
+	bool jsonObjectKey(raw_buffer key) { return true; }
+	/// Called when a valid object close token } is encountered
+	bool jsonObjectClose() { return true; }
+	/// Called when a valid array open token [ is encountered
+	bool jsonArrayOpen() { return true; }
+	/// Called when a valid array close token ] is encountered
+	bool jsonArrayClose() { return true; }
+	/// Called when a valid non-object-key string is encountered
+	bool jsonString(raw_buffer s) { return true; }
+	/// Called when a valid number is encountered. The numeric string is passed untouched.
+	bool jsonNumber(raw_buffer n) { return true; }
+	/// Called when a valid boolean is encountered
+	bool jsonBoolean(bool truth) { return true; }
+	/// Called when a valid null is encountered
+	bool jsonNull() { return true; }
+
+private:
+	JSchema m_schema;
+	jsaxparser_ref m_parser;
+
+	bool saxStream()
+	{
+		if (!m_parser)
+			m_parser = jsaxparser_new(m_schema.peek(), saxCallbacks(), static_cast<Handler *>(this));
+		return m_parser != NULL;
+	}
+
+	static Handler *saxHandler(JSAXContextRef ctxt)
+	{
+		return static_cast<Handler *>(jsax_getContext(ctxt));
+	}
+
+	static int saxObjStart(JSAXContextRef ctxt) { return saxHandler(ctxt)->jsonObjectOpen(); }
+	static int saxObjKey(JSAXContextRef ctxt, const char *key, size_t len) { return saxHandler(ctxt)->jsonObjectKey(j_str_to_buffer(key, len)); }
+	static int saxObjEnd(JSAXContextRef ctxt) { return saxHandler(ctxt)->jsonObjectClose(); }
+	static int saxArrStart(JSAXContextRef ctxt) { return saxHandler(ctxt)->jsonArrayOpen(); }
+	static int saxArrEnd(JSAXContextRef ctxt) { return saxHandler(ctxt)->jsonArrayClose(); }
+	static int saxString(JSAXContextRef ctxt, const char *str, size_t len) { return saxHandler(ctxt)->jsonString(j_str_to_buffer(str, len)); }
+	static int saxNumber(JSAXContextRef ctxt, const char *num, size_t len) { return saxHandler(ctxt)->jsonNumber(j_str_to_buffer(num, len)); }
+	static int saxBoolean(JSAXContextRef ctxt, bool value) { return saxHandler(ctxt)->jsonBoolean(value); }
+	static int saxNull(JSAXContextRef ctxt) { return saxHandler(ctxt)->jsonNull(); }
+
+	static PJSAXCallbacks *saxCallbacks()
+	{
+		static PJSAXCallbacks callbacks = {
+			saxObjStart, saxObjKey, saxObjEnd, saxArrStart, saxArrEnd, saxString, saxNumber, saxBoolean, saxNull,
+		};
+		return &callbacks;
+	}
+};
+
+}
+
+#endif /* JSAXPARSER_H_ */
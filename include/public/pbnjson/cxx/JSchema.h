@@ -22,6 +22,8 @@
 #include "JResult.h"
 #include "JInput.h"
 
+#include <vector>
+
 namespace pbnjson {
 
 class JValue;
@@ -36,6 +38,8 @@ class JResolver;
  * Javascript-style comments are allowed within schemas.
  *
  * @note Not thread safe. Do not share instances of this class between threads.
+ *       Copies of a frozen schema (see freeze()) can be used by different threads
+ *       simultaneously.
  */
 
 class PJSONCXX_API JSchema : public JResult
@@ -103,6 +107,14 @@ public:
 	 */
 	static JSchema fromFile(const char *file);
 
+	/**
+	 * @brief Loads the schema precompiled with jschema_fsave_compiled.
+	 *
+	 * @param file The file path to the precompiled schema
+	 * @return Loaded schema
+	 */
+	static JSchema fromCompiledFile(const char *file);
+
 	/**
 	 * @brief Creates DOM structure of the schema from a JSON object.
 	 *
@@ -119,6 +131,17 @@ public:
 	 */
 	bool resolve(JResolver &resolver);
 
+	/**
+	 * @brief Make the underlying schema safe to validate from several threads.
+	 *
+	 * Call it after resolve(). The wrapper object itself still shouldn't be shared,
+	 * give every thread its own copy of it instead.
+	 *
+	 * @return true, if all the references of the schema could be bound
+	 * @see jschema_freeze
+	 */
+	bool freeze();
+
 	/**
 	 * @brief Check validity of JValue against the schema.
 	 *
@@ -128,6 +151,16 @@ public:
 	 */
 	JResult validate(const JValue &value) const;
 
+	/**
+	 * @brief Check validity of several JValues against the schema.
+	 *
+	 * @param values JSON values to check
+	 * @param threads Number of the worker threads, 0 or 1 to check in the calling thread
+	 * @return JResult for every value, in the same order
+	 * @see jvalue_validate_batch
+	 */
+	std::vector<JResult> validateBatch(const std::vector<JValue> &values, unsigned threads = 0) const;
+
 	/**
 	 * @brief Check validity of JValue against the schema.
 	 *        Insert default values specified by the schema into the JSON object.
@@ -258,6 +258,21 @@ public:
 	 */
 	JValue duplicate() const;
 
+	/**
+	 * Turn the JSON value into an immutable snapshot, that can be copied by
+	 * any number of threads without reference counting.
+	 *
+	 * @see jvalue_freeze
+	 */
+	void freeze();
+
+	/**
+	 * Make the frozen JSON value mutable and reference counted again.
+	 *
+	 * @see jvalue_thaw
+	 */
+	void thaw();
+
 	/**
 	 * Swap this instance of JSON value with provided one
 	 *
@@ -519,6 +534,28 @@ public:
 	 * @return True if this object represents a JSON array and the element was successfully inserted at the requested location.
 	 */
 	bool put(size_t index, const JValue& value);
+
+	/**
+	 * Insert a JSON value into this array, taking it over.
+	 *
+	 * The value isn't copied, and is left null. The rest is the same as for
+	 * put(size_t, const JValue&).
+	 */
+	bool put(long i, JValue&& value)
+	{
+		if (i < 0)
+			return false;
+		return put((size_t)i, std::move(value));
+	}
+
+	/// @see put(long, JValue&&)
+	bool put(int i, JValue&& value)
+	{
+		return put((long)i, std::move(value));
+	}
+
+	/// @see put(long, JValue&&)
+	bool put(size_t index, JValue&& value);
 	//@}
 
 	//{@
@@ -557,6 +594,21 @@ public:
 	{
 		return put(std::string(key), value);
 	}
+
+	/**
+	 * Add a key/value pair to a JSON object, taking the value over.
+	 *
+	 * The value isn't copied, and is left null. The rest is the same as for
+	 * put(const JValue&, const JValue&). A key, which is put often, can be kept
+	 * as a JValue and shared by the objects instead of creating it every time.
+	 */
+	bool put(const JValue& key, JValue&& value);
+
+	/// @see put(const JValue&, JValue&&)
+	bool put(const std::string& key, JValue&& value);
+
+	/// @see put(const JValue&, JValue&&)
+	bool put(const char *key, JValue&& value);
 	//@}
 
 	/**
@@ -609,6 +661,14 @@ public:
 	 */
 	JValue& operator<<(const JValue& element);
 
+	/**
+	 * Convenience method for appending an element to an array, taking it over.
+	 *
+	 * @see operator<<(const JValue&)
+	 * @see append(JValue&&)
+	 */
+	JValue& operator<<(JValue&& element);
+
 	/**
 	 * Convenience method for appending an element to an array.
 	 *
@@ -634,6 +694,14 @@ public:
 	 */
 	JValue& operator<<(const KeyValue& pair);
 
+	/**
+	 * Convenience method for adding a key-value pair to an object, taking the value over.
+	 *
+	 * @see operator<<(const KeyValue&)
+	 * @see put(const std::string&, JValue&&)
+	 */
+	JValue& operator<<(KeyValue&& pair);
+
 	/**
 	 * Convenience method for appending to a JSON array.
 	 *
@@ -642,6 +710,16 @@ public:
 	 */
 	bool append(const JValue& value);
 
+	/**
+	 * Convenience method for appending to a JSON array, taking the value over.
+	 *
+	 * The value isn't copied, and is left null.
+	 *
+	 * @param[in] value The JSON value to append to this array
+	 * @return True if this value is an array & the value was added successfully.
+	 */
+	bool append(JValue&& value);
+
 	/**
 	 * Determines whether or not this JSON value is valid. Parsing functions can return invalid json object if an error occurs
 	 * @return True if this is an invalid value, false otherwise
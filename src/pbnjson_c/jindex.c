@@ -0,0 +1,309 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+#include <pthread.h>
+#include <jobject.h>
+
+#include "jindex_internal.h"
+#include "liblog.h"
+
+/* Every container of the indexed DOM keeps the list of the indexes, which
+ * cover it, and every index keeps the list of the containers. When any of the
+ * containers is modified, the index forgets everything and unlinks itself,
+ * until it's built again. The root stays linked to its indexes all the time,
+ * so that they're found by jquery.
+ *
+ * The index is built again by its first reader, which may race with the other
+ * ones (jquery cursors over the same DOM, for instance). The building is
+ * serialized by a lock, which also guards the lists of the indexes of the
+ * containers shared by several indexes, including the root.
+ */
+struct jindex
+{
+	jvalue_ref root;
+	jvalue_ref key;
+	gint built;             // atomic, the index may be read without the lock
+	GHashTable *scalars;    // value of the member -> GArray of JIndexEntry
+	GArray *containers;     // JIndexEntry with arrays and objects, compared one by one
+	GPtrArray *watched;     // containers below the root linked to the index, not referenced
+};
+
+static GSList **container_indexes(jvalue_ref container)
+{
+	return container->m_type == JV_ARRAY ? &jarray_deref(container)->m_indexes
+	                                     : &jobject_deref(container)->m_indexes;
+}
+
+static guint value_hash(gconstpointer key)
+{
+	jvalue_ref value = (jvalue_ref) key;
+	switch (value->m_type)
+	{
+	case JV_STR:
+		return ObjKeyHash(value);
+	case JV_NUM:
+	{
+		// Numbers are equal by their values, whatever the representation is
+		double number = 0;
+		jnumber_get_f64(value, &number);
+		if (number == 0)
+			number = 0;
+		guint64 bits;
+		memcpy(&bits, &number, sizeof(bits));
+		return (guint) (bits ^ (bits >> 32));
+	}
+	case JV_BOOL:
+		return jboolean_deref_to_value(value) ? 1 : 2;
+	default:
+		return 0;
+	}
+}
+
+static gboolean value_equal(gconstpointer a, gconstpointer b)
+{
+	return jvalue_equal((jvalue_ref) a, (jvalue_ref) b);
+}
+
+static void entries_free(gpointer data)
+{
+	g_array_free((GArray *) data, TRUE);
+}
+
+static void index_watch(jindex_ref index, jvalue_ref container)
+{
+	// Frozen containers can't be modified, and aren't written to by the readers
+	if (container == index->root || container->m_frozen)
+		return;
+
+	GSList **indexes = container_indexes(container);
+	*indexes = g_slist_prepend(*indexes, index);
+	g_ptr_array_add(index->watched, container);
+}
+
+static void index_clear(jindex_ref index)
+{
+	for (guint i = 0; i < index->watched->len; ++i)
+	{
+		GSList **indexes = container_indexes((jvalue_ref) g_ptr_array_index(index->watched, i));
+		*indexes = g_slist_remove(*indexes, index);
+	}
+	g_ptr_array_set_size(index->watched, 0);
+	g_hash_table_remove_all(index->scalars);
+	g_array_set_size(index->containers, 0);
+	g_atomic_int_set(&index->built, FALSE);
+}
+
+static void index_add(jindex_ref index, jvalue_ref owner, jvalue_ref value)
+{
+	JIndexEntry entry = { owner, value };
+	if (jis_object(value) || jis_array(value))
+	{
+		g_array_append_val(index->containers, entry);
+		return;
+	}
+
+	GArray *entries = (GArray *) g_hash_table_lookup(index->scalars, value);
+	if (!entries)
+	{
+		entries = g_array_new(FALSE, FALSE, sizeof(JIndexEntry));
+		g_hash_table_insert(index->scalars, value, entries);
+	}
+	g_array_append_val(entries, entry);
+}
+
+// The nodes are visited in the same order as by jquery
+static void index_build(jindex_ref index, jvalue_ref node)
+{
+	if (jis_array(node))
+	{
+		index_watch(index, node);
+		ssize_t size = jarray_size(node);
+		for (ssize_t i = 0; i < size; ++i)
+			index_build(index, jarray_get(node, i));
+	}
+	else if (jis_object(node))
+	{
+		index_watch(index, node);
+		jobject_iter it;
+		jobject_key_value key_value;
+		jobject_iter_init(&it, node);
+		while (jobject_iter_next(&it, &key_value))
+		{
+			if (ObjKeyEqual(key_value.key, index->key))
+				index_add(index, node, key_value.value);
+			index_build(index, key_value.value);
+		}
+	}
+}
+
+static pthread_mutex_t index_build_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// The lock is held
+static void index_build_root(jindex_ref index)
+{
+	if (!g_atomic_int_get(&index->built))
+	{
+		index_build(index, index->root);
+		g_atomic_int_set(&index->built, TRUE);
+	}
+}
+
+static void index_ensure_built(jindex_ref index)
+{
+	if (g_atomic_int_get(&index->built))
+		return;
+
+	pthread_mutex_lock(&index_build_mutex);
+	index_build_root(index);
+	pthread_mutex_unlock(&index_build_mutex);
+}
+
+void jindex_invalidate(GSList **indexes)
+{
+	if (!*indexes)
+		return;
+
+	// The indexes remove themselves from the list, unless it's their root
+	pthread_mutex_lock(&index_build_mutex);
+	GSList *list = g_slist_copy(*indexes);
+	for (GSList *l = list; l; l = l->next)
+		index_clear((jindex_ref) l->data);
+	g_slist_free(list);
+	pthread_mutex_unlock(&index_build_mutex);
+}
+
+jindex_ref jindex_create(jvalue_ref root, raw_buffer key)
+{
+	CHECK_POINTER_RETURN_NULL(root);
+	CHECK_POINTER_RETURN_NULL(key.m_str);
+	CHECK_CONDITION_RETURN_VALUE(root->m_frozen, NULL, "Attempt to index frozen value %p", root);
+
+	jindex_ref index = g_new0(struct jindex, 1);
+	index->root = jvalue_copy(root);
+	index->key = jstring_create_copy(key);
+	index->scalars = g_hash_table_new_full(value_hash, value_equal, NULL, entries_free);
+	index->containers = g_array_new(FALSE, FALSE, sizeof(JIndexEntry));
+	index->watched = g_ptr_array_new();
+	if (jis_object(root) || jis_array(root))
+	{
+		pthread_mutex_lock(&index_build_mutex);
+		GSList **indexes = container_indexes(root);
+		*indexes = g_slist_prepend(*indexes, index);
+		pthread_mutex_unlock(&index_build_mutex);
+	}
+	index_ensure_built(index);
+	return index;
+}
+
+void jindex_free(jindex_ref index)
+{
+	if (!index)
+		return;
+	pthread_mutex_lock(&index_build_mutex);
+	index_clear(index);
+	if (jis_object(index->root) || jis_array(index->root))
+	{
+		GSList **indexes = container_indexes(index->root);
+		*indexes = g_slist_remove(*indexes, index);
+	}
+	pthread_mutex_unlock(&index_build_mutex);
+	g_hash_table_destroy(index->scalars);
+	g_array_free(index->containers, TRUE);
+	g_ptr_array_free(index->watched, TRUE);
+	j_release(&index->key);
+	j_release(&index->root);
+	g_free(index);
+}
+
+static JIndexEntry *index_find(jindex_ref index, jvalue_ref value, ssize_t i)
+{
+	index_ensure_built(index);
+
+	if (jis_object(value) || jis_array(value))
+	{
+		for (guint j = 0; j < index->containers->len; ++j)
+		{
+			JIndexEntry *entry = &g_array_index(index->containers, JIndexEntry, j);
+			if (jvalue_equal(entry->value, value) && i-- == 0)
+				return entry;
+		}
+		return NULL;
+	}
+
+	GArray *entries = (GArray *) g_hash_table_lookup(index->scalars, value);
+	if (!entries || i < 0 || (guint) i >= entries->len)
+		return NULL;
+	return &g_array_index(entries, JIndexEntry, i);
+}
+
+ssize_t jindex_count(jindex_ref index, jvalue_ref value)
+{
+	CHECK_POINTER_RETURN_VALUE(index, 0);
+	CHECK_POINTER_RETURN_VALUE(value, 0);
+
+	if (jis_object(value) || jis_array(value))
+	{
+		ssize_t count = 0;
+		while (index_find(index, value, count))
+			++count;
+		return count;
+	}
+
+	index_ensure_built(index);
+	GArray *entries = (GArray *) g_hash_table_lookup(index->scalars, value);
+	return entries ? entries->len : 0;
+}
+
+jvalue_ref jindex_get(jindex_ref index, jvalue_ref value, ssize_t i)
+{
+	CHECK_POINTER_RETURN_VALUE(index, jinvalid());
+	CHECK_POINTER_RETURN_VALUE(value, jinvalid());
+
+	JIndexEntry *entry = index_find(index, value, i);
+	return entry ? entry->owner : jinvalid();
+}
+
+bool jindex_lookup_entries(jvalue_ref root, raw_buffer key, jvalue_ref value, GArray **entries)
+{
+	if (!jis_object(root) && !jis_array(root))
+		return false;
+
+	// The index may be freed or built again by another thread, as soon as
+	// the lock is released
+	bool found = false;
+	pthread_mutex_lock(&index_build_mutex);
+	for (GSList *l = *container_indexes(root); l; l = l->next)
+	{
+		jindex_ref index = (jindex_ref) l->data;
+		raw_buffer index_key = jstring_get_fast(index->key);
+		if (index->root != root || index_key.m_len != key.m_len || memcmp(index_key.m_str, key.m_str, key.m_len) != 0)
+			continue;
+
+		index_build_root(index);
+		GArray *matched = (GArray *) g_hash_table_lookup(index->scalars, value);
+		*entries = NULL;
+		if (matched)
+		{
+			*entries = g_array_sized_new(FALSE, FALSE, sizeof(JIndexEntry), matched->len);
+			g_array_append_vals(*entries, matched->data, matched->len);
+		}
+		found = true;
+		break;
+	}
+	pthread_mutex_unlock(&index_build_mutex);
+	return found;
+}
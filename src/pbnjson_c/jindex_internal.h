@@ -0,0 +1,41 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef JINDEX_INTERNAL_H_
+#define JINDEX_INTERNAL_H_
+
+#include <stdbool.h>
+#include <glib.h>
+#include <jindex.h>
+
+#include "jobject_internal.h"
+
+typedef struct
+{
+	jvalue_ref owner;   // object with the member
+	jvalue_ref value;   // value of the member
+} JIndexEntry;
+
+/* Find the members with the key and the scalar value by an index of the root.
+ *
+ * Returns false, if there's no such index. Otherwise *entries is set to a copy
+ * of the array of JIndexEntry in the document order, or to NULL if nothing is
+ * found. The caller frees the copy with g_array_free(). The values in it live
+ * until the DOM is modified.
+ */
+PJSON_LOCAL bool jindex_lookup_entries(jvalue_ref root, raw_buffer key, jvalue_ref value, GArray **entries);
+
+#endif /* JINDEX_INTERNAL_H_ */
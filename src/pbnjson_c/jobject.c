@@ -179,6 +179,8 @@ void jvalue_init (jvalue_ref val, JValueType type)
 {
 	val->m_refCnt = 1;
 	val->m_type = type;
+	val->m_confined = false;
+	val->m_frozen = false;
 }
 
 jvalue_ref jvalue_copy (jvalue_ref val)
@@ -188,12 +190,110 @@ jvalue_ref jvalue_copy (jvalue_ref val)
 	SANITY_CHECK_POINTER(val);
 	assert(s_inGdb || val->m_refCnt > 0);
 
-	if (jis_const(val)) return val;
+	if (jis_const(val) || val->m_frozen) return val;
 
-	g_atomic_int_inc(&val->m_refCnt);
+	if (val->m_confined)
+		++val->m_refCnt;
+	else
+		g_atomic_int_inc(&val->m_refCnt);
 	return val;
 }
 
+void jvalue_confine(jvalue_ref val)
+{
+	if (val && !jis_const(val))
+		val->m_confined = true;
+}
+
+void jvalue_share(jvalue_ref val)
+{
+	CHECK_POINTER(val);
+
+	// Nothing shared contains confined values, see jvalue_adopt()
+	if (jis_const(val) || !val->m_confined)
+		return;
+
+	val->m_confined = false;
+	if (jis_array(val))
+	{
+		for (ssize_t i = 0; i < jarray_size(val); i++)
+			jvalue_share(jarray_get(val, i));
+	}
+	else if (jis_object(val))
+	{
+		jobject_iter it;
+		jobject_key_value key_value;
+		jobject_iter_init(&it, val);
+		while (jobject_iter_next(&it, &key_value))
+		{
+			jvalue_share(key_value.key);
+			jvalue_share(key_value.value);
+		}
+	}
+}
+
+/* Set or clear m_frozen of the value and everything in it. A frozen container
+ * can't get unfrozen children, so the walk stops at the values, that are
+ * in the requested state already.
+ *
+ * The keys are immutable anyway, and are left counted: the parsed ones are
+ * interned, and shared with unrelated DOMs, other threads may be copying and
+ * releasing them meanwhile.
+ */
+static void jvalue_set_frozen(jvalue_ref val, bool frozen)
+{
+	if (jis_const(val) || val->m_frozen == frozen)
+		return;
+
+	// Frozen values are never counted, there's nothing to confine
+	val->m_confined = false;
+	val->m_frozen = frozen;
+	if (jis_array(val))
+	{
+		for (ssize_t i = 0; i < jarray_size(val); i++)
+			jvalue_set_frozen(jarray_get(val, i), frozen);
+	}
+	else if (jis_object(val))
+	{
+		jobject_iter it;
+		jobject_key_value key_value;
+		jobject_iter_init(&it, val);
+		while (jobject_iter_next(&it, &key_value))
+		{
+			// Readers count the keys, they have to do it atomically
+			if (frozen)
+				jvalue_share(key_value.key);
+			jvalue_set_frozen(key_value.value, frozen);
+		}
+	}
+}
+
+void jvalue_freeze(jvalue_ref val)
+{
+	CHECK_POINTER(val);
+	jvalue_set_frozen(val, true);
+}
+
+void jvalue_thaw(jvalue_ref val)
+{
+	CHECK_POINTER(val);
+	jvalue_set_frozen(val, false);
+}
+
+bool jvalue_is_frozen(jvalue_ref val)
+{
+	return val && val->m_frozen;
+}
+
+/* A confined value, which is put into a shared container, is shared too.
+ * Otherwise it could be reached from other threads.
+ */
+static inline void jvalue_adopt(jvalue_ref parent, jvalue_ref child)
+{
+	if (!parent->m_confined)
+		jvalue_share(child);
+}
+
 jvalue_ref jvalue_duplicate (jvalue_ref val)
 {
 	jvalue_ref result = val;
@@ -210,7 +310,8 @@ jvalue_ref jvalue_duplicate (jvalue_ref val)
 		while (jobject_iter_next(&it, &pair))
 		{
 			jvalue_ref valueCopy = jvalue_duplicate (pair.value);
-			if (!jobject_put (result, jvalue_copy (pair.key), valueCopy)) {
+			jvalue_ref keyCopy = jvalue_copy (pair.key);
+			if (!jobject_put (result, keyCopy, valueCopy)) {
 				j_release (&result);
 				result = NULL;
 				break;
@@ -320,14 +421,14 @@ void j_release (jvalue_ref *val)
 		SANITY_KILL_POINTER(*val);
 		return;
 	}
-	if (UNLIKELY(jis_const(*val))) {
+	if (UNLIKELY(jis_const(*val) || (*val)->m_frozen)) {
 		SANITY_KILL_POINTER(*val);
 		return;
 	}
 
 	assert((*val)->m_refCnt > 0);
 
-	if (g_atomic_int_dec_and_test(&(*val)->m_refCnt)) {
+	if ((*val)->m_confined ? --(*val)->m_refCnt == 0 : g_atomic_int_dec_and_test(&(*val)->m_refCnt)) {
 		TRACE_REF("freeing because refcnt is 0: %s", *val, jvalue_tostring(*val, jschema_all()));
 		_jbuffer *str = &(*val)->m_string;
 		if (str->destructor) {
@@ -465,7 +566,9 @@ static bool check_insert_sanity(jvalue_ref parent, jvalue_ref child)
 
 static void j_destroy_object (jvalue_ref ref)
 {
+	jindex_invalidate(&jobject_deref(ref)->m_indexes);
 	g_hash_table_destroy(jobject_deref(ref)->m_members);
+	jfragment_release(&jobject_deref(ref)->m_fragment);
 }
 
 /* Has table key routines */
@@ -718,6 +821,7 @@ bool jobject_remove (jvalue_ref obj, raw_buffer key)
 
 	CHECK_CONDITION_RETURN_VALUE(jis_null(obj), false, "Attempt to cast null %p to object", obj);
 	CHECK_CONDITION_RETURN_VALUE(!jis_object(obj), false, "Attempt to cast type %d to object (%d)", obj->m_type, JV_OBJECT);
+	CHECK_CONDITION_RETURN_VALUE(obj->m_frozen, false, "Attempt to modify frozen object %p", obj);
 
 	if (!jobject_deref(obj)->m_members)
 		return false;
@@ -734,6 +838,8 @@ bool jobject_remove (jvalue_ref obj, raw_buffer key)
 		},
 	};
 
+	jfragment_release(&jobject_deref(obj)->m_fragment);
+	jindex_invalidate(&jobject_deref(obj)->m_indexes);
 	return g_hash_table_remove(jobject_deref(obj)->m_members, &jkey.m_value);
 }
 
@@ -795,6 +901,11 @@ bool jobject_put (jvalue_ref obj, jvalue_ref key, jvalue_ref val)
 			break;
 		}
 
+		if (UNLIKELY(obj->m_frozen)) {
+			PJ_LOG_ERR("Attempt to modify frozen object %p", obj);
+			break;
+		}
+
 		if (UNLIKELY(key == NULL)) {
 			PJ_LOG_ERR("Invalid API use: null pointer");
 			break;
@@ -827,6 +938,10 @@ bool jobject_put (jvalue_ref obj, jvalue_ref key, jvalue_ref val)
 			break;
 		}
 
+		jvalue_adopt(obj, key);
+		jvalue_adopt(obj, val);
+		jfragment_release(&jobject_deref(obj)->m_fragment);
+		jindex_invalidate(&jobject_deref(obj)->m_indexes);
 		g_hash_table_replace(jobject_deref(obj)->m_members, key, val);
 		return true;
 	} while (false);
@@ -897,6 +1012,8 @@ static void j_destroy_array (jvalue_ref arr)
 
 	for (int i = jarray_size_unsafe(arr) - 1; i >= 0; i--)
 		jarray_remove_unsafe(arr, i);
+	jfragment_release(&jarray_deref(arr)->m_fragment);
+	jindex_invalidate(&jarray_deref(arr)->m_indexes);
 
 	assert(jarray_size_unsafe(arr) == 0);
 
@@ -1038,6 +1155,8 @@ static inline void jarray_size_decrement_unsafe (jvalue_ref arr)
 	assert(arr != NULL);
 	assert(arr->m_type == JV_ARRAY);
 
+	jfragment_release(&jarray_deref(arr)->m_fragment);
+	jindex_invalidate(&jarray_deref(arr)->m_indexes);
 	--jarray_deref(arr)->m_size;
 
 	assert(jarray_size_unsafe(arr) >= 0);
@@ -1086,6 +1205,9 @@ static void jarray_remove_unsafe (jvalue_ref arr, ssize_t index)
 
 	assert(valid_index_bounded(arr, index));
 
+	jfragment_release(&jarray_deref(arr)->m_fragment);
+	jindex_invalidate(&jarray_deref(arr)->m_indexes);
+
 	hole = jarray_get_unsafe (arr, index);
 	assert (hole != NULL);
 	j_release (hole);
@@ -1109,6 +1231,7 @@ static void jarray_remove_unsafe (jvalue_ref arr, ssize_t index)
 bool jarray_remove (jvalue_ref arr, ssize_t index)
 {
 	CHECK_CONDITION_RETURN_VALUE(!valid_index_bounded(arr, index), false, "Attempt to get array element from %p with out-of-bounds index value %zd", arr, index);
+	CHECK_CONDITION_RETURN_VALUE(arr->m_frozen, false, "Attempt to modify frozen array %p", arr);
 
 	jarray_remove_unsafe (arr, index);
 
@@ -1148,6 +1271,11 @@ static bool jarray_put_unsafe (jvalue_ref arr, ssize_t index, jvalue_ref val)
 	SANITY_CHECK_POINTER(arr);
 	assert(jis_array(arr));
 
+	if (UNLIKELY(arr->m_frozen)) {
+		PJ_LOG_ERR("Attempt to modify frozen array %p", arr);
+		return false;
+	}
+
 	if (!check_insert_sanity(arr, val)) {
 		PJ_LOG_ERR("Error in object hierarchy. Inserting jvalue would create an illegal cyclic dependency");
 		return false;
@@ -1158,6 +1286,10 @@ static bool jarray_put_unsafe (jvalue_ref arr, ssize_t index, jvalue_ref val)
 		return false;
 	}
 
+	jvalue_adopt(arr, val);
+	jfragment_release(&jarray_deref(arr)->m_fragment);
+	jindex_invalidate(&jarray_deref(arr)->m_indexes);
+
 	old = jarray_get_unsafe(arr, index);
 	j_release(old);
 	*old = val;
@@ -1173,6 +1305,7 @@ bool jarray_set (jvalue_ref arr, ssize_t index, jvalue_ref val)
 
 	CHECK_CONDITION_RETURN_VALUE(!jis_array(arr), false, "Attempt to get array size of non-array %p", arr);
 	CHECK_CONDITION_RETURN_VALUE(index < 0, false, "Attempt to set array element for %p with negative index value %zd", arr, index);
+	CHECK_CONDITION_RETURN_VALUE(arr->m_frozen, false, "Attempt to modify frozen array %p", arr);
 
 	if (UNLIKELY(val == NULL)) {
 		PJ_LOG_WARN("incorrect API use - please pass an actual reference to a JSON null if that's what you want - assuming that's what you meant");
@@ -1250,6 +1383,7 @@ bool jarray_insert(jvalue_ref arr, ssize_t index, jvalue_ref val)
 
 	CHECK_CONDITION_RETURN_VALUE(!jis_array(arr), false, "Array to insert into isn't a valid reference to a JSON DOM node: %p", arr);
 	CHECK_CONDITION_RETURN_VALUE(index < 0, false, "Invalid index - must be >= 0: %zd", index);
+	CHECK_CONDITION_RETURN_VALUE(arr->m_frozen, false, "Attempt to modify frozen array %p", arr);
 
 	if (!check_insert_sanity(arr, val)) {
 		PJ_LOG_ERR("Error in object hierarchy. Inserting jvalue would create an illegal cyclic dependency");
@@ -1260,6 +1394,7 @@ bool jarray_insert(jvalue_ref arr, ssize_t index, jvalue_ref val)
 		jvalue_ref *toMove, *hole;
 		// we increment the size of the array
 		jarray_put_unsafe(arr, jarray_size_unsafe(arr), jinvalid());
+		jvalue_adopt(arr, val);
 
 		// stopping at the first jis_null as an optimization is actually
 		// wrong because we change the array structure.  we have to move up
@@ -1312,6 +1447,8 @@ bool jarray_splice (jvalue_ref array, ssize_t index, ssize_t toRemove, jvalue_re
 	CHECK_CONDITION_RETURN_VALUE(!valid_index_bounded(array2, begin), false, "Start index is invalid for second array");
 	CHECK_CONDITION_RETURN_VALUE(!valid_index_bounded(array2, end - 1), false, "End index is invalid for second array");
 	CHECK_CONDITION_RETURN_VALUE(toRemove < 0, false, "Invalid amount %zd to remove during splice", toRemove);
+	CHECK_CONDITION_RETURN_VALUE(array->m_frozen, false, "Attempt to modify frozen array %p", array);
+	CHECK_CONDITION_RETURN_VALUE(ownership == SPLICE_TRANSFER && array2->m_frozen, false, "Attempt to transfer elements of frozen array %p", array2);
 
 	if (!jarray_splice_check_insert_sanity(array, array2)) {
 		PJ_LOG_ERR("Error in object hierarchy. Splicing array would create an illegal cyclic dependency");
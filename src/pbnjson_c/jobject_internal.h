@@ -33,7 +33,12 @@ typedef struct _jbuffer {
 } _jbuffer;
 
 struct jvalue {
-	JValueType m_type;
+	JValueType m_type : 8;
+	// The value is owned by one thread, and m_refCnt isn't updated atomically
+	// (see jvalue_share)
+	unsigned int m_confined : 1;
+	// The value is immutable, and m_refCnt isn't updated at all (see jvalue_freeze)
+	unsigned int m_frozen : 1;
 	int m_refCnt;
 	_jbuffer m_string;
 	_jbuffer m_file;
@@ -42,6 +47,9 @@ struct jvalue {
 typedef struct PJSON_LOCAL jvalue jvalue;
 typedef struct PJSON_LOCAL dom_string_memory_pool dom_string_memory_pool;
 
+/** @brief Cached text of a container, see jwriter_write_value_cached() */
+typedef struct _JFragment JFragment;
+
 typedef struct PJSON_LOCAL {
 	// m_value should always be the first field
 	jvalue m_value;
@@ -92,6 +100,8 @@ typedef struct PJSON_LOCAL {
 	jvalue_ref *m_bigBucket;
 	ssize_t m_size;
 	ssize_t m_capacity;
+	JFragment *m_fragment;
+	GSList *m_indexes;        // indexes, which cover the array, see jindex.h
 } jarray;
 
 _Static_assert(offsetof(jarray, m_value) == 0, "jarray and jarray.m_value should have the same addresses");
@@ -100,6 +110,8 @@ typedef struct PJSON_LOCAL {
 	// m_value should always be the first field
 	jvalue m_value;
 	GHashTable *m_members;
+	JFragment *m_fragment;
+	GSList *m_indexes;        // indexes, which cover the object, see jindex.h
 } jobject;
 
 _Static_assert(offsetof(jobject, m_value) == 0, "jobject and jobject.m_value should have the same addresses");
@@ -129,6 +141,13 @@ inline static jarray* jarray_deref(jvalue_ref array) { return (jarray*)array; }
 inline static jobject* jobject_deref(jvalue_ref array) { return (jobject*)array; }
 
 void _jbuffer_munmap(_jbuffer *buf);
+
+/** @brief Forget the cached text of a container, e.g. when it is modified */
+PJSON_LOCAL void jfragment_release(JFragment **fragment);
+/** @brief Drop the indexes covering a container, when it is modified */
+PJSON_LOCAL void jindex_invalidate(GSList **indexes);
+/** @brief Mark the value created for a thread-confined DOM, see DOMOPT_THREAD_CONFINED */
+PJSON_LOCAL void jvalue_confine(jvalue_ref val);
 void _jbuffer_free(_jbuffer *buf);
 
 jvalue_ref jstring_create_from_pool_internal(dom_string_memory_pool *pool, const char* data, size_t len);
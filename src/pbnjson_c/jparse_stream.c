@@ -78,6 +78,13 @@ static inline jvalue_ref createOptimalNumber(dom_string_memory_pool* pool, JDOMO
 	return jnumber_create(j_str_to_buffer(str, strLen));
 }
 
+static inline jvalue_ref createConfined(DomInfo *data, jvalue_ref val)
+{
+	if (data->m_optInformation & DOMOPT_THREAD_CONFINED)
+		jvalue_confine(val);
+	return val;
+}
+
 static inline DomInfo* getDOMInfo(JSAXContextRef ctxt)
 {
 	struct jdomcontext* dctxt = (struct jdomcontext*)jsax_getContext(ctxt);
@@ -176,7 +183,7 @@ int dom_number(JSAXContextRef ctxt, const char *number, size_t numberLen)
 	                                    &ctxt->m_error,
 	                                    "unexpected - numeric string doesn't actually contain a number");
 
-	jnum = createOptimalNumber(pool, data->m_optInformation, number, numberLen);
+	jnum = createConfined(data, createOptimalNumber(pool, data->m_optInformation, number, numberLen));
 
 	do {
 		if (data->m_value == NULL) {
@@ -217,6 +224,7 @@ int dom_string(JSAXContextRef ctxt, const char *string, size_t stringLen)
 	{
 		return 0;
 	}
+	createConfined(data, jstr);
 	do {
 		if (data->m_value == NULL) {
 			if (data->m_prev != NULL)
@@ -252,7 +260,7 @@ int dom_object_start(JSAXContextRef ctxt)
 	                                    &ctxt->m_error,
 	                                    "object encountered without any context");
 
-	newParent = jobject_create();
+	newParent = createConfined(data, jobject_create());
 	newChild = calloc(1, sizeof(DomInfo));
 
 	if (UNLIKELY(newChild == NULL || !jis_valid(newParent))) {
@@ -348,7 +356,7 @@ int dom_array_start(JSAXContextRef ctxt)
 	                                    &ctxt->m_error,
 	                                    "object encountered without any context");
 
-	newParent = jarray_create(NULL);
+	newParent = createConfined(data, jarray_create(NULL));
 	newChild = calloc(1, sizeof(DomInfo));
 	if (UNLIKELY(newChild == NULL || !jis_valid(newParent))) {
 		jerror_set(&ctxt->m_error, JERROR_TYPE_SYNTAX, "Failed to allocate space for new array node");
@@ -419,12 +427,19 @@ static void dom_cleanup(DomInfo *dom_info, DomInfo *original_ptr)
 }
 
 jvalue_ref jdom_create(raw_buffer input, const jschema_ref schema, jerror **err)
+{
+	return jdom_create_ex(input, schema, DOMOPT_NOOPT, err);
+}
+
+jvalue_ref jdom_create_ex(raw_buffer input, const jschema_ref schema,
+                          JDOMOptimizationFlags optimizationMode, jerror **err)
 {
 	jvalue_ref jval = jinvalid();
 	struct jdomparser parser;
 
 	jdomparser_init(&parser, schema);
 	parser.context.string_pool = dom_string_memory_pool_create();
+	parser.topLevelContext.m_optInformation = optimizationMode & DOMOPT_THREAD_CONFINED;
 
 	if (jdomparser_feed(&parser, input.m_str, input.m_len) && jdomparser_end(&parser)) {
 		jval = jdomparser_get_result(&parser);
@@ -16,6 +16,7 @@
 
 #include <jschema.h>
 #include <jobject.h>
+#include <jvalue_stringify.h>
 #include <jobject_internal.h>
 #include <jparse_stream_internal.h>
 
@@ -26,11 +27,14 @@
 #include "validation/validator.h"
 #include "validation/parser_api.h"
 #include "validation/everything_validator.h"
+#include "validation/schema_blob.h"
+#include "validation/serialization_plan.h"
 
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <glib.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <uriparser/Uri.h>
 
@@ -126,6 +130,30 @@ static bool normalize_uri(const char *document, char *out, size_t len)
 	return true;
 }
 
+/* Bring the resolved document with all its dependencies into the schema.
+ * Fails, if it has different definitions of documents, which the schema already has.
+ */
+static bool merge_document(jschema_ref schema,
+                           char const *document,
+                           jschema_ref resolved_schema,
+                           bool steal)
+{
+	// We can lose link to the document while stealing, let's create a copy
+	char doc_name[strlen(document) + 1];
+	memcpy(doc_name, document, sizeof(doc_name));
+	if (resolved_schema != schema)
+	{
+		bool merged = steal
+			? uri_resolver_steal_documents(schema->uri_resolver, resolved_schema->uri_resolver)
+			: uri_resolver_copy_documents(schema->uri_resolver, resolved_schema->uri_resolver);
+		if (!merged)
+			return false;
+	}
+	// The validator may have been requested with a different document, than its path.
+	uri_resolver_add_validator(schema->uri_resolver, doc_name, "#", resolved_schema->validator);
+	return true;
+}
+
 static bool resolve_document(jschema_ref schema,
                              char const *document,
                              JSchemaResolverRef resolver)
@@ -144,15 +172,12 @@ static bool resolve_document(jschema_ref schema,
 		return false;
 	}
 
-	// We can lose link to the document while stealing, let's create a copy
-	char doc_name[strlen(document) + 1];
-	memcpy(doc_name, document, sizeof(doc_name));
-	uri_resolver_steal_documents(schema->uri_resolver, resolved_schema->uri_resolver);
-	// The validator may have been requested with a different document, than its path.
-	uri_resolver_add_validator(schema->uri_resolver, doc_name, "#", resolved_schema->validator);
+	// A shared schema (from the cache, for instance) must stay intact.
+	bool merged = merge_document(schema, document, resolved_schema,
+	                             g_atomic_int_get(&resolved_schema->ref_count) == 1);
 	jschema_release(&resolved_schema);
 
-	return true;
+	return merged;
 }
 
 static bool jschema_resolve_internal(jschema_ref schema, JSchemaResolverRef resolver)
@@ -178,25 +203,234 @@ static bool jschema_resolve_internal(jschema_ref schema, JSchemaResolverRef reso
 				// We weren't able to resolve referenced document either way.
 				return false;
 		}
+
+		// Bind the references now, instead of looking them up during validation.
+		// Dangling ones are still reported by the validation.
+		jschema_freeze(schema, NULL);
 	}
 
 	return true;
 }
 
+static pthread_mutex_t schema_freeze_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+bool jschema_freeze(jschema_ref schema, jerror **err)
+{
+	CHECK_POINTER_RETURN_VALUE(schema, false);
+
+	// Linking writes into the validators, which other threads may be using
+	// once the schema is frozen. So it's done exactly once.
+	if (schema == jschema_all() || g_atomic_int_get(&schema->frozen))
+		return true;
+
+	char const *unresolved = uri_resolver_get_unresolved(schema->uri_resolver);
+	if (unresolved)
+	{
+		jerror_set_formatted(err, JERROR_TYPE_SCHEMA,
+		                     "Schema has unresolved reference to %s", unresolved);
+		return false;
+	}
+
+	// The validators of the documents may be shared with other schemas,
+	// which are being frozen at the same time
+	pthread_mutex_lock(&schema_freeze_mutex);
+	bool linked = g_atomic_int_get(&schema->frozen);
+	if (!linked)
+	{
+		// Both calls are needed: external documents aren't reachable from the root
+		linked = validator_link(schema->validator, schema->uri_resolver);
+		linked = uri_resolver_link(schema->uri_resolver) && linked;
+		if (linked)
+			g_atomic_int_set(&schema->frozen, 1);
+	}
+	pthread_mutex_unlock(&schema_freeze_mutex);
+
+	if (!linked)
+	{
+		jerror_set(err, JERROR_TYPE_SCHEMA, "Schema has references to missing definitions");
+		return false;
+	}
+
+	return true;
+}
+
+jstringify_plan_ref jstringify_plan_new(jschema_ref schema, jerror **err)
+{
+	CHECK_POINTER_SET_ERROR_RETURN_NULL(schema, err);
+
+	// The plan follows the references, they have to be bound
+	if (!jschema_freeze(schema, err))
+		return NULL;
+
+	return serialization_plan_create(schema->validator);
+}
+
+void jstringify_plan_release(jstringify_plan_ref *plan)
+{
+	CHECK_POINTER(plan);
+	serialization_plan_free(*plan);
+	*plan = NULL;
+}
+
+// Process-wide cache of the compiled schemas: "<sha256 of text>:<root scope>" -> jschema_ref.
+// Only self-contained schemas get there, because resolution of external
+// references modifies the schema, and the cached ones are shared. They're
+// frozen before getting there.
+//
+// The cache keeps at most schema_cache_capacity schemas, the least recently
+// used ones are dropped first. The hash table maps the keys to the links of
+// the queue, which is ordered from the most recently used entry.
+typedef struct {
+	char *key;
+	jschema_ref schema;
+} SchemaCacheEntry;
+
+static GHashTable *schema_cache;
+static GQueue schema_cache_lru = G_QUEUE_INIT;
+static size_t schema_cache_capacity = JSCHEMA_CACHE_DEFAULT_CAPACITY;
+static pthread_mutex_t schema_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void _schema_cache_entry_free(gpointer data)
+{
+	SchemaCacheEntry *entry = (SchemaCacheEntry *) data;
+	g_free(entry->key);
+	jschema_release(&entry->schema);
+	g_free(entry);
+}
+
+static char *schema_cache_key(raw_buffer input, char const *root_scope)
+{
+	GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+	g_checksum_update(checksum, (guchar const *) input.m_str, input.m_len);
+	char *key = g_strconcat(g_checksum_get_string(checksum), ":", root_scope, NULL);
+	g_checksum_free(checksum);
+	return key;
+}
+
+static jschema_ref schema_cache_lookup(char const *key)
+{
+	jschema_ref schema = NULL;
+	pthread_mutex_lock(&schema_cache_mutex);
+	GList *link = schema_cache ? g_hash_table_lookup(schema_cache, key) : NULL;
+	if (link)
+	{
+		g_queue_unlink(&schema_cache_lru, link);
+		g_queue_push_head_link(&schema_cache_lru, link);
+		schema = jschema_copy(((SchemaCacheEntry *) link->data)->schema);
+	}
+	pthread_mutex_unlock(&schema_cache_mutex);
+	return schema;
+}
+
+// Drop the least recently used schemas, until there're at most capacity ones.
+// Called with the mutex locked, returns the entries to be freed after unlocking.
+static GList *schema_cache_trim(size_t capacity)
+{
+	GList *evicted = NULL;
+	while (schema_cache_lru.length > capacity)
+	{
+		SchemaCacheEntry *entry = g_queue_pop_tail(&schema_cache_lru);
+		g_hash_table_remove(schema_cache, entry->key);
+		evicted = g_list_prepend(evicted, entry);
+	}
+	return evicted;
+}
+
+static void schema_cache_insert(char *key, jschema_ref schema)
+{
+	// The cached schema can be handed out to any thread
+	if (!jschema_freeze(schema, NULL))
+	{
+		g_free(key);
+		return;
+	}
+
+	pthread_mutex_lock(&schema_cache_mutex);
+	// Another thread may have compiled the same schema meanwhile
+	if (!schema_cache_capacity || (schema_cache && g_hash_table_lookup(schema_cache, key)))
+	{
+		pthread_mutex_unlock(&schema_cache_mutex);
+		g_free(key);
+		return;
+	}
+
+	if (!schema_cache)
+		schema_cache = g_hash_table_new(g_str_hash, g_str_equal);
+	SchemaCacheEntry *entry = g_new(SchemaCacheEntry, 1);
+	entry->key = key;
+	entry->schema = jschema_copy(schema);
+	g_queue_push_head(&schema_cache_lru, entry);
+	g_hash_table_insert(schema_cache, key, schema_cache_lru.head);
+	GList *evicted = schema_cache_trim(schema_cache_capacity);
+	pthread_mutex_unlock(&schema_cache_mutex);
+
+	// Releasing schemas may take a while, don't hold the others
+	g_list_free_full(evicted, _schema_cache_entry_free);
+}
+
+void jschema_cache_set_capacity(size_t capacity)
+{
+	pthread_mutex_lock(&schema_cache_mutex);
+	schema_cache_capacity = capacity;
+	GList *evicted = schema_cache ? schema_cache_trim(capacity) : NULL;
+	pthread_mutex_unlock(&schema_cache_mutex);
+
+	g_list_free_full(evicted, _schema_cache_entry_free);
+}
+
+void jschema_cache_clear(void)
+{
+	pthread_mutex_lock(&schema_cache_mutex);
+	GHashTable *cache = schema_cache;
+	GList *entries = schema_cache_lru.head;
+	schema_cache = NULL;
+	g_queue_init(&schema_cache_lru);
+	pthread_mutex_unlock(&schema_cache_mutex);
+
+	if (cache)
+		g_hash_table_destroy(cache);
+	g_list_free_full(entries, _schema_cache_entry_free);
+}
+
+/* Fetch compiled schema from the cache, or parse it and remember if possible. */
+static jschema_ref jschema_compile(raw_buffer input,
+                                   char const *root_scope,
+                                   JschemaErrorFunc error_func,
+                                   void *error_ctxt)
+{
+	char *key = schema_cache_key(input, root_scope);
+	jschema_ref schema = schema_cache_lookup(key);
+	if (schema)
+	{
+		g_free(key);
+		return schema;
+	}
+
+	schema = jschema_new();
+	schema->validator = parse_schema_n(input.m_str, input.m_len,
+	                                   schema->uri_resolver,
+	                                   root_scope,
+	                                   error_func, error_ctxt);
+	if (!schema->validator)
+	{
+		g_free(key);
+		jschema_release(&schema);
+		return NULL;
+	}
+
+	schema_cache_insert(key, schema);
+	return schema;
+}
+
 static jschema_ref jschema_parse_internal(raw_buffer input,
                                           char const *root_scope,
                                           JSchemaOptimizationFlags inputOpt,
                                           JErrorCallbacksRef errorHandler,
                                           JSchemaResolverRef resolver)
 {
-	jschema_ref schema = jschema_new();
-
-	schema->validator = parse_schema_n(input.m_str, input.m_len,
-	                                   schema->uri_resolver,
-	                                   root_scope,
-	                                   &OnError, errorHandler);
+	jschema_ref schema = jschema_compile(input, root_scope, &OnError, errorHandler);
 
-	if (!schema->validator || (resolver && !jschema_resolve_internal(schema, resolver)))
+	if (!schema || (resolver && !jschema_resolve_internal(schema, resolver)))
 	{
 		jschema_release(&schema);
 		return NULL;
@@ -330,44 +564,197 @@ void _jschema_parse_error(size_t offset, SchemaErrorCode error, char const *mess
 
 jschema_ref jschema_create(raw_buffer input, jerror **err)
 {
-	jschema_ref schema = jschema_new();
+	return jschema_compile(input, URI_SCHEME_RELATIVE, _jschema_parse_error, err);
+}
 
-	schema->validator = parse_schema_n(input.m_str, input.m_len,
-	                                   schema->uri_resolver, URI_SCHEME_RELATIVE,
-	                                   _jschema_parse_error, err);
+jschema_ref jschema_fcreate(const char *file, jerror **err)
+{
+	jschema_ref schema = NULL;
+	_jbuffer buf = {
+		.buffer = { 0 },
+		.destructor = NULL
+	};
 
-	if (!schema->validator)
+	if (!j_fopen(file, &buf, err))
+		return schema;
+
+	schema = jschema_compile(buf.buffer, URI_SCHEME_RELATIVE, _jschema_parse_error, err);
+	buf.destructor(&buf);
+
+	return schema;
+}
+
+bool jschema_fsave_compiled(jschema_ref schema, const char *file, jerror **err)
+{
+	CHECK_POINTER_RETURN_VALUE(schema, false);
+	CHECK_POINTER_RETURN_VALUE(file, false);
+
+	if (schema->uri_resolver && uri_resolver_get_unresolved(schema->uri_resolver))
 	{
-		jschema_release(&schema);
-		return NULL;
+		jerror_set(err, JERROR_TYPE_INVALID_PARAMETERS,
+		           "Schema has unresolved external references");
+		return false;
 	}
 
-	return schema;
+	GByteArray *blob = schema_blob_write(schema->validator, schema->uri_resolver);
+	if (!blob)
+	{
+		jerror_set(err, JERROR_TYPE_INVALID_PARAMETERS,
+		           "Schema can't be precompiled");
+		return false;
+	}
+
+	GError *gerror = NULL;
+	bool res = g_file_set_contents(file, (gchar const *) blob->data, blob->len, &gerror);
+	if (!res)
+	{
+		jerror_set_formatted(err, JERROR_TYPE_INTERNAL,
+		                     "Can't write file %s: %s", file, gerror->message);
+		g_error_free(gerror);
+	}
+
+	g_byte_array_free(blob, TRUE);
+	return res;
 }
 
-jschema_ref jschema_fcreate(const char *file, jerror **err)
+jschema_ref jschema_fload_compiled(const char *file, jerror **err)
 {
-	jschema_ref schema = NULL;
 	_jbuffer buf = {
 		.buffer = { 0 },
 		.destructor = NULL
 	};
 
 	if (!j_fopen(file, &buf, err))
-		return schema;
-
-	schema = jschema_new();
+		return NULL;
 
-	schema->validator = parse_schema_n(buf.buffer.m_str, buf.buffer.m_len,
-	                                   schema->uri_resolver, URI_SCHEME_RELATIVE,
-	                                   _jschema_parse_error, err);
+	jschema_ref schema = jschema_new();
+	schema->validator = schema_blob_read(buf.buffer.m_str, buf.buffer.m_len, schema->uri_resolver);
 	buf.destructor(&buf);
 
 	if (!schema->validator)
 	{
+		jerror_set_formatted(err, JERROR_TYPE_SCHEMA,
+		                     "Corrupted or incompatible precompiled schema: %s", file);
 		jschema_release(&schema);
 		return NULL;
 	}
 
+	// Bind the references, as for the parsed schemas
+	jschema_freeze(schema, NULL);
 	return schema;
 }
+
+typedef struct _BatchTask
+{
+	char const *name;       // Name of the schema in the batch, as passed by the caller
+	char *path;             // Path to the file
+	jschema_ref schema;     // Parsed schema
+	jerror *error;          // Parse error
+} BatchTask;
+
+static void _batch_parse(gpointer data, gpointer user_data)
+{
+	BatchTask *task = (BatchTask *) data;
+	_jbuffer buf = {
+		.buffer = { 0 },
+		.destructor = NULL
+	};
+
+	if (!j_fopen(task->path, &buf, &task->error))
+		return;
+
+	// Every schema gets its own scope, so that "$ref"s are relative to the file.
+	char *root_scope = g_strconcat(URI_SCHEME_RELATIVE, task->name, NULL);
+	task->schema = jschema_compile(buf.buffer, root_scope, _jschema_parse_error, &task->error);
+	g_free(root_scope);
+	buf.destructor(&buf);
+}
+
+static bool _batch_resolve(BatchTask *task, GHashTable *tasks, JSchemaResolverRef resolver, jerror **err)
+{
+	jschema_ref schema = task->schema;
+	char const *document = NULL;
+	char const *prev_document = NULL;
+
+	while ((document = uri_resolver_get_unresolved(schema->uri_resolver)))
+	{
+		size_t len = strlen(document) + 1;
+		char file_name[len];
+
+		if (document == prev_document || !normalize_uri(document, file_name, len))
+			break;
+		prev_document = document;
+
+		// The schemas of the batch are shared, take copies of their documents
+		BatchTask *target = g_hash_table_lookup(tasks, file_name);
+		if (target)
+		{
+			if (!merge_document(schema, document, target->schema, false))
+				break;
+		}
+		else if (!resolver || !resolve_document(schema, document, resolver))
+			break;
+	}
+
+	if (document)
+	{
+		jerror_set_formatted(err, JERROR_TYPE_SCHEMA,
+		                     "%s: Can't resolve %s", task->name, document);
+		return false;
+	}
+
+	jschema_freeze(schema, NULL);
+	return true;
+}
+
+bool jschema_fcreate_batch(const char *dir, const char * const *files, size_t count,
+                           jschema_ref *schemas, JSchemaResolverRef resolver, jerror **err)
+{
+	CHECK_POINTER_RETURN_VALUE(files, false);
+	CHECK_POINTER_RETURN_VALUE(schemas, false);
+
+	BatchTask *tasks = g_new0(BatchTask, count);
+	GThreadPool *pool = g_thread_pool_new(_batch_parse, NULL,
+	                                      (gint) MAX(1, MIN(count, g_get_num_processors())),
+	                                      FALSE, NULL);
+	for (size_t i = 0; i < count; ++i)
+	{
+		tasks[i].name = files[i];
+		tasks[i].path = dir ? g_build_filename(dir, files[i], NULL) : g_strdup(files[i]);
+		g_thread_pool_push(pool, &tasks[i], NULL);
+	}
+	// Wait for all the files to be parsed
+	g_thread_pool_free(pool, FALSE, TRUE);
+
+	bool res = true;
+	GHashTable *index = g_hash_table_new(g_str_hash, g_str_equal);
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!tasks[i].schema)
+		{
+			if (res)
+				jerror_set_formatted(err, tasks[i].error ? tasks[i].error->type : JERROR_TYPE_INTERNAL,
+				                     "%s: %s", tasks[i].name,
+				                     tasks[i].error ? tasks[i].error->message : "Failed to parse schema");
+			res = false;
+		}
+		g_hash_table_insert(index, (gpointer) tasks[i].name, &tasks[i]);
+	}
+
+	// Cross-references are resolved in one pass once everything is parsed
+	for (size_t i = 0; res && i < count; ++i)
+		res = _batch_resolve(&tasks[i], index, resolver, err);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!res)
+			jschema_release(&tasks[i].schema);
+		schemas[i] = res ? tasks[i].schema : NULL;
+		jerror_free(tasks[i].error);
+		g_free(tasks[i].path);
+	}
+
+	g_hash_table_destroy(index);
+	g_free(tasks);
+	return res;
+}
@@ -23,6 +23,7 @@
 #include <stdio.h>
 
 #include <jschema.h>
+#include <jvalue_stringify.h>
 
 #include "jtraverse.h"
 #include "jschema_types_internal.h"
@@ -68,16 +69,22 @@ static bool schema_number(void *ctx, jvalue_ref ref)
 
 static bool schema_int(void *ctx, jvalue_ref ref)
 {
-	/* we know exactly what we convert */
-	const char *buf = jvalue_tostring_simple(ref);
-	return jschema_builder_number((jschema_builder *)ctx, buf, strlen(buf));
+	/* we know exactly what we convert, and it fits */
+	char buf[64];
+	size_t len;
+	if (!jvalue_stringify_to(ref, buf, sizeof(buf), &len))
+		return false;
+	return jschema_builder_number((jschema_builder *)ctx, buf, len);
 }
 
 static bool schema_double(void *ctx, jvalue_ref ref)
 {
-	/* we know exactly what we convert */
-	const char *buf = jvalue_tostring_simple(ref);
-	return jschema_builder_number((jschema_builder *)ctx, buf, strlen(buf));
+	/* we know exactly what we convert, and it fits */
+	char buf[64];
+	size_t len;
+	if (!jvalue_stringify_to(ref, buf, sizeof(buf), &len))
+		return false;
+	return jschema_builder_number((jschema_builder *)ctx, buf, len);
 }
 
 jschema_ref jschema_parse_jvalue(jvalue_ref value, JErrorCallbacksRef errorHandler, const char *root_scope)
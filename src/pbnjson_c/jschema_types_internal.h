@@ -37,6 +37,7 @@ typedef struct jschema {
 	int ref_count;
 	Validator *validator;
 	UriResolver *uri_resolver;
+	int frozen;       // set once the references are bound, see jschema_freeze()
 } jschema;
 
 
@@ -0,0 +1,743 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include <jtape.h>
+#include <jparse_stream.h>
+
+#include "jobject_internal.h"
+#include "jerror_internal.h"
+#include "jvalue/num_conversion.h"
+#include "liblog.h"
+
+/* Every value takes one word of the tape, with the tag in the top byte:
+ *   null, true, false - the tag only
+ *   number, string    - offset of the text in the slab
+ *   array, object     - the word after the last child (skip pointer), the next
+ *                       word keeps the number of the children
+ * An object is followed by the pairs of key string and value words. An object
+ * with many members has TAPE_KEY_TABLE in the top byte of the number of the
+ * children, and a table of the keys after the members: the offsets of the key
+ * words from the object, in the order of the keys. The skip pointer goes after
+ * the table. A text in the slab is its 32-bit length, the bytes and
+ * terminating zero.
+ *
+ * The image of a tape is the header, the words and the slab.
+ */
+enum {
+	TAPE_NULL,
+	TAPE_TRUE,
+	TAPE_FALSE,
+	TAPE_NUMBER,
+	TAPE_STRING,
+	TAPE_ARRAY,
+	TAPE_OBJECT,
+};
+
+#define TAPE_PAYLOAD_BITS 56
+#define TAPE_PAYLOAD_MAX ((UINT64_C(1) << TAPE_PAYLOAD_BITS) - 1)
+#define TAPE_WORD(tag, payload) (((uint64_t)(tag) << TAPE_PAYLOAD_BITS) | (payload))
+#define TAPE_TAG(word) ((unsigned)((word) >> TAPE_PAYLOAD_BITS))
+#define TAPE_PAYLOAD(word) ((word) & TAPE_PAYLOAD_MAX)
+#define TAPE_SHARED_TEXT_MAX 64
+#define TAPE_KEY_TABLE 1
+// Smaller objects are searched member by member
+#define TAPE_KEY_TABLE_MIN 8
+
+static const char tape_magic[8] = "PJTAPE2";
+
+typedef struct {
+	char magic[8];
+	uint64_t words;      // number of the words
+	uint64_t slab;       // size of the slab in bytes
+} TapeHeader;
+
+struct jtape
+{
+	const uint64_t *words;
+	size_t count;
+	const char *slab;
+	size_t slab_size;
+	_jbuffer image;      // the destructor is set, if the tape owns the image
+};
+
+static const jtape_cursor invalid_cursor = { NULL, 0, 0, 0 };
+
+/* Building */
+
+typedef struct {
+	GArray *words;       // uint64_t
+	GByteArray *slab;
+	GArray *open;        // size_t, words of the containers not closed yet
+	GHashTable *texts;   // GBytes with a short text -> its offset in the slab
+	size_t sorting;      // word of the object, which keys are sorted
+} TapeBuilder;
+
+static bool slab_append(TapeBuilder *b, const char *str, size_t len, uint64_t *offset)
+{
+	if (len > UINT32_MAX || b->slab->len > TAPE_PAYLOAD_MAX)
+		return false;
+
+	uint32_t len32 = len;
+	*offset = b->slab->len;
+	g_byte_array_append(b->slab, (const guint8 *) &len32, sizeof(len32));
+	g_byte_array_append(b->slab, (const guint8 *) str, len);
+	g_byte_array_append(b->slab, (const guint8 *) "", 1);
+	return true;
+}
+
+// Keys and short values (enumerations, small numbers) tend to repeat, they
+// share their texts
+static bool slab_add(TapeBuilder *b, const char *str, size_t len, uint64_t *offset)
+{
+	if (len > TAPE_SHARED_TEXT_MAX)
+		return slab_append(b, str, len, offset);
+
+	GBytes *bytes = g_bytes_new(str, len);
+	gpointer shared;
+	if (g_hash_table_lookup_extended(b->texts, bytes, NULL, &shared))
+	{
+		g_bytes_unref(bytes);
+		*offset = GPOINTER_TO_SIZE(shared);
+		return true;
+	}
+
+	if (!slab_append(b, str, len, offset))
+	{
+		g_bytes_unref(bytes);
+		return false;
+	}
+	g_hash_table_insert(b->texts, bytes, GSIZE_TO_POINTER(*offset));
+	return true;
+}
+
+static void tape_push(TapeBuilder *b, uint64_t word)
+{
+	// Members of objects are counted by their keys
+	if (b->open->len)
+	{
+		size_t parent = g_array_index(b->open, size_t, b->open->len - 1);
+		if (TAPE_TAG(g_array_index(b->words, uint64_t, parent)) == TAPE_ARRAY)
+			++g_array_index(b->words, uint64_t, parent + 1);
+	}
+	g_array_append_val(b->words, word);
+}
+
+static int tape_text(JSAXContextRef ctxt, unsigned tag, const char *str, size_t len)
+{
+	TapeBuilder *b = jsax_getContext(ctxt);
+	uint64_t offset;
+	if (!slab_add(b, str, len, &offset))
+		return 0;
+	tape_push(b, TAPE_WORD(tag, offset));
+	return 1;
+}
+
+static int tape_null(JSAXContextRef ctxt)
+{
+	tape_push(jsax_getContext(ctxt), TAPE_WORD(TAPE_NULL, 0));
+	return 1;
+}
+
+static int tape_boolean(JSAXContextRef ctxt, bool value)
+{
+	tape_push(jsax_getContext(ctxt), TAPE_WORD(value ? TAPE_TRUE : TAPE_FALSE, 0));
+	return 1;
+}
+
+static int tape_number(JSAXContextRef ctxt, const char *number, size_t len)
+{
+	return tape_text(ctxt, TAPE_NUMBER, number, len);
+}
+
+static int tape_string(JSAXContextRef ctxt, const char *string, size_t len)
+{
+	return tape_text(ctxt, TAPE_STRING, string, len);
+}
+
+static int tape_open(JSAXContextRef ctxt, unsigned tag)
+{
+	TapeBuilder *b = jsax_getContext(ctxt);
+	size_t pos = b->words->len;
+	uint64_t count = 0;
+
+	tape_push(b, TAPE_WORD(tag, 0));
+	g_array_append_val(b->words, count);
+	g_array_append_val(b->open, pos);
+	return 1;
+}
+
+static raw_buffer slab_text(const char *slab, uint64_t word)
+{
+	uint32_t len;
+	memcpy(&len, slab + TAPE_PAYLOAD(word), sizeof(len));
+	return j_str_to_buffer(slab + TAPE_PAYLOAD(word) + sizeof(len), len);
+}
+
+static int key_compare(raw_buffer a, raw_buffer b)
+{
+	size_t len = MIN(a.m_len, b.m_len);
+	int res = len ? memcmp(a.m_str, b.m_str, len) : 0;
+	if (res)
+		return res;
+	return a.m_len < b.m_len ? -1 : a.m_len > b.m_len;
+}
+
+static gint key_offset_compare(gconstpointer a, gconstpointer b, gpointer data)
+{
+	TapeBuilder *builder = (TapeBuilder *) data;
+	const uint64_t *object = (const uint64_t *) builder->words->data + builder->sorting;
+	const char *slab = (const char *) builder->slab->data;
+	return key_compare(slab_text(slab, object[*(const uint64_t *) a]),
+	                   slab_text(slab, object[*(const uint64_t *) b]));
+}
+
+// Append the table of the keys of the object, which is closed
+static void tape_key_table(TapeBuilder *b, size_t pos)
+{
+	uint64_t count = g_array_index(b->words, uint64_t, pos + 1);
+	GArray *offsets = g_array_sized_new(FALSE, FALSE, sizeof(uint64_t), count);
+	for (size_t key = pos + 2; key < b->words->len; )
+	{
+		uint64_t offset = key - pos;
+		g_array_append_val(offsets, offset);
+		uint64_t value = g_array_index(b->words, uint64_t, key + 1);
+		unsigned tag = TAPE_TAG(value);
+		key = tag == TAPE_ARRAY || tag == TAPE_OBJECT ? TAPE_PAYLOAD(value) : key + 2;
+	}
+
+	// The sort is stable, the first one of the duplicate keys is found
+	b->sorting = pos;
+	g_array_sort_with_data(offsets, key_offset_compare, b);
+	g_array_append_vals(b->words, offsets->data, offsets->len);
+	g_array_index(b->words, uint64_t, pos + 1) = TAPE_WORD(TAPE_KEY_TABLE, count);
+	g_array_free(offsets, TRUE);
+}
+
+static int tape_close(JSAXContextRef ctxt)
+{
+	TapeBuilder *b = jsax_getContext(ctxt);
+	size_t pos = g_array_index(b->open, size_t, b->open->len - 1);
+
+	if (TAPE_TAG(g_array_index(b->words, uint64_t, pos)) == TAPE_OBJECT &&
+	    g_array_index(b->words, uint64_t, pos + 1) >= TAPE_KEY_TABLE_MIN)
+		tape_key_table(b, pos);
+
+	if (b->words->len > TAPE_PAYLOAD_MAX)
+		return 0;
+
+	uint64_t *word = &g_array_index(b->words, uint64_t, pos);
+	*word = TAPE_WORD(TAPE_TAG(*word), b->words->len);
+	g_array_set_size(b->open, b->open->len - 1);
+	return 1;
+}
+
+static int tape_object_start(JSAXContextRef ctxt)
+{
+	return tape_open(ctxt, TAPE_OBJECT);
+}
+
+static int tape_object_key(JSAXContextRef ctxt, const char *key, size_t len)
+{
+	TapeBuilder *b = jsax_getContext(ctxt);
+	size_t parent = g_array_index(b->open, size_t, b->open->len - 1);
+	uint64_t offset;
+
+	if (!slab_add(b, key, len, &offset))
+		return 0;
+
+	++g_array_index(b->words, uint64_t, parent + 1);
+	uint64_t word = TAPE_WORD(TAPE_STRING, offset);
+	g_array_append_val(b->words, word);
+	return 1;
+}
+
+static int tape_array_start(JSAXContextRef ctxt)
+{
+	return tape_open(ctxt, TAPE_ARRAY);
+}
+
+static PJSAXCallbacks tape_callbacks = {
+	tape_object_start,
+	tape_object_key,
+	tape_close,
+	tape_array_start,
+	tape_close,
+	tape_string,
+	tape_number,
+	tape_boolean,
+	tape_null,
+};
+
+// Lay the built tape out as an image
+static jtape_ref tape_finish(TapeBuilder *b, jerror **err)
+{
+	if (b->words->len == 0)
+	{
+		jerror_set(err, JERROR_TYPE_SYNTAX, "No JSON value in the input");
+		return NULL;
+	}
+
+	TapeHeader header = { .words = b->words->len, .slab = b->slab->len };
+	memcpy(header.magic, tape_magic, sizeof(header.magic));
+
+	size_t words_size = b->words->len * sizeof(uint64_t);
+	size_t size = sizeof(header) + words_size + b->slab->len;
+	char *image = malloc(size);
+	CHECK_ALLOC_RETURN_NULL(image);
+	memcpy(image, &header, sizeof(header));
+	memcpy(image + sizeof(header), b->words->data, words_size);
+	memcpy(image + sizeof(header) + words_size, b->slab->data, b->slab->len);
+
+	jtape_ref tape = jtape_open(j_str_to_buffer(image, size), err);
+	if (!tape)
+	{
+		free(image);
+		return NULL;
+	}
+	tape->image.destructor = _jbuffer_free;
+	return tape;
+}
+
+jtape_ref jtape_create(raw_buffer input, const jschema_ref schema, jerror **err)
+{
+	TapeBuilder b = {
+		.words = g_array_new(FALSE, FALSE, sizeof(uint64_t)),
+		.slab = g_byte_array_new(),
+		.open = g_array_new(FALSE, FALSE, sizeof(size_t)),
+		.texts = g_hash_table_new_full(g_bytes_hash, g_bytes_equal, (GDestroyNotify) g_bytes_unref, NULL),
+	};
+
+	jtape_ref tape = NULL;
+	if (jsax_parse_with_callbacks(input, schema, &tape_callbacks, &b, err))
+		tape = tape_finish(&b, err);
+
+	g_array_free(b.words, TRUE);
+	g_byte_array_free(b.slab, TRUE);
+	g_array_free(b.open, TRUE);
+	g_hash_table_destroy(b.texts);
+	return tape;
+}
+
+jtape_ref jtape_open(raw_buffer image, jerror **err)
+{
+	TapeHeader header;
+
+	if (!image.m_str || image.m_len < sizeof(header) || ((uintptr_t) image.m_str % sizeof(uint64_t)) != 0)
+	{
+		jerror_set(err, JERROR_TYPE_INVALID_PARAMETERS, "The tape image is too short or misaligned");
+		return NULL;
+	}
+
+	memcpy(&header, image.m_str, sizeof(header));
+	size_t available = image.m_len - sizeof(header);
+	if (memcmp(header.magic, tape_magic, sizeof(header.magic)) != 0 ||
+	    header.words == 0 || header.words > available / sizeof(uint64_t) ||
+	    header.slab != available - header.words * sizeof(uint64_t))
+	{
+		jerror_set(err, JERROR_TYPE_INVALID_PARAMETERS, "The tape image is damaged");
+		return NULL;
+	}
+
+	jtape_ref tape = malloc(sizeof(struct jtape));
+	CHECK_ALLOC_RETURN_NULL(tape);
+	*tape = (struct jtape) {
+		.words = (const uint64_t *) (image.m_str + sizeof(header)),
+		.count = header.words,
+		.slab = image.m_str + sizeof(header) + header.words * sizeof(uint64_t),
+		.slab_size = header.slab,
+		.image = { image, NULL },
+	};
+	return tape;
+}
+
+jtape_ref jtape_fopen(const char *file, jerror **err)
+{
+	_jbuffer buf = {
+		.buffer = { 0 },
+		.destructor = NULL
+	};
+
+	if (!j_fopen(file, &buf, err))
+		return NULL;
+
+	jtape_ref tape = jtape_open(buf.buffer, err);
+	if (UNLIKELY(!tape)) {
+		buf.destructor(&buf);
+	} else {
+		tape->image.destructor = buf.destructor;
+	}
+
+	return tape;
+}
+
+void jtape_free(jtape_ref tape)
+{
+	if (!tape)
+		return;
+
+	if (tape->image.destructor)
+		tape->image.destructor(&tape->image);
+	free(tape);
+}
+
+raw_buffer jtape_image(jtape_ref tape)
+{
+	if (!tape)
+		return j_str_to_buffer(NULL, 0);
+	return tape->image.buffer;
+}
+
+/* Reading. The image may come from a file, so the words and offsets are
+ * checked before they're followed.
+ */
+
+static bool tape_slab_text(jtape_cursor cur, unsigned tag, raw_buffer *text)
+{
+	if (!cur.m_tape)
+		return false;
+
+	uint64_t word = cur.m_tape->words[cur.m_pos];
+	if (TAPE_TAG(word) != tag)
+		return false;
+
+	uint64_t offset = TAPE_PAYLOAD(word);
+	uint32_t len;
+	if (offset + sizeof(len) > cur.m_tape->slab_size)
+		return false;
+	memcpy(&len, cur.m_tape->slab + offset, sizeof(len));
+	if (offset + sizeof(len) + len >= cur.m_tape->slab_size)
+		return false;
+
+	*text = j_str_to_buffer(cur.m_tape->slab + offset + sizeof(len), len);
+	return true;
+}
+
+static bool tape_is_container(jtape_cursor cur)
+{
+	unsigned tag = TAPE_TAG(cur.m_tape->words[cur.m_pos]);
+	return (tag == TAPE_ARRAY || tag == TAPE_OBJECT) && cur.m_pos + 2 <= cur.m_end;
+}
+
+// The word after the value, which is never beyond its siblings
+static size_t tape_skip(jtape_cursor cur)
+{
+	if (!tape_is_container(cur))
+		return cur.m_pos + 1;
+
+	uint64_t end = TAPE_PAYLOAD(cur.m_tape->words[cur.m_pos]);
+	if (end < cur.m_pos + 2 || end > cur.m_end)
+		return cur.m_end;
+	return end;
+}
+
+static bool tape_has_key_table(jtape_cursor cur)
+{
+	return TAPE_TAG(cur.m_tape->words[cur.m_pos]) == TAPE_OBJECT &&
+	       TAPE_TAG(cur.m_tape->words[cur.m_pos + 1]) == TAPE_KEY_TABLE;
+}
+
+// The word after the last child of the container
+static size_t tape_children_end(jtape_cursor cur)
+{
+	size_t end = tape_skip(cur);
+	if (!tape_has_key_table(cur))
+		return end;
+
+	uint64_t count = TAPE_PAYLOAD(cur.m_tape->words[cur.m_pos + 1]);
+	if (count > end - cur.m_pos - 2)
+		return cur.m_pos + 2;
+	return end - count;
+}
+
+// Make the cursor of the child, which starts at the word
+static jtape_cursor tape_child(jtape_cursor cur, size_t pos, bool member)
+{
+	cur.m_key = 0;
+	if (member)
+	{
+		cur.m_key = pos;
+		++pos;
+	}
+	if (pos >= cur.m_end)
+		return invalid_cursor;
+	cur.m_pos = pos;
+	return cur;
+}
+
+jtape_cursor jtape_root(jtape_ref tape)
+{
+	return (jtape_cursor) { tape, 0, 0, tape->count };
+}
+
+bool jtape_is_valid(jtape_cursor cur)
+{
+	return cur.m_tape != NULL;
+}
+
+JValueType jtape_type(jtape_cursor cur)
+{
+	if (!cur.m_tape)
+		return JV_NULL;
+
+	switch (TAPE_TAG(cur.m_tape->words[cur.m_pos]))
+	{
+	case TAPE_TRUE:
+	case TAPE_FALSE:
+		return JV_BOOL;
+	case TAPE_NUMBER:
+		return JV_NUM;
+	case TAPE_STRING:
+		return JV_STR;
+	case TAPE_ARRAY:
+		return JV_ARRAY;
+	case TAPE_OBJECT:
+		return JV_OBJECT;
+	default:
+		return JV_NULL;
+	}
+}
+
+ssize_t jtape_size(jtape_cursor cur)
+{
+	if (!cur.m_tape || !tape_is_container(cur))
+		return -1;
+
+	// Every child takes a word at least
+	uint64_t size = TAPE_PAYLOAD(cur.m_tape->words[cur.m_pos + 1]);
+	size_t words = tape_children_end(cur) - cur.m_pos - 2;
+	return size <= words ? (ssize_t) size : (ssize_t) words;
+}
+
+jtape_cursor jtape_first(jtape_cursor cur)
+{
+	if (!cur.m_tape || !tape_is_container(cur))
+		return invalid_cursor;
+
+	bool member = TAPE_TAG(cur.m_tape->words[cur.m_pos]) == TAPE_OBJECT;
+	size_t first = cur.m_pos + 2;
+	cur.m_end = tape_children_end(cur);
+	return tape_child(cur, first, member);
+}
+
+jtape_cursor jtape_next(jtape_cursor cur)
+{
+	// The top-level value has no siblings
+	if (!cur.m_tape || cur.m_pos == 0)
+		return invalid_cursor;
+
+	return tape_child(cur, tape_skip(cur), cur.m_key != 0);
+}
+
+jtape_cursor jtape_array_get(jtape_cursor cur, ssize_t index)
+{
+	if (jtape_type(cur) != JV_ARRAY || index < 0 || index >= jtape_size(cur))
+		return invalid_cursor;
+
+	jtape_cursor child = jtape_first(cur);
+	for (ssize_t i = 0; i < index && jtape_is_valid(child); ++i)
+		child = jtape_next(child);
+	return child;
+}
+
+// The member at the offset from the table of the keys
+static jtape_cursor tape_table_member(jtape_cursor cur, uint64_t offset)
+{
+	if (offset < 2 || offset >= cur.m_end - cur.m_pos)
+		return invalid_cursor;
+	return tape_child(cur, cur.m_pos + offset, true);
+}
+
+// Binary search of the first member with the key
+static jtape_cursor tape_find_key(jtape_cursor cur, raw_buffer key)
+{
+	size_t members = tape_children_end(cur);
+	size_t count = tape_skip(cur) - members;
+	const uint64_t *table = cur.m_tape->words + members;
+	cur.m_end = members;
+
+	size_t lo = 0, hi = count;
+	while (lo < hi)
+	{
+		size_t mid = lo + (hi - lo) / 2;
+		raw_buffer member = jtape_key(tape_table_member(cur, table[mid]));
+		// A damaged table ends the search
+		if (!member.m_str)
+			return invalid_cursor;
+		if (key_compare(member, key) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == count)
+		return invalid_cursor;
+
+	jtape_cursor child = tape_table_member(cur, table[lo]);
+	raw_buffer member = jtape_key(child);
+	return member.m_str && key_compare(member, key) == 0 ? child : invalid_cursor;
+}
+
+jtape_cursor jtape_object_get(jtape_cursor cur, raw_buffer key)
+{
+	if (jtape_type(cur) != JV_OBJECT)
+		return invalid_cursor;
+
+	if (tape_is_container(cur) && tape_has_key_table(cur))
+		return tape_find_key(cur, key);
+
+	for (jtape_cursor child = jtape_first(cur); jtape_is_valid(child); child = jtape_next(child))
+	{
+		raw_buffer member = jtape_key(child);
+		if (member.m_len == key.m_len && memcmp(member.m_str, key.m_str, key.m_len) == 0)
+			return child;
+	}
+	return invalid_cursor;
+}
+
+raw_buffer jtape_key(jtape_cursor cur)
+{
+	raw_buffer key = j_str_to_buffer(NULL, 0);
+	if (!cur.m_tape || !cur.m_key)
+		return key;
+
+	cur.m_pos = cur.m_key;
+	tape_slab_text(cur, TAPE_STRING, &key);
+	return key;
+}
+
+raw_buffer jtape_get_string(jtape_cursor cur)
+{
+	raw_buffer text = j_str_to_buffer(NULL, 0);
+	tape_slab_text(cur, TAPE_STRING, &text);
+	return text;
+}
+
+raw_buffer jtape_get_number_raw(jtape_cursor cur)
+{
+	raw_buffer text = j_str_to_buffer(NULL, 0);
+	tape_slab_text(cur, TAPE_NUMBER, &text);
+	return text;
+}
+
+ConversionResultFlags jtape_get_i64(jtape_cursor cur, int64_t *number)
+{
+	raw_buffer text;
+	CHECK_CONDITION_RETURN_VALUE(!tape_slab_text(cur, TAPE_NUMBER, &text) || text.m_len == 0,
+	                             CONV_BAD_ARGS, "Trying to access non-number as a number");
+	return jstr_to_i64(&text, number);
+}
+
+ConversionResultFlags jtape_get_f64(jtape_cursor cur, double *number)
+{
+	raw_buffer text;
+	CHECK_CONDITION_RETURN_VALUE(!tape_slab_text(cur, TAPE_NUMBER, &text) || text.m_len == 0,
+	                             CONV_BAD_ARGS, "Trying to access non-number as a number");
+	return jstr_to_double(&text, number);
+}
+
+bool jtape_get_bool(jtape_cursor cur)
+{
+	return cur.m_tape && TAPE_TAG(cur.m_tape->words[cur.m_pos]) == TAPE_TRUE;
+}
+
+// The scalar value, or the empty container to be filled
+static jvalue_ref tape_value_new(jtape_cursor cur)
+{
+	raw_buffer text;
+	ssize_t size = jtape_size(cur);
+
+	switch (jtape_type(cur))
+	{
+	case JV_NULL:
+		return jtape_is_valid(cur) ? jnull() : jinvalid();
+	case JV_BOOL:
+		return jboolean_create(jtape_get_bool(cur));
+	case JV_NUM:
+		text = jtape_get_number_raw(cur);
+		return text.m_len ? jnumber_create(text) : jinvalid();
+	case JV_STR:
+		text = jtape_get_string(cur);
+		return text.m_str ? jstring_create_copy(text) : jinvalid();
+	case JV_ARRAY:
+		return jarray_create_hint(NULL, size > 0 ? size : 0);
+	case JV_OBJECT:
+		return jobject_create_hint(size > 0 ? size : 0);
+	}
+	return jinvalid();
+}
+
+typedef struct {
+	jvalue_ref container;
+	jtape_cursor child;  // the next child to add
+} TapeFrame;
+
+jvalue_ref jtape_to_jvalue(jtape_cursor cur)
+{
+	jvalue_ref root = tape_value_new(cur);
+	if (!jis_array(root) && !jis_object(root))
+		return root;
+
+	// The image may come from a file, so the nesting isn't limited by
+	// the parser. Walk it with a stack of our own.
+	GArray *stack = g_array_new(FALSE, FALSE, sizeof(TapeFrame));
+	TapeFrame frame = { root, jtape_first(cur) };
+	g_array_append_val(stack, frame);
+
+	while (stack->len)
+	{
+		TapeFrame *top = &g_array_index(stack, TapeFrame, stack->len - 1);
+		jtape_cursor child = top->child;
+		if (!jtape_is_valid(child))
+		{
+			g_array_set_size(stack, stack->len - 1);
+			continue;
+		}
+		top->child = jtape_next(child);
+
+		jvalue_ref container = top->container;
+		raw_buffer key = jtape_key(child);
+		if (jis_object(container) && !key.m_str)
+			break;
+
+		jvalue_ref val = tape_value_new(child);
+		if (!jis_valid(val))
+			break;
+		bool nested = jis_array(val) || jis_object(val);
+		if (jis_array(container) ? !jarray_append(container, val)
+		                         : !jobject_put(container, jstring_create_copy(key), val))
+			break;
+
+		// The container owns the value now, but it's still there to be filled
+		if (nested)
+		{
+			frame = (TapeFrame) { val, jtape_first(child) };
+			g_array_append_val(stack, frame);
+		}
+	}
+
+	bool complete = stack->len == 0;
+	g_array_free(stack, TRUE);
+	if (!complete)
+	{
+		j_release(&root);
+		return jinvalid();
+	}
+	return root;
+}
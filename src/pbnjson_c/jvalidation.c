@@ -24,7 +24,6 @@
 #include <compiler/nonnull_attribute.h>
 #include <compiler/builtins.h>
 #include <math.h>
-#include <inttypes.h>
 
 #include <jobject.h>
 
@@ -115,19 +114,15 @@ static bool check_schema_jnumber_raw(void *ctxt, jvalue_ref ref)
 
 static bool check_schema_jnumber_double(void *ctxt, jvalue_ref ref)
 {
-	char buf[24];
-	int len = snprintf(buf, sizeof(buf), "%.14lg", jnum_deref(ref)->value.floating);
 	ValidationContext *context = (ValidationContext*)ctxt;
-	ValidationEvent e = validation_event_number(buf, len);
+	ValidationEvent e = validation_event_number_double(jnum_deref(ref)->value.floating);
 	return validation_check(&e, context->validation_state, context);
 }
 
 static bool check_schema_jnumber_int(void *ctxt, jvalue_ref ref)
 {
-	char buf[24];
-	int len = snprintf(buf, sizeof(buf), "%" PRId64, jnum_deref(ref)->value.integer);
 	ValidationContext *context = (ValidationContext*)ctxt;
-	ValidationEvent e = validation_event_number(buf, len);
+	ValidationEvent e = validation_event_number_int64(jnum_deref(ref)->value.integer);
 	return validation_check(&e, context->validation_state, context);
 }
 
@@ -319,3 +314,144 @@ bool jvalue_validate_apply(jvalue_ref val, const jschema_ref schema, jerror **er
 	};
 	return jvalue_schema_work(val, schema, &cb, &jvalue_apply_notification);
 }
+
+typedef struct _BatchChunk
+{
+	const jvalue_ref *vals;      // Values to check, or NULL
+	const raw_buffer *inputs;    // Texts to check, if there're no values
+	jschema_ref schema;
+	bool *results;
+	jerror **errs;
+	size_t begin;
+	size_t end;
+	size_t valid;                // Count of the valid items in the chunk
+} BatchChunk;
+
+static bool _batch_validate_value(BatchChunk *chunk, size_t i, ValidationContext *ctxt)
+{
+	jvalue_ref val = chunk->vals[i];
+	if (!val)
+	{
+		if (chunk->errs)
+			jerror_set(&chunk->errs[i], JERROR_TYPE_INVALID_PARAMETERS, "NULL value");
+		return false;
+	}
+
+	ctxt->callbacks->m_ctxt = chunk->errs ? &chunk->errs[i] : NULL;
+	ctxt->jvalue = val;
+	bool valid = jvalue_traverse(val, &traverse, ctxt);
+
+	// Keep the state for the next value, only its stacks are rewound
+	validation_state_reset(ctxt->validation_state, chunk->schema->validator);
+	return valid;
+}
+
+static void _batch_validate(gpointer data, gpointer user_data)
+{
+	BatchChunk *chunk = (BatchChunk *) data;
+
+	struct JErrorCallbacks cb =
+	{
+		.m_parser  = cb_parser_error,
+		.m_schema  = cb_schema_error,
+		.m_unknown = cb_unknown_error,
+		.m_ctxt    = NULL
+	};
+	ValidationState validation_state = { 0 };
+	ValidationContext ctxt = {
+		.callbacks = &cb,
+		.jvalue = NULL,
+		.validation_state = &validation_state,
+	};
+
+	if (chunk->vals)
+		validation_state_init(&validation_state,
+		                      chunk->schema->validator,
+		                      chunk->schema->uri_resolver,
+		                      &jvalue_check_notification);
+
+	for (size_t i = chunk->begin; i < chunk->end; ++i)
+	{
+		bool valid = chunk->vals
+			? _batch_validate_value(chunk, i, &ctxt)
+			: jsax_parse_with_callbacks(chunk->inputs[i], chunk->schema, NULL, NULL,
+			                            chunk->errs ? &chunk->errs[i] : NULL);
+		chunk->results[i] = valid;
+		if (valid)
+			++chunk->valid;
+	}
+
+	if (chunk->vals)
+		validation_state_clear(&validation_state);
+}
+
+static size_t _batch_run(BatchChunk *proto, size_t count, unsigned threads)
+{
+	if (proto->errs)
+		memset(proto->errs, 0, count * sizeof(jerror *));
+
+	// Validation may only share a frozen schema between threads. Freezing
+	// is done once per schema, later batches only check the flag.
+	if (threads > count)
+		threads = count;
+	if (threads > 1 && !jschema_freeze(proto->schema, NULL))
+		threads = 1;
+
+	if (threads <= 1)
+	{
+		proto->begin = 0;
+		proto->end = count;
+		_batch_validate(proto, NULL);
+		return proto->valid;
+	}
+
+	BatchChunk *chunks = g_new(BatchChunk, threads);
+	GThreadPool *pool = g_thread_pool_new(_batch_validate, NULL, (gint) threads, FALSE, NULL);
+	for (unsigned t = 0; t < threads; ++t)
+	{
+		chunks[t] = *proto;
+		chunks[t].begin = count * t / threads;
+		chunks[t].end = count * (t + 1) / threads;
+		g_thread_pool_push(pool, &chunks[t], NULL);
+	}
+	// Wait for all the chunks to be checked
+	g_thread_pool_free(pool, FALSE, TRUE);
+
+	size_t valid = 0;
+	for (unsigned t = 0; t < threads; ++t)
+		valid += chunks[t].valid;
+	g_free(chunks);
+	return valid;
+}
+
+size_t jvalue_validate_batch(const jvalue_ref *vals, size_t count, const jschema_ref schema,
+                             bool *results, jerror **errs, unsigned threads)
+{
+	CHECK_POINTER_RETURN_VALUE(vals, 0);
+	CHECK_POINTER_RETURN_VALUE(schema, 0);
+	CHECK_POINTER_RETURN_VALUE(results, 0);
+
+	BatchChunk proto = {
+		.vals = vals,
+		.schema = schema,
+		.results = results,
+		.errs = errs,
+	};
+	return _batch_run(&proto, count, threads);
+}
+
+size_t jsax_validate_batch(const raw_buffer *inputs, size_t count, const jschema_ref schema,
+                           bool *results, jerror **errs, unsigned threads)
+{
+	CHECK_POINTER_RETURN_VALUE(inputs, 0);
+	CHECK_POINTER_RETURN_VALUE(schema, 0);
+	CHECK_POINTER_RETURN_VALUE(results, 0);
+
+	BatchChunk proto = {
+		.inputs = inputs,
+		.schema = schema,
+		.results = results,
+		.errs = errs,
+	};
+	return _batch_run(&proto, count, threads);
+}
@@ -0,0 +1,226 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "jobject.h"
+#include "jvalue_stringify.h"
+
+#include "jobject_internal.h"
+#include "jvalue_writer.h"
+#include "liblog.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Long strings are escaped in slices of this size, so that the pending
+// output never grows beyond a few of them
+#define SERIALIZER_STRING_SLICE 4096
+
+typedef struct _SerializerFrame
+{
+	jvalue_ref container;
+	ssize_t index;       // next array item
+	jobject_iter iter;   // next object member
+	bool first;
+} SerializerFrame;
+
+struct jserializer
+{
+	jvalue_ref root;
+
+	// Value to start with the next step, or NULL
+	jvalue_ref next;
+
+	// String, which is being written in slices
+	raw_buffer str;
+	size_t str_pos;
+	bool in_string;
+
+	SerializerFrame *stack;
+	size_t depth;
+	size_t stack_capacity;
+
+	// Output of the last step, which hasn't been read yet
+	JWriter pending;
+	size_t pending_pos;
+
+	bool done;
+	bool failed;
+};
+
+static bool push_frame(jserializer_ref s, jvalue_ref container)
+{
+	if (s->depth == s->stack_capacity)
+	{
+		size_t capacity = s->stack_capacity ? s->stack_capacity * 2 : 16;
+		SerializerFrame *stack = (SerializerFrame *) realloc(s->stack, capacity * sizeof(SerializerFrame));
+		if (UNLIKELY(stack == NULL))
+			return false;
+		s->stack = stack;
+		s->stack_capacity = capacity;
+	}
+
+	SerializerFrame *frame = &s->stack[s->depth++];
+	frame->container = container;
+	frame->index = 0;
+	frame->first = true;
+	if (jis_object(container))
+		jobject_iter_init(&frame->iter, container);
+	return true;
+}
+
+static bool start_value(jserializer_ref s, jvalue_ref val)
+{
+	switch (val->m_type)
+	{
+	case JV_STR:
+		jwriter_write_raw(&s->pending, "\"", 1);
+		s->str = jstring_deref(val)->m_data;
+		s->str_pos = 0;
+		s->in_string = true;
+		return true;
+	case JV_ARRAY:
+		jwriter_write_raw(&s->pending, "[", 1);
+		return push_frame(s, val);
+	case JV_OBJECT:
+		jwriter_write_raw(&s->pending, "{", 1);
+		return push_frame(s, val);
+	default:
+		return jwriter_write_value(&s->pending, val);
+	}
+}
+
+// Produce the next piece of the output into the pending buffer
+static bool step(jserializer_ref s)
+{
+	if (s->in_string)
+	{
+		size_t len = MIN(s->str.m_len - s->str_pos, SERIALIZER_STRING_SLICE);
+		jwriter_write_escaped(&s->pending, s->str.m_str + s->str_pos, len);
+		s->str_pos += len;
+		if (s->str_pos == s->str.m_len)
+		{
+			jwriter_write_raw(&s->pending, "\"", 1);
+			s->in_string = false;
+		}
+		return true;
+	}
+
+	if (s->next)
+	{
+		jvalue_ref val = s->next;
+		s->next = NULL;
+		return start_value(s, val);
+	}
+
+	if (s->depth == 0)
+	{
+		s->done = true;
+		return true;
+	}
+
+	SerializerFrame *frame = &s->stack[s->depth - 1];
+	if (jis_array(frame->container))
+	{
+		if (frame->index == jarray_size(frame->container))
+		{
+			jwriter_write_raw(&s->pending, "]", 1);
+			--s->depth;
+			return true;
+		}
+		if (frame->index)
+			jwriter_write_raw(&s->pending, ",", 1);
+		s->next = jarray_get(frame->container, frame->index++);
+		return true;
+	}
+
+	jobject_key_value key_value;
+	if (!jobject_iter_next(&frame->iter, &key_value))
+	{
+		jwriter_write_raw(&s->pending, "}", 1);
+		--s->depth;
+		return true;
+	}
+	if (!frame->first)
+		jwriter_write_raw(&s->pending, ",", 1);
+	frame->first = false;
+
+	raw_buffer key = jstring_deref(key_value.key)->m_data;
+	jwriter_write_string(&s->pending, key.m_str, key.m_len);
+	jwriter_write_raw(&s->pending, ":", 1);
+	s->next = key_value.value;
+	return true;
+}
+
+jserializer_ref jserializer_new(jvalue_ref val)
+{
+	CHECK_POINTER_RETURN_NULL(val);
+
+	jserializer_ref s = (jserializer_ref) calloc(1, sizeof(struct jserializer));
+	if (UNLIKELY(s == NULL))
+		return NULL;
+
+	s->root = jvalue_copy(val);
+	s->next = s->root;
+	jwriter_init(&s->pending);
+	return s;
+}
+
+ssize_t jserializer_read(jserializer_ref s, char *buf, size_t cap)
+{
+	CHECK_POINTER_RETURN_VALUE(s, -1);
+	if (s->failed)
+		return -1;
+
+	size_t written = 0;
+	while (written < cap)
+	{
+		if (s->pending_pos < s->pending.length)
+		{
+			size_t len = MIN(s->pending.length - s->pending_pos, cap - written);
+			memcpy(buf + written, s->pending.data + s->pending_pos, len);
+			s->pending_pos += len;
+			written += len;
+			continue;
+		}
+
+		if (s->done)
+			break;
+
+		// The buffer is drained, reuse it for the next step
+		s->pending.length = 0;
+		s->pending_pos = 0;
+		if (UNLIKELY(!step(s) || s->pending.failed))
+		{
+			s->failed = true;
+			return -1;
+		}
+	}
+
+	return written;
+}
+
+void jserializer_release(jserializer_ref *s)
+{
+	CHECK_POINTER(s);
+	if (!*s)
+		return;
+
+	j_release(&(*s)->root);
+	jwriter_destroy(&(*s)->pending);
+	free((*s)->stack);
+	free(*s);
+	*s = NULL;
+}
@@ -20,8 +20,13 @@
 
 #include "jobject_internal.h"
 #include "jtraverse.h"
+#include "jvalue_writer.h"
+#include "validation/serialization_plan.h"
 #include "gen_stream.h"
 
+// Scratch buffer on stack, where short pieces of the output are collected
+#define STRINGIFY_CHUNK_SIZE 4096
+
 static bool to_string_append_jnull(void *ctxt, jvalue_ref jref)
 {
 	JStreamRef generating = (JStreamRef)ctxt;
@@ -105,6 +110,28 @@ static struct TraverseCallbacks traverse = {
 	to_string_append_jarray_end,
 };
 
+// Serialize the value into a new string, to be released with free()
+static char *tostring_new(jvalue_ref val, const char *indent)
+{
+	// Compact output doesn't need the generator state machine
+	if (!indent) {
+		JWriter writer;
+		jwriter_init(&writer);
+		char *result = jwriter_write_value(&writer, val) ? jwriter_finish(&writer, NULL) : NULL;
+		jwriter_destroy(&writer);
+		return result;
+	}
+
+	JStreamRef generating = jstreamInternal(TOP_None, indent);
+	if (UNLIKELY(generating == NULL)) {
+		return NULL; // OOM
+	}
+	if (UNLIKELY(!jvalue_traverse(val, &traverse, generating))) {
+		return NULL; // We are not expecting that something goes wrong
+	}
+	return generating->finish(generating, NULL);
+}
+
 static const char *jvalue_tostring_internal(jvalue_ref val, JSchemaInfoRef schemainfo, const char *indent)
 {
 	if (UNLIKELY(val == NULL))
@@ -118,19 +145,15 @@ static const char *jvalue_tostring_internal(jvalue_ref val, JSchemaInfoRef schem
 	if (schemainfo && !jvalue_check_schema(val, schemainfo)) {
 		return NULL;
 	}
-	JStreamRef generating = jstreamInternal(TOP_None, indent);
-	if (UNLIKELY(generating == NULL)) {
-		return NULL; // OOM
-	}
-	if (UNLIKELY(!jvalue_traverse(val, &traverse, generating))) {
-		return NULL; // We are not expecting that something goes wrong
-	}
 
+	char *result = tostring_new(val, indent);
+	if (UNLIKELY(result == NULL)) {
+		return NULL;
+	}
 	val->m_string = (_jbuffer){
-		j_cstr_to_buffer(generating->finish(generating, NULL)),
+		j_cstr_to_buffer(result),
 		_jbuffer_free
 	};
-
 	return val->m_string.buffer.m_str;
 }
 
@@ -165,3 +188,125 @@ const char* jvalue_prettify(jvalue_ref val, const char *indent)
 {
 	return jvalue_tostring_internal(val, NULL, indent);
 }
+
+const char* jvalue_stringify_planned(jvalue_ref val, jstringify_plan_ref plan)
+{
+	if (UNLIKELY(val == NULL || plan == NULL))
+		return NULL;
+
+	_jbuffer *str = &val->m_string;
+	if (str->destructor) {
+		str->destructor(str);
+	}
+
+	JWriter writer;
+	jwriter_init(&writer);
+	char *result = jwriter_write_value_planned(&writer, val, plan->root) ? jwriter_finish(&writer, NULL) : NULL;
+	jwriter_destroy(&writer);
+	if (UNLIKELY(result == NULL)) {
+		return NULL;
+	}
+	val->m_string = (_jbuffer){
+		j_cstr_to_buffer(result),
+		_jbuffer_free
+	};
+	return val->m_string.buffer.m_str;
+}
+
+const char* jvalue_stringify_incremental(jvalue_ref val)
+{
+	if (UNLIKELY(val == NULL))
+		return NULL;
+
+	_jbuffer *str = &val->m_string;
+	if (str->destructor) {
+		str->destructor(str);
+	}
+
+	JWriter writer;
+	jwriter_init(&writer);
+	char *result = jwriter_write_value_cached(&writer, val) ? jwriter_finish(&writer, NULL) : NULL;
+	jwriter_destroy(&writer);
+	if (UNLIKELY(result == NULL)) {
+		return NULL;
+	}
+	val->m_string = (_jbuffer){
+		j_cstr_to_buffer(result),
+		_jbuffer_free
+	};
+	return val->m_string.buffer.m_str;
+}
+
+void jvalue_stringify_drop(jvalue_ref val)
+{
+	if (!val)
+		return;
+
+	if (val->m_string.destructor) {
+		val->m_string.destructor(&val->m_string);
+	}
+	jfragment_release_all(val);
+}
+
+static bool count_output(void *ctxt, const char *data, size_t len)
+{
+	*(size_t *)ctxt += len;
+	return true;
+}
+
+bool jvalue_stringify_to(jvalue_ref val, char *buf, size_t cap, size_t *len)
+{
+	size_t required = 0;
+	if (UNLIKELY(val == NULL)) {
+		if (len)
+			*len = required;
+		return false;
+	}
+
+	JWriter writer;
+	if (cap > 0) {
+		// Leave room for the terminating zero
+		jwriter_init_fixed(&writer, buf, cap - 1);
+		if (jwriter_write_value(&writer, val)) {
+			buf[writer.length] = '\0';
+			if (len)
+				*len = writer.length;
+			return true;
+		}
+	}
+
+	// Doesn't fit, measure the output for the caller
+	char scratch[STRINGIFY_CHUNK_SIZE];
+	jwriter_init_sink(&writer, scratch, sizeof(scratch), count_output, &required);
+	if (jwriter_write_value(&writer, val))
+		jwriter_flush(&writer);
+	if (len)
+		*len = required;
+	return false;
+}
+
+bool jvalue_stringify_sink(jvalue_ref val, jvalue_output_cb output, void *ctxt)
+{
+	if (UNLIKELY(val == NULL || output == NULL))
+		return false;
+
+	char scratch[STRINGIFY_CHUNK_SIZE];
+	JWriter writer;
+	jwriter_init_sink(&writer, scratch, sizeof(scratch), output, ctxt);
+	return jwriter_write_value(&writer, val) && jwriter_flush(&writer);
+}
+
+bool jvalue_prettify_sink(jvalue_ref val, const char *indent, jvalue_output_cb output, void *ctxt)
+{
+	if (!indent)
+		return jvalue_stringify_sink(val, output, ctxt);
+	if (UNLIKELY(val == NULL || output == NULL))
+		return false;
+
+	char *str = tostring_new(val, indent);
+	if (UNLIKELY(str == NULL))
+		return false;
+	bool res = output(ctxt, str, strlen(str));
+	free(str);
+	return res;
+}
@@ -0,0 +1,655 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "jobject.h"
+#include "jvalue_writer.h"
+#include "jobject_internal.h"
+#include "key_dictionary.h"
+#include "validation/serialization_plan.h"
+#include "liblog.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JWRITER_INITIAL_CAPACITY 256
+
+// The character to put after the backslash for the characters, which need escaping
+// ('u' stands for \u00XX), or 0. The same set is escaped by yajl_gen.
+static const char escapes[256] =
+{
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+	['"'] = '"',
+	['\\'] = '\\',
+};
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+static const char digit_pairs[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static bool jwriter_grow(JWriter *w, size_t count)
+{
+	size_t capacity = w->capacity ? w->capacity : JWRITER_INITIAL_CAPACITY;
+	while (capacity - w->length < count)
+	{
+		if (UNLIKELY(capacity > SIZE_MAX / 2))
+			return false;
+		capacity *= 2;
+	}
+
+	char *data = (char *) realloc(w->data, capacity);
+	if (UNLIKELY(data == NULL))
+		return false;
+	w->data = data;
+	w->capacity = capacity;
+	return true;
+}
+
+// Slow path of jwriter_put(): there's no room left in the buffer
+static void jwriter_overflow(JWriter *w, char const *str, size_t len)
+{
+	if (w->failed)
+		return;
+
+	if (w->sink)
+	{
+		if (!jwriter_flush(w))
+			return;
+		// Pass long pieces through without copying
+		if (len > w->capacity)
+		{
+			w->failed = !w->sink(w->sink_ctxt, str, len);
+			return;
+		}
+	}
+	else if (w->fixed || !jwriter_grow(w, len))
+	{
+		w->failed = true;
+		return;
+	}
+
+	memcpy(w->data + w->length, str, len);
+	w->length += len;
+}
+
+static inline void jwriter_put(JWriter *w, char const *str, size_t len)
+{
+	if (UNLIKELY(w->capacity - w->length < len))
+	{
+		jwriter_overflow(w, str, len);
+		return;
+	}
+	memcpy(w->data + w->length, str, len);
+	w->length += len;
+}
+
+static inline void jwriter_putc(JWriter *w, char c)
+{
+	if (UNLIKELY(w->capacity == w->length))
+	{
+		jwriter_overflow(w, &c, 1);
+		return;
+	}
+	w->data[w->length++] = c;
+}
+
+#define ONES UINT64_C(0x0101010101010101)
+#define HIGHS UINT64_C(0x8080808080808080)
+
+// Check eight characters at once for a control character, quote or backslash.
+// The SWAR zero byte test is exact for the question "is there any".
+static inline bool needs_escape8(uint64_t chars)
+{
+	uint64_t control = (chars - ONES * 0x20) & ~chars;
+	uint64_t quote = chars ^ (ONES * '"');
+	uint64_t backslash = chars ^ (ONES * '\\');
+	quote = (quote - ONES) & ~quote;
+	backslash = (backslash - ONES) & ~backslash;
+	return (control | quote | backslash) & HIGHS;
+}
+
+static void jwriter_put_escaped(JWriter *w, char const *str, size_t len)
+{
+	size_t start = 0;
+	size_t i = 0;
+	for (;;)
+	{
+		// Skip clean runs word by word, find the exact character byte by byte
+		while (i + sizeof(uint64_t) <= len)
+		{
+			uint64_t chars;
+			memcpy(&chars, str + i, sizeof(chars));
+			if (needs_escape8(chars))
+				break;
+			i += sizeof(chars);
+		}
+		while (i < len && !escapes[(unsigned char) str[i]])
+			++i;
+		if (i == len)
+			break;
+
+		jwriter_put(w, str + start, i - start);
+
+		unsigned char c = str[i];
+		char escaped[6] = { '\\', escapes[c], '0', '0' };
+		if (escapes[c] == 'u')
+		{
+			escaped[4] = hex_digits[c >> 4];
+			escaped[5] = hex_digits[c & 0xf];
+			jwriter_put(w, escaped, 6);
+		}
+		else
+			jwriter_put(w, escaped, 2);
+
+		start = ++i;
+	}
+
+	jwriter_put(w, str + start, len - start);
+}
+
+static void jwriter_put_string(JWriter *w, char const *str, size_t len)
+{
+	jwriter_putc(w, '"');
+	jwriter_put_escaped(w, str, len);
+	jwriter_putc(w, '"');
+}
+
+static void jwriter_put_int(JWriter *w, int64_t value)
+{
+	char buf[24];
+	char *end = buf + sizeof(buf);
+	char *p = end;
+
+	uint64_t u = value < 0 ? -(uint64_t) value : (uint64_t) value;
+	while (u >= 100)
+	{
+		p -= 2;
+		memcpy(p, digit_pairs + (u % 100) * 2, 2);
+		u /= 100;
+	}
+	if (u >= 10)
+	{
+		p -= 2;
+		memcpy(p, digit_pairs + u * 2, 2);
+	}
+	else
+		*--p = (char) ('0' + u);
+
+	if (value < 0)
+		*--p = '-';
+
+	jwriter_put(w, p, end - p);
+}
+
+static void jwriter_put_double(JWriter *w, double value)
+{
+	// Integral values below 1e14 look the same with "%.14lg" as integers
+	if (value > -1e14 && value < 1e14 && value == (double) (int64_t) value &&
+	    !(value == 0 && signbit(value)))
+	{
+		jwriter_put_int(w, (int64_t) value);
+		return;
+	}
+
+	// See val_dbl() in jgen_stream.c
+	char buf[32];
+	int len = snprintf(buf, sizeof(buf), "%.14lg", value);
+	jwriter_put(w, buf, len);
+}
+
+typedef struct _JFragmentSlot
+{
+	size_t offset;       // position in the text of the parent
+	jvalue_ref child;    // not referenced: the parent can't lose it without being modified
+} JFragmentSlot;
+
+// Cached text of a container. The nested containers have their own fragments,
+// and only their positions are kept here, so that they may change independently.
+struct _JFragment
+{
+	char *text;
+	size_t length;
+	size_t count;
+	JFragmentSlot slots[];
+};
+
+// Positions of the nested containers in the output, while a fragment is being built
+typedef struct _FragmentBuilder
+{
+	size_t count;
+	struct
+	{
+		size_t start;
+		size_t end;
+		jvalue_ref child;
+	} nested[];
+} FragmentBuilder;
+
+static bool jwriter_put_number(JWriter *w, jvalue_ref val)
+{
+	switch (jnum_deref(val)->m_type)
+	{
+	case NUM_RAW:
+		jwriter_put(w, jnum_deref(val)->value.raw.m_str, jnum_deref(val)->value.raw.m_len);
+		return true;
+	case NUM_FLOAT:
+		jwriter_put_double(w, jnum_deref(val)->value.floating);
+		return true;
+	case NUM_INT:
+		jwriter_put_int(w, jnum_deref(val)->value.integer);
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool jwriter_put_value(JWriter *w, jvalue_ref val);
+static bool jwriter_put_cached(JWriter *w, jvalue_ref val);
+
+static inline bool is_container(jvalue_ref val)
+{
+	return val->m_type == JV_ARRAY || val->m_type == JV_OBJECT;
+}
+
+static inline JFragment **container_fragment(jvalue_ref val)
+{
+	return val->m_type == JV_ARRAY ? &jarray_deref(val)->m_fragment : &jobject_deref(val)->m_fragment;
+}
+
+static bool jwriter_put_child(JWriter *w, jvalue_ref child, FragmentBuilder *b)
+{
+	if (!b || !is_container(child))
+		return jwriter_put_value(w, child);
+
+	size_t start = w->length;
+	if (!jwriter_put_cached(w, child))
+		return false;
+
+	b->nested[b->count].start = start;
+	b->nested[b->count].end = w->length;
+	b->nested[b->count].child = child;
+	++b->count;
+	return true;
+}
+
+static bool jwriter_put_container(JWriter *w, jvalue_ref val, FragmentBuilder *b)
+{
+	if (val->m_type == JV_ARRAY)
+	{
+		jwriter_putc(w, '[');
+		ssize_t size = jarray_size(val);
+		for (ssize_t i = 0; i < size; ++i)
+		{
+			if (i)
+				jwriter_putc(w, ',');
+			if (!jwriter_put_child(w, jarray_get(val, i), b))
+				return false;
+		}
+		jwriter_putc(w, ']');
+		return true;
+	}
+
+	jwriter_putc(w, '{');
+	bool first = true;
+	jobject_iter it;
+	jobject_iter_init(&it, val);
+	jobject_key_value key_value;
+	while (jobject_iter_next(&it, &key_value))
+	{
+		if (!first)
+			jwriter_putc(w, ',');
+		first = false;
+
+		raw_buffer key = jstring_deref(key_value.key)->m_data;
+		jwriter_put_string(w, key.m_str, key.m_len);
+		jwriter_putc(w, ':');
+		if (!jwriter_put_child(w, key_value.value, b))
+			return false;
+	}
+	jwriter_putc(w, '}');
+	return true;
+}
+
+static bool jwriter_put_value(JWriter *w, jvalue_ref val)
+{
+	switch (val->m_type)
+	{
+	case JV_NULL:
+		jwriter_put(w, "null", 4);
+		return true;
+
+	case JV_BOOL:
+		if (jboolean_deref(val)->value)
+			jwriter_put(w, "true", 4);
+		else
+			jwriter_put(w, "false", 5);
+		return true;
+
+	case JV_NUM:
+		return jwriter_put_number(w, val);
+
+	case JV_STR:
+		jwriter_put_string(w, jstring_deref(val)->m_data.m_str, jstring_deref(val)->m_data.m_len);
+		return true;
+
+	case JV_ARRAY:
+	case JV_OBJECT:
+		return jwriter_put_container(w, val, NULL);
+	}
+
+	return false;
+}
+
+// Cut the text of the nested containers out of the output written since start
+static JFragment *fragment_create(JWriter *w, size_t start, FragmentBuilder *b)
+{
+	JFragment *f = (JFragment *) malloc(sizeof(JFragment) + b->count * sizeof(JFragmentSlot));
+	if (UNLIKELY(f == NULL))
+		return NULL;
+
+	size_t length = w->length - start;
+	for (size_t i = 0; i < b->count; ++i)
+		length -= b->nested[i].end - b->nested[i].start;
+
+	f->text = (char *) malloc(length ? length : 1);
+	if (UNLIKELY(f->text == NULL))
+	{
+		free(f);
+		return NULL;
+	}
+	f->length = length;
+	f->count = b->count;
+
+	size_t pos = start;
+	size_t offset = 0;
+	for (size_t i = 0; i < b->count; ++i)
+	{
+		size_t len = b->nested[i].start - pos;
+		memcpy(f->text + offset, w->data + pos, len);
+		offset += len;
+		f->slots[i].offset = offset;
+		f->slots[i].child = b->nested[i].child;
+		pos = b->nested[i].end;
+	}
+	memcpy(f->text + offset, w->data + pos, w->length - pos);
+	return f;
+}
+
+static bool jwriter_put_cached(JWriter *w, jvalue_ref val)
+{
+	if (!is_container(val))
+		return jwriter_put_value(w, val);
+
+	JFragment **fragment = container_fragment(val);
+	if (*fragment)
+	{
+		JFragment *f = *fragment;
+		size_t pos = 0;
+		for (size_t i = 0; i < f->count; ++i)
+		{
+			jwriter_put(w, f->text + pos, f->slots[i].offset - pos);
+			pos = f->slots[i].offset;
+			if (!jwriter_put_cached(w, f->slots[i].child))
+				return false;
+		}
+		jwriter_put(w, f->text + pos, f->length - pos);
+		return true;
+	}
+
+	// Frozen values are written by several threads at once, nothing is
+	// stored in them
+	if (val->m_frozen)
+		return jwriter_put_value(w, val);
+
+	size_t children = val->m_type == JV_ARRAY ? (size_t) jarray_size(val) : jobject_size(val);
+	FragmentBuilder *b = (FragmentBuilder *) malloc(sizeof(FragmentBuilder) + children * sizeof(b->nested[0]));
+	if (UNLIKELY(b == NULL))
+		return jwriter_put_value(w, val);
+	b->count = 0;
+
+	size_t start = w->length;
+	bool res = jwriter_put_container(w, val, b);
+	// Nothing is cached from a broken output
+	if (res && !w->failed)
+		*fragment = fragment_create(w, start, b);
+
+	free(b);
+	return res;
+}
+
+static inline PlanProperty const *plan_find_property(PlanNode const *plan, jvalue_ref key)
+{
+	// Keys of the parsed objects are interned, so one lookup by the pointer tells everything
+	gsize index = plan->property_index
+		? GPOINTER_TO_SIZE(g_hash_table_lookup(plan->property_index, key))
+		: 0;
+	if (index)
+		return &plan->properties[index - 1];
+	if (keyDictionaryIsInterned(key))
+		return NULL;
+
+	// Objects built by hand may have their own copies of the keys
+	raw_buffer k = jstring_deref(key)->m_data;
+	for (size_t i = 0; i < plan->property_count; ++i)
+	{
+		raw_buffer pk = jstring_deref(plan->properties[i].key)->m_data;
+		if (pk.m_len == k.m_len && memcmp(pk.m_str, k.m_str, k.m_len) == 0)
+			return &plan->properties[i];
+	}
+	return NULL;
+}
+
+static bool jwriter_put_planned(JWriter *w, jvalue_ref val, PlanNode const *plan)
+{
+	switch (plan->kind)
+	{
+	case PLAN_STRING:
+		if (val->m_type != JV_STR)
+			break;
+		jwriter_put_string(w, jstring_deref(val)->m_data.m_str, jstring_deref(val)->m_data.m_len);
+		return true;
+
+	case PLAN_NUMBER:
+		if (val->m_type != JV_NUM)
+			break;
+		return jwriter_put_number(w, val);
+
+	case PLAN_ARRAY:
+	{
+		if (val->m_type != JV_ARRAY)
+			break;
+		jwriter_putc(w, '[');
+		ssize_t size = jarray_size(val);
+		for (ssize_t i = 0; i < size; ++i)
+		{
+			if (i)
+				jwriter_putc(w, ',');
+			if (!jwriter_put_planned(w, jarray_get(val, i), plan->items))
+				return false;
+		}
+		jwriter_putc(w, ']');
+		return true;
+	}
+
+	case PLAN_OBJECT:
+	{
+		if (val->m_type != JV_OBJECT)
+			break;
+		jwriter_putc(w, '{');
+		bool first = true;
+		jobject_iter it;
+		jobject_iter_init(&it, val);
+		jobject_key_value key_value;
+		while (jobject_iter_next(&it, &key_value))
+		{
+			if (!first)
+				jwriter_putc(w, ',');
+			first = false;
+
+			PlanProperty const *p = plan_find_property(plan, key_value.key);
+			if (p)
+			{
+				jwriter_put(w, p->literal, p->literal_len);
+				if (!jwriter_put_planned(w, key_value.value, p->value))
+					return false;
+				continue;
+			}
+
+			raw_buffer key = jstring_deref(key_value.key)->m_data;
+			jwriter_put_string(w, key.m_str, key.m_len);
+			jwriter_putc(w, ':');
+			if (!jwriter_put_value(w, key_value.value))
+				return false;
+		}
+		jwriter_putc(w, '}');
+		return true;
+	}
+
+	default:
+		break;
+	}
+
+	// Nothing special is known, or the value doesn't match the plan
+	return jwriter_put_value(w, val);
+}
+
+void jfragment_release(JFragment **fragment)
+{
+	if (*fragment)
+	{
+		free((*fragment)->text);
+		free(*fragment);
+		*fragment = NULL;
+	}
+}
+
+void jfragment_release_all(jvalue_ref val)
+{
+	if (!is_container(val))
+		return;
+
+	jfragment_release(container_fragment(val));
+	if (val->m_type == JV_ARRAY)
+	{
+		ssize_t size = jarray_size(val);
+		for (ssize_t i = 0; i < size; ++i)
+			jfragment_release_all(jarray_get(val, i));
+		return;
+	}
+
+	jobject_iter it;
+	jobject_iter_init(&it, val);
+	jobject_key_value key_value;
+	while (jobject_iter_next(&it, &key_value))
+		jfragment_release_all(key_value.value);
+}
+
+void jwriter_init(JWriter *w)
+{
+	*w = (JWriter) { NULL, 0, 0, false, false, NULL, NULL };
+}
+
+void jwriter_init_fixed(JWriter *w, char *buf, size_t cap)
+{
+	*w = (JWriter) { buf, 0, cap, true, false, NULL, NULL };
+}
+
+void jwriter_init_sink(JWriter *w, char *buf, size_t cap, JWriterSink sink, void *ctxt)
+{
+	assert(cap > 0);
+	*w = (JWriter) { buf, 0, cap, true, false, sink, ctxt };
+}
+
+void jwriter_destroy(JWriter *w)
+{
+	if (!w->fixed)
+		free(w->data);
+	jwriter_init(w);
+}
+
+bool jwriter_write_value(JWriter *w, jvalue_ref val)
+{
+	return jwriter_put_value(w, val) && !w->failed;
+}
+
+bool jwriter_write_value_planned(JWriter *w, jvalue_ref val, PlanNode const *plan)
+{
+	return jwriter_put_planned(w, val, plan) && !w->failed;
+}
+
+bool jwriter_write_value_cached(JWriter *w, jvalue_ref val)
+{
+	assert(!w->sink);
+	return jwriter_put_cached(w, val) && !w->failed;
+}
+
+void jwriter_write_raw(JWriter *w, const char *str, size_t len)
+{
+	jwriter_put(w, str, len);
+}
+
+void jwriter_write_escaped(JWriter *w, const char *str, size_t len)
+{
+	jwriter_put_escaped(w, str, len);
+}
+
+void jwriter_write_string(JWriter *w, const char *str, size_t len)
+{
+	jwriter_put_string(w, str, len);
+}
+
+bool jwriter_flush(JWriter *w)
+{
+	assert(w->sink);
+	if (w->failed)
+		return false;
+	if (w->length)
+	{
+		w->failed = !w->sink(w->sink_ctxt, w->data, w->length);
+		w->length = 0;
+	}
+	return !w->failed;
+}
+
+char *jwriter_finish(JWriter *w, size_t *length)
+{
+	assert(!w->fixed);
+	jwriter_putc(w, '\0');
+	if (w->failed)
+	{
+		jwriter_destroy(w);
+		return NULL;
+	}
+
+	// Don't keep the slack: the result may be kept with the value for long
+	char *result = (char *) realloc(w->data, w->length);
+	if (!result)
+		result = w->data;
+	if (length)
+		*length = w->length - 1;
+
+	jwriter_init(w);
+	return result;
+}
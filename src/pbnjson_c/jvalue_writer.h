@@ -0,0 +1,114 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <japi.h>
+#include <jtypes.h>
+
+typedef struct _PlanNode PlanNode;
+
+/** @brief Output callback of the writer, see jwriter_init_sink() */
+typedef bool (*JWriterSink)(void *ctxt, const char *data, size_t len);
+
+/**
+ * Serializer of DOM values straight into a buffer.
+ *
+ * It produces exactly the same compact text as the yajl based generator
+ * (see jgen_stream.c), but without the generator state machine and the
+ * callback per value. The buffer either grows with malloc(), or is fixed and
+ * owned by the caller, or is flushed to the sink whenever it fills up.
+ */
+typedef struct _JWriter
+{
+	char *data;          /**< @brief Output buffer */
+	size_t length;       /**< @brief Count of bytes in the buffer */
+	size_t capacity;     /**< @brief Size of the buffer */
+	bool fixed;          /**< @brief The buffer belongs to the caller and can't grow */
+	bool failed;         /**< @brief Memory allocation failed, the buffer overflowed or the sink refused data */
+	JWriterSink sink;    /**< @brief Receiver of the flushed data, or NULL */
+	void *sink_ctxt;     /**< @brief Context of the sink */
+} JWriter;
+
+/** @brief Prepare an empty writer, the buffer is allocated lazily */
+PJSON_LOCAL void jwriter_init(JWriter *w);
+
+/** @brief Prepare a writer into the caller's buffer, that can't grow */
+PJSON_LOCAL void jwriter_init_fixed(JWriter *w, char *buf, size_t cap);
+
+/** @brief Prepare a writer, that passes the output to the sink in pieces.
+ *
+ * @param buf Scratch buffer to collect small pieces (not empty)
+ * @param cap Size of the scratch buffer
+ */
+PJSON_LOCAL void jwriter_init_sink(JWriter *w, char *buf, size_t cap, JWriterSink sink, void *ctxt);
+
+/** @brief Release the buffer of the growable writer */
+PJSON_LOCAL void jwriter_destroy(JWriter *w);
+
+/** @brief Append the value to the output.
+ *
+ * @return false if the output couldn't be written
+ */
+PJSON_LOCAL bool jwriter_write_value(JWriter *w, jvalue_ref val);
+
+/** @brief Append the value following the serialization plan compiled from a schema.
+ *
+ * The output is the same as of jwriter_write_value(), but the known keys are
+ * copied from the precomputed literals, and the type dispatch is skipped for
+ * the values matching the plan.
+ *
+ * @return false if the output couldn't be written
+ */
+PJSON_LOCAL bool jwriter_write_value_planned(JWriter *w, jvalue_ref val, PlanNode const *plan);
+
+/** @brief Append the value reusing and filling the cached texts of the containers.
+ *
+ * Every container in the value keeps its text without the nested containers
+ * (see JFragment), so that only the modified ones are serialized again.
+ * The writer must not have a sink: the nested texts are cut out of its buffer.
+ *
+ * @return false if the output couldn't be written
+ */
+PJSON_LOCAL bool jwriter_write_value_cached(JWriter *w, jvalue_ref val);
+
+/** @brief Release the cached texts of all the containers in the value */
+PJSON_LOCAL void jfragment_release_all(jvalue_ref val);
+
+/** @brief Append the text as is */
+PJSON_LOCAL void jwriter_write_raw(JWriter *w, const char *str, size_t len);
+
+/** @brief Append the string contents with escaping, but without quotes.
+ *
+ * Escaping goes byte by byte, so a string may be written in arbitrary slices.
+ */
+PJSON_LOCAL void jwriter_write_escaped(JWriter *w, const char *str, size_t len);
+
+/** @brief Append the quoted and escaped string */
+PJSON_LOCAL void jwriter_write_string(JWriter *w, const char *str, size_t len);
+
+/** @brief Pass the rest of the collected output to the sink */
+PJSON_LOCAL bool jwriter_flush(JWriter *w);
+
+/** @brief Take the null-terminated output from the growable writer.
+ *
+ * @param[out] length Length of the output (may be NULL)
+ * @return The buffer to be released with free(), or NULL if writing failed.
+ *         The writer is empty afterwards.
+ */
+PJSON_LOCAL char *jwriter_finish(JWriter *w, size_t *length);
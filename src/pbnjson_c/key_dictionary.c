@@ -119,3 +119,8 @@ jvalue_ref keyDictionaryLookup(const char *key, size_t keyLen)
 		return jstr;
 	}
 }
+
+bool keyDictionaryIsInterned(jvalue_ref key)
+{
+	return key->m_type == JV_STR && jstring_deref(key)->m_dealloc == keyStringDtor;
+}
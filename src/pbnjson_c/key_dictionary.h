@@ -17,5 +17,9 @@
 #pragma once
 
 #include "jtypes.h"
+#include <stdbool.h>
 
 jvalue_ref keyDictionaryLookup(const char *key, size_t keyLen);
+
+// Tell whether the string is the instance returned by keyDictionaryLookup()
+bool keyDictionaryIsInterned(jvalue_ref key);
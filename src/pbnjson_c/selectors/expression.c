@@ -145,13 +145,11 @@ static jvalue_ref eval_composition(SelEx *v, jvalue_ref ctxt)
 	jvalue_ref a = e->lhs->eval(e->lhs, ctxt);
 	jvalue_ref b = e->rhs->eval(e->rhs, ctxt);
 
+	// The expression is shared by the evaluations, it isn't changed
 	int r = e->composition(a, b);
 	if (r == -1)
 		return jinvalid();
-	else
-		v->value = r == 0 ? jboolean_false()
-		                  : jboolean_true();
-	return v->value;
+	return r == 0 ? jboolean_false() : jboolean_true();
 }
 
 SelEx* sel_ex_composition(SelEx *lhs, SelEx *rhs, compose_func composition)
@@ -25,6 +25,7 @@
 
 #include "jquery_generated_declarations.h"
 #include "jquery_selectors.h"
+#include "jquery_plan.h"
 
 jquery_ptr
 jquery_new(selector_filter_function sfunc,
@@ -47,6 +48,7 @@ void jquery_free(jquery_ptr query)
 	if (NULL == query) return;
 
 	jquery_free(query->parent_query);
+	jq_plan_free(query->plan);
 	jq_generator_free(query->generator.next_gen);
 	if (query->ctxt_destructor)
 	{
@@ -56,6 +58,40 @@ void jquery_free(jquery_ptr query)
 	g_free(query);
 }
 
+void *jquery_context_clone(void *ctxt, query_context_destructor destructor)
+{
+	if (destructor == (query_context_destructor) jquery_free)
+		return jquery_clone((jquery_ptr) ctxt);
+
+	if (destructor == (query_context_destructor) jquery_pair_ptr_free)
+	{
+		jquery_pair_ptr pair = (jquery_pair_ptr) ctxt;
+		jquery_pair_ptr clone_pair = g_new(struct __query_pair, 1);
+		clone_pair->first = jquery_clone(pair->first);
+		clone_pair->second = jquery_clone(pair->second);
+		return clone_pair;
+	}
+
+	return NULL;
+}
+
+jquery_ptr jquery_clone(jquery_ptr query)
+{
+	if (NULL == query) return NULL;
+
+	jquery_ptr clone = jquery_new(query->sel_func, query->sel_ctxt, NULL, query->generator.type);
+	clone->parent_query = jquery_clone(query->parent_query);
+
+	void *ctxt = jquery_context_clone(query->sel_ctxt, query->ctxt_destructor);
+	if (ctxt)
+	{
+		clone->sel_ctxt = ctxt;
+		clone->ctxt_destructor = query->ctxt_destructor;
+	}
+
+	return clone;
+}
+
 jquery_ptr jquery_create(const char *str, jerror **err)
 {
 	CHECK_POINTER_SET_ERROR_RETURN_NULL(str, err);
@@ -109,15 +145,20 @@ jquery_ptr jquery_create(const char *str, jerror **err)
 	}
 
 	// Add recursive root generator, to iterate over the source user JSON
+	jquery_ptr query;
 	if (context.root_pair.root_query)
 	{
 		context.root_pair.root_query->parent_query = jquery_new(selector_all, NULL, NULL, JQG_TYPE_RECURSIVE);
-		return context.root_pair.deepest_query;
+		query = context.root_pair.deepest_query;
 	}
 	else
 	{
-		return jquery_new(selector_all, NULL, NULL, JQG_TYPE_RECURSIVE);
+		query = jquery_new(selector_all, NULL, NULL, JQG_TYPE_RECURSIVE);
 	}
+
+	// Walk the DOM once instead of pulling every node through the generators
+	query->plan = jq_plan_new(query);
+	return query;
 }
 
 static jvalue_search_result
@@ -159,6 +200,9 @@ jquery_internal_next(jquery_ptr query)
 
 jvalue_ref jquery_next(jquery_ptr query)
 {
+	if (query->plan)
+		return jq_plan_next(query->plan);
+
 	jvalue_search_result result = jquery_internal_next(query);
 	return result.value;
 }
@@ -185,8 +229,93 @@ bool jquery_init(jquery_ptr query, jvalue_ref JSON, jerror **err)
 	CHECK_POINTER_SET_ERROR_RETURN(query, false, err, "'query' parameter must be a non-null pointer");
 	CHECK_POINTER_SET_ERROR_RETURN(JSON, false, err, "'JSON' parameter must be a non-null pointer");
 
+	if (query->plan)
+	{
+		jq_plan_init(query->plan, JSON);
+		return true;
+	}
+
 	jvalue_search_result val = { JSON, NULL };
 	jquery_internal_init(query, val);
 
 	return true;
 }
+
+struct jquery_cursor
+{
+	// Evaluation of the compiled query, it shares the program with the query
+	jq_plan *plan;
+	// Private copy of the query, which can't be planned. It keeps the state
+	// of the generators.
+	jquery_ptr query;
+	// Count of the results taken from the query
+	size_t position;
+	jvalue_ref json;
+};
+
+jquery_cursor_ref jquery_cursor_new(jquery_ptr query, jvalue_ref JSON, jerror **err)
+{
+	CHECK_POINTER_SET_ERROR_RETURN(query, NULL, err, "'query' parameter must be a non-null pointer");
+	CHECK_POINTER_SET_ERROR_RETURN(JSON, NULL, err, "'JSON' parameter must be a non-null pointer");
+
+	jquery_cursor_ref cursor = g_new0(struct jquery_cursor, 1);
+	cursor->json = jvalue_copy(JSON);
+	if (query->plan)
+	{
+		cursor->plan = jq_plan_fork(query->plan);
+		jq_plan_init(cursor->plan, cursor->json);
+		return cursor;
+	}
+
+	cursor->query = jquery_clone(query);
+	if (!jquery_init(cursor->query, cursor->json, err))
+		jquery_cursor_release(&cursor);
+	return cursor;
+}
+
+jvalue_ref jquery_cursor_next(jquery_cursor_ref cursor)
+{
+	CHECK_POINTER_RETURN_VALUE(cursor, jinvalid());
+	if (cursor->plan)
+		return jq_plan_next(cursor->plan);
+
+	jvalue_ref val = jquery_next(cursor->query);
+	if (jis_valid(val))
+		++cursor->position;
+	return val;
+}
+
+jquery_cursor_ref jquery_cursor_copy(jquery_cursor_ref cursor)
+{
+	CHECK_POINTER_RETURN_NULL(cursor);
+
+	jquery_cursor_ref copy = g_new0(struct jquery_cursor, 1);
+	copy->json = jvalue_copy(cursor->json);
+	if (cursor->plan)
+	{
+		copy->plan = jq_plan_copy(cursor->plan);
+		return copy;
+	}
+
+	// The generators point into each other, so the copy takes the same
+	// results once more instead
+	copy->query = jquery_clone(cursor->query);
+	jquery_init(copy->query, copy->json, NULL);
+	while (copy->position < cursor->position)
+		jquery_cursor_next(copy);
+	return copy;
+}
+
+void jquery_cursor_release(jquery_cursor_ref *cursor)
+{
+	CHECK_POINTER(cursor);
+	jquery_cursor_ref c = *cursor;
+	if (!c)
+		return;
+
+	*cursor = NULL;
+	jq_plan_free(c->plan);
+	jquery_free(c->query);
+	j_release(&c->json);
+	g_free(c);
+}
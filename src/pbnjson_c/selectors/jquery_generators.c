@@ -35,6 +35,14 @@ void jq_generator_reset(jquery_generator_ptr generator, jvalue_search_result jso
 	generator->json = json;
 	generator->array_iterator = 0;
 	generator->self_returned = false;
+
+	// The nested generator still points into the previous value, which may be
+	// gone already. It's reset with a child, before it's used again.
+	if (generator->next_gen)
+	{
+		generator->next_gen->json = (jvalue_search_result) { jinvalid(), NULL };
+		generator->next_gen->self_returned = true;
+	}
 }
 
 void jq_generator_free(jquery_generator_ptr generator)
@@ -84,6 +92,11 @@ jvalue_search_result jq_generator_next(jquery_generator_ptr generator)
 	{
 		return (jvalue_search_result){ jinvalid(), generator->json.parent };
 	}
+	// Nothing is left below an invalid value
+	else if (!jis_valid(generator->json.value))
+	{
+		return (jvalue_search_result){ jinvalid(), generator->json.parent };
+	}
 
 	// If the object is not new, we probably have valid recursive generator
 	if (NULL != generator->next_gen)
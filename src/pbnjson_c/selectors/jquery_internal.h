@@ -32,6 +32,8 @@ extern "C" {
 
 typedef void (*query_context_destructor)(void *);
 
+struct jq_plan;
+
 struct jquery
 {
 	// Check if current JSON satisfies the selector
@@ -42,6 +44,9 @@ struct jquery
 	jquery_ptr parent_query;
 	// Object generator
 	jquery_generator generator;
+	// Evaluation of the whole query over a DOM (see jquery_plan.h).
+	// Set for the query returned by jquery_create(), if it can be planned.
+	struct jq_plan *plan;
 };
 
 /* root_query points to the most general query, which takes
@@ -72,6 +77,20 @@ jquery_ptr jquery_new(selector_filter_function sfunc,
                       query_context_destructor ctxt_destr,
                       jquery_generator_type generator_type);
 
+/* Copy the query tree without the state of the evaluation.
+ *
+ * Nested queries are copied too, as they're evaluated for every node.
+ * The rest of the selector contexts isn't changed by the evaluation, so it's
+ * shared with the original query, which owns it.
+ */
+jquery_ptr jquery_clone(jquery_ptr query);
+
+/* Copy the context of a selector with nested queries (see jquery_clone).
+ * Returns NULL, if the context doesn't keep any state of the evaluation.
+ * The copy is freed with the same destructor.
+ */
+void *jquery_context_clone(void *ctxt, query_context_destructor destructor);
+
 /* Function preserves found object keys, array indexes and pointers to parents.
  * Should be used in the jquery combinators
  */
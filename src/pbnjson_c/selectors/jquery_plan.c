@@ -0,0 +1,931 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "jquery_plan.h"
+
+#include <string.h>
+
+#include "../jobject_internal.h"
+#include "../jindex_internal.h"
+
+#define CHAIN_BIT(id) (((guint64) 1) << (id))
+
+#define HAS_TRUE GINT_TO_POINTER(1)
+#define HAS_FALSE GINT_TO_POINTER(2)
+
+static void chain_free(jq_chain *chain)
+{
+	for (size_t i = 0; i < chain->count; ++i)
+	{
+		jq_filter *f = &chain->filters[i];
+		if (f->kind == JQF_HAS)
+			jq_program_free(f->nested);
+	}
+	g_free(chain->filters);
+}
+
+// Drop the chains added since the count was saved
+static void program_truncate(jq_program *p, size_t count)
+{
+	while (p->count > count)
+		chain_free(&p->chains[--p->count]);
+	if (count < JQ_PROGRAM_MAX_CHAINS)
+		p->lazy &= CHAIN_BIT(count) - 1;
+}
+
+void jq_program_free(jq_program *p)
+{
+	if (!p)
+		return;
+	program_truncate(p, 0);
+	g_free(p);
+}
+
+// The result for a node doesn't depend on the ancestors of the node
+static bool program_is_local(jq_program const *p)
+{
+	if (p->lazy)
+		return false;
+	for (size_t c = 0; c < p->count; ++c)
+	{
+		for (size_t i = 0; i < p->chains[c].count; ++i)
+		{
+			switch (p->chains[c].filters[i].kind)
+			{
+			case JQF_ROOT:
+			case JQF_PARENT:
+			case JQF_ANCESTOR:
+				return false;
+			case JQF_FUNC:
+				// The query for the siblings may look above the parent
+				if (p->chains[c].filters[i].func == selector_sibling)
+					return false;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+static bool compile_chain(jq_program *p, jquery_ptr query, jq_program_mode mode, bool top, size_t *id);
+
+static bool compile_nested(jq_program *p, jquery_ptr query, jq_program_mode mode, guint64 *chains)
+{
+	size_t count = p->count;
+	size_t id;
+	if (!compile_chain(p, query, mode, false, &id))
+	{
+		program_truncate(p, count);
+		if (mode != JQ_PROGRAM_DOM || p->count == JQ_PROGRAM_MAX_CHAINS)
+			return false;
+
+		// The query is left to the generators. Its result for every node
+		// is kept as a bit too, so that it's evaluated once per node.
+		id = p->count++;
+		p->chains[id] = (jq_chain) { .filters = NULL, .count = 0, .query = query };
+		p->lazy |= CHAIN_BIT(id);
+	}
+	*chains |= CHAIN_BIT(id);
+	return true;
+}
+
+// Compile both queries of the pair, or neither of them
+static bool compile_pair(jq_program *p, jquery_pair_ptr pair, jq_program_mode mode, guint64 *chains)
+{
+	size_t count = p->count;
+	guint64 both = 0;
+	if (!compile_nested(p, pair->first, mode, &both) ||
+	    !compile_nested(p, pair->second, mode, &both))
+	{
+		program_truncate(p, count);
+		return false;
+	}
+	*chains |= both;
+	return true;
+}
+
+static bool compile_filter(jq_program *p, jquery_ptr q, jq_program_mode mode, GArray *filters)
+{
+	jq_filter f = { 0 };
+
+	if (q->sel_func == selector_all)
+	{
+		return true;
+	}
+	else if (q->sel_func == selector_key)
+	{
+		f.kind = JQF_KEY;
+		f.key = (jvalue_ref) q->sel_ctxt;
+		f.key_str = jstring_get_fast(f.key);
+	}
+	else if (q->sel_func == selector_type)
+	{
+		f.kind = JQF_TYPE;
+		f.type = (JValueType) q->sel_ctxt;
+	}
+	else if (q->sel_func == selector_root)
+	{
+		f.kind = JQF_ROOT;
+	}
+	else if (q->sel_func == selector_nth_child && GPOINTER_TO_INT(q->sel_ctxt) >= 1)
+	{
+		f.kind = JQF_NTH_CHILD;
+		f.index = GPOINTER_TO_INT(q->sel_ctxt) - 1;
+	}
+	else if ((q->sel_func == selector_parent || q->sel_func == selector_ancestor) &&
+	         compile_nested(p, (jquery_ptr) q->sel_ctxt, mode, &f.chains))
+	{
+		f.kind = q->sel_func == selector_parent ? JQF_PARENT : JQF_ANCESTOR;
+	}
+	else if (q->sel_func == selector_or &&
+	         compile_pair(p, (jquery_pair_ptr) q->sel_ctxt, mode, &f.chains))
+	{
+		f.kind = JQF_OR;
+	}
+	else if (q->sel_func == selector_has && mode == JQ_PROGRAM_DOM)
+	{
+		f.kind = JQF_HAS;
+		f.query = (jquery_ptr) q->sel_ctxt;
+		f.nested = jq_program_compile(f.query, JQ_PROGRAM_DOM);
+		if (f.nested && !program_is_local(f.nested))
+		{
+			jq_program_free(f.nested);
+			f.nested = NULL;
+		}
+		p->needs_values = true;
+	}
+	else if (mode == JQ_PROGRAM_DOM ||
+	         q->sel_func == selector_contains ||
+	         (q->sel_func == selector_value &&
+	          !jis_object((jvalue_ref) q->sel_ctxt) && !jis_array((jvalue_ref) q->sel_ctxt)))
+	{
+		// Counting from the end and the rest of the document are left to
+		// the selector itself
+		f.kind = JQF_FUNC;
+		f.func = q->sel_func;
+		f.ctxt = q->sel_ctxt;
+		f.ctxt_destructor = q->ctxt_destructor;
+		p->needs_values = true;
+	}
+	else
+	{
+		return false;
+	}
+
+	g_array_append_val(filters, f);
+	return true;
+}
+
+static bool compile_chain(jq_program *p, jquery_ptr query, jq_program_mode mode, bool top, size_t *id)
+{
+	// The selectors are applied from the root of the chain
+	GPtrArray *queries = g_ptr_array_new();
+	for (jquery_ptr q = query; q; q = q->parent_query)
+		g_ptr_array_add(queries, q);
+
+	bool res = true;
+	GArray *filters = g_array_new(FALSE, FALSE, sizeof(jq_filter));
+	for (guint i = queries->len; res && i > 0; --i)
+	{
+		jquery_ptr q = (jquery_ptr) g_ptr_array_index(queries, i - 1);
+
+		// The top query iterates over every node, the rest select that very node
+		if (top && i == queries->len)
+			res = q->generator.type == JQG_TYPE_RECURSIVE && q->sel_func == selector_all;
+		else
+			res = q->generator.type == JQG_TYPE_SELF && compile_filter(p, q, mode, filters);
+	}
+	g_ptr_array_free(queries, TRUE);
+
+	jq_chain chain = { .filters = NULL, .count = filters->len, .query = NULL };
+	chain.filters = (jq_filter *) g_array_free(filters, FALSE);
+	if (!res || p->count == JQ_PROGRAM_MAX_CHAINS)
+	{
+		chain_free(&chain);
+		return false;
+	}
+
+	*id = p->count++;
+	p->chains[*id] = chain;
+	return true;
+}
+
+// Count of the slots of the state, the filter needs
+static size_t filter_slots(jq_filter const *f)
+{
+	switch (f->kind)
+	{
+	case JQF_HAS:
+		// The memoized results, and the state of the nested program or the query
+		return 2;
+	case JQF_FUNC:
+		// The combinators, which weren't compiled, evaluate the nested queries
+		return f->ctxt_destructor == (query_context_destructor) jquery_free ||
+		       f->ctxt_destructor == (query_context_destructor) jquery_pair_ptr_free;
+	default:
+		return 0;
+	}
+}
+
+static void program_number_slots(jq_program *p)
+{
+	for (size_t c = 0; c < p->count; ++c)
+	{
+		jq_chain *chain = &p->chains[c];
+		if (p->lazy & CHAIN_BIT(c))
+			chain->slot = p->slots++;
+		for (size_t i = 0; i < chain->count; ++i)
+		{
+			jq_filter *f = &chain->filters[i];
+			size_t count = filter_slots(f);
+			if (count)
+			{
+				f->slot = p->slots;
+				p->slots += count;
+			}
+		}
+	}
+}
+
+jq_program *jq_program_compile(jquery_ptr query, jq_program_mode mode)
+{
+	jq_program *p = g_new0(jq_program, 1);
+	size_t id;
+	if (!compile_chain(p, query, mode, true, &id))
+	{
+		jq_program_free(p);
+		return NULL;
+	}
+	program_number_slots(p);
+	return p;
+}
+
+struct jq_state
+{
+	jq_program const *program;
+	gpointer *slots;
+};
+
+jq_state *jq_state_new(jq_program const *p)
+{
+	jq_state *st = g_new0(jq_state, 1);
+	st->program = p;
+	st->slots = g_new0(gpointer, p->slots);
+	for (size_t c = 0; c < p->count; ++c)
+	{
+		jq_chain const *chain = &p->chains[c];
+		if (p->lazy & CHAIN_BIT(c))
+			st->slots[chain->slot] = jquery_clone(chain->query);
+		for (size_t i = 0; i < chain->count; ++i)
+		{
+			jq_filter const *f = &chain->filters[i];
+			if (f->kind == JQF_HAS)
+			{
+				st->slots[f->slot] = g_hash_table_new(g_direct_hash, g_direct_equal);
+				st->slots[f->slot + 1] = f->nested
+				                         ? (gpointer) jq_state_new(f->nested)
+				                         : (gpointer) jquery_clone(f->query);
+			}
+			else if (filter_slots(f))
+			{
+				st->slots[f->slot] = jquery_context_clone(f->ctxt, f->ctxt_destructor);
+			}
+		}
+	}
+	return st;
+}
+
+void jq_state_free(jq_state *st)
+{
+	if (!st)
+		return;
+
+	jq_program const *p = st->program;
+	for (size_t c = 0; c < p->count; ++c)
+	{
+		jq_chain const *chain = &p->chains[c];
+		if (p->lazy & CHAIN_BIT(c))
+			jquery_free((jquery_ptr) st->slots[chain->slot]);
+		for (size_t i = 0; i < chain->count; ++i)
+		{
+			jq_filter const *f = &chain->filters[i];
+			if (f->kind == JQF_HAS)
+			{
+				g_hash_table_destroy((GHashTable *) st->slots[f->slot]);
+				if (f->nested)
+					jq_state_free((jq_state *) st->slots[f->slot + 1]);
+				else
+					jquery_free((jquery_ptr) st->slots[f->slot + 1]);
+			}
+			else if (filter_slots(f))
+			{
+				f->ctxt_destructor(st->slots[f->slot]);
+			}
+		}
+	}
+	g_free(st->slots);
+	g_free(st);
+}
+
+void jq_state_reset(jq_state *st)
+{
+	jq_program const *p = st->program;
+	for (size_t c = 0; c < p->count; ++c)
+	{
+		for (size_t i = 0; i < p->chains[c].count; ++i)
+		{
+			jq_filter const *f = &p->chains[c].filters[i];
+			if (f->kind == JQF_HAS)
+			{
+				g_hash_table_remove_all((GHashTable *) st->slots[f->slot]);
+				if (f->nested)
+					jq_state_reset((jq_state *) st->slots[f->slot + 1]);
+			}
+		}
+	}
+}
+
+// Check the query, which wasn't compiled, the same way as the combinators do
+static bool query_matches(jq_state *st, jq_chain const *chain, jvalue_search_result *node)
+{
+	jquery_ptr query = (jquery_ptr) st->slots[chain->slot];
+	jquery_internal_init(query, *node);
+	return jis_valid(jquery_next(query));
+}
+
+static bool scope_bits(jq_program const *p, jq_state *st, jq_scope *s, guint64 chains)
+{
+	guint64 lazy = chains & p->lazy & ~s->known;
+	for (size_t c = 0; lazy; ++c, lazy >>= 1)
+	{
+		if (!(lazy & 1))
+			continue;
+		if (query_matches(st, &p->chains[c], s->node))
+			s->bits |= CHAIN_BIT(c);
+		s->known |= CHAIN_BIT(c);
+	}
+	return s->bits & chains;
+}
+
+static bool scope_ancestors(jq_program const *p, jq_state *st, jq_scope *s, guint64 chains)
+{
+	guint64 lazy = chains & p->lazy & ~s->ancestors_known;
+	for (size_t c = 0; lazy; ++c, lazy >>= 1)
+	{
+		if (!(lazy & 1))
+			continue;
+		if (scope_bits(p, st, s, CHAIN_BIT(c)) || (s->parent && scope_ancestors(p, st, s->parent, CHAIN_BIT(c))))
+			s->ancestors |= CHAIN_BIT(c);
+		s->ancestors_known |= CHAIN_BIT(c);
+	}
+	return s->ancestors & chains;
+}
+
+/* Check, if the nested query matches a node below the container.
+ *
+ * The nested query depends on the node only, so the result for every
+ * container is found once, going from the leaves up to it.
+ */
+static bool has_below(jq_state *st, jq_filter const *f, jvalue_search_result *container)
+{
+	GHashTable *memo = (GHashTable *) st->slots[f->slot];
+	jq_state *nested = (jq_state *) st->slots[f->slot + 1];
+	gpointer known = g_hash_table_lookup(memo, container->value);
+	if (known)
+		return known == HAS_TRUE;
+
+	jq_scope scope = { 0 };
+	jvalue_search_result child = { NULL, container, -1, NULL };
+	bool found = false;
+	if (jis_object(container->value))
+	{
+		jobject_iter it;
+		jobject_key_value keyval;
+		jobject_iter_init(&it, container->value);
+		while (!found && jobject_iter_next(&it, &keyval))
+		{
+			child.value = keyval.value;
+			child.value_key = keyval.key;
+			jq_node n = {
+				.key = jstring_get_fast(keyval.key),
+				.key_value = keyval.key,
+				.index = -1,
+				.type = keyval.value->m_type,
+				.result = &child,
+			};
+			found = jq_program_matches(f->nested, jq_program_check(f->nested, nested, &n, &scope)) ||
+			        ((jis_object(child.value) || jis_array(child.value)) && has_below(st, f, &child));
+		}
+	}
+	else
+	{
+		for (ssize_t i = 0; !found && i < jarray_size(container->value); ++i)
+		{
+			child.value = jarray_get(container->value, i);
+			child.value_index = i;
+			jq_node n = {
+				.index = i,
+				.type = child.value->m_type,
+				.result = &child,
+			};
+			found = jq_program_matches(f->nested, jq_program_check(f->nested, nested, &n, &scope)) ||
+			        ((jis_object(child.value) || jis_array(child.value)) && has_below(st, f, &child));
+		}
+	}
+
+	g_hash_table_insert(memo, container->value, found ? HAS_TRUE : HAS_FALSE);
+	return found;
+}
+
+static bool check_has(jq_state *st, jq_filter const *f, jvalue_search_result *json)
+{
+	// The nested query is evaluated with the node as the root
+	jvalue_search_result root = { json->value, NULL, -1, NULL };
+
+	if (!f->nested)
+	{
+		GHashTable *memo = (GHashTable *) st->slots[f->slot];
+		gpointer known = g_hash_table_lookup(memo, json->value);
+		if (!known)
+		{
+			known = selector_has(&root, st->slots[f->slot + 1]) ? HAS_TRUE : HAS_FALSE;
+			g_hash_table_insert(memo, json->value, known);
+		}
+		return known == HAS_TRUE;
+	}
+
+	jq_node n = {
+		.index = -1,
+		.type = json->value->m_type,
+		.result = &root,
+	};
+	jq_state *nested = (jq_state *) st->slots[f->slot + 1];
+	if (jq_program_matches(f->nested, jq_program_check(f->nested, nested, &n, NULL)))
+		return true;
+	return (jis_object(json->value) || jis_array(json->value)) && has_below(st, f, &root);
+}
+
+static bool check_filter(jq_program const *p, jq_state *st, jq_filter const *f, jq_node const *n,
+                         guint64 bits, jq_scope *parent)
+{
+	switch (f->kind)
+	{
+	case JQF_KEY:
+		if (!n->key.m_str)
+			return false;
+		// Keys of the parsed documents are interned the same way
+		if (n->key_value == f->key)
+			return true;
+		return n->key.m_len == f->key_str.m_len && memcmp(n->key.m_str, f->key_str.m_str, f->key_str.m_len) == 0;
+	case JQF_TYPE:
+		return n->type == f->type;
+	case JQF_ROOT:
+		return !parent;
+	case JQF_NTH_CHILD:
+		return n->index == f->index;
+	case JQF_FUNC:
+		return n->result && f->func(n->result, filter_slots(f) ? st->slots[f->slot] : f->ctxt);
+	case JQF_HAS:
+		return n->result && check_has(st, f, n->result);
+	case JQF_PARENT:
+		return parent && scope_bits(p, st, parent, f->chains);
+	case JQF_ANCESTOR:
+		return parent && scope_ancestors(p, st, parent, f->chains);
+	case JQF_OR:
+		if (bits & f->chains)
+			return true;
+		for (size_t c = 0; c < p->count; ++c)
+		{
+			if ((f->chains & p->lazy & CHAIN_BIT(c)) && n->result && query_matches(st, &p->chains[c], n->result))
+				return true;
+		}
+		return false;
+	}
+	return false;
+}
+
+guint64 jq_program_check(jq_program const *p, jq_state *st, jq_node const *n, jq_scope *parent)
+{
+	guint64 bits = 0;
+	for (size_t c = 0; c < p->count; ++c)
+	{
+		if (p->lazy & CHAIN_BIT(c))
+			continue;
+
+		jq_chain const *chain = &p->chains[c];
+		size_t i = 0;
+		while (i < chain->count && check_filter(p, st, &chain->filters[i], n, bits, parent))
+			++i;
+		if (i == chain->count)
+			bits |= CHAIN_BIT(c);
+	}
+	return bits;
+}
+
+/* Find out, which chains may match below the container.
+ *
+ * child: chains, that may match a child of the container.
+ * deeper: chains, that may match a node below the children.
+ * deeper_free: chains, that may match a node below a child, which doesn't
+ *              match any chain.
+ * Only the structure of the document is taken into account, all the other
+ * selectors are supposed to match. So are the lazy chains, which aren't
+ * evaluated yet.
+ */
+static void program_reach(jq_program const *p, jq_scope const *x,
+                          guint64 *child, guint64 *deeper, guint64 *deeper_free)
+{
+	*child = *deeper = *deeper_free = 0;
+	for (size_t c = 0; c < p->count; ++c)
+	{
+		jq_chain const *chain = &p->chains[c];
+		bool ch = true, dp = true, df = true;
+		for (size_t i = 0; i < chain->count; ++i)
+		{
+			jq_filter const *f = &chain->filters[i];
+			switch (f->kind)
+			{
+			case JQF_KEY:
+				ch = ch && !x->is_array;
+				break;
+			case JQF_NTH_CHILD:
+				ch = ch && x->is_array;
+				break;
+			case JQF_ROOT:
+				ch = dp = df = false;
+				break;
+			case JQF_PARENT:
+				ch = ch && ((x->bits | p->lazy) & f->chains);
+				dp = dp && ((*child | *deeper) & f->chains);
+				df = df && (*deeper_free & f->chains);
+				break;
+			case JQF_ANCESTOR:
+				ch = ch && ((x->ancestors | p->lazy) & f->chains);
+				dp = dp && ((x->ancestors | p->lazy | *child | *deeper) & f->chains);
+				df = df && ((x->ancestors | p->lazy | *deeper_free) & f->chains);
+				break;
+			case JQF_OR:
+				ch = ch && (*child & f->chains);
+				dp = dp && (*deeper & f->chains);
+				df = df && (*deeper_free & f->chains);
+				break;
+			case JQF_TYPE:
+			case JQF_FUNC:
+			case JQF_HAS:
+				break;
+			}
+		}
+		if (ch) *child |= CHAIN_BIT(c);
+		if (dp) *deeper |= CHAIN_BIT(c);
+		if (df) *deeper_free |= CHAIN_BIT(c);
+	}
+}
+
+typedef enum
+{
+	JQ_VISIT_NONE,
+	JQ_VISIT_MEMBERS,
+	JQ_VISIT_ITEMS,
+	JQ_VISIT_LOOKUPS,   // Only the members or items selected by the filters
+} jq_visit;
+
+typedef struct
+{
+	jvalue_search_result node;
+	jq_scope scope;
+	jq_visit visit;
+	ssize_t position;        // Next item or lookup
+	jobject_iter iter;
+	GPtrArray *lookups;      // JQF_KEY or JQF_NTH_CHILD filters
+} jq_frame;
+
+struct jq_plan
+{
+	jq_program *program;
+	bool owns_program;       // The plan isn't a fork of another one
+	jq_state *state;
+	// Open containers. Frames are allocated once, and kept for the next
+	// evaluations, so that the search results can point to their parents.
+	GPtrArray *frames;
+	size_t depth;
+	jvalue_ref root;         // The root, which isn't visited yet
+
+	// ".key:val(value)" is looked up in an index of the root (see jindex.h)
+	jq_filter const *index_key;
+	jq_filter const *index_value;
+	bool indexed;            // The results are taken from the index
+	GArray *entries;         // Copy of JIndexEntry found by the index, or NULL
+	guint position;
+};
+
+// Find the filters of the query, which can be looked up in an index
+static void plan_find_index_filters(jq_plan *plan)
+{
+	jq_program const *p = plan->program;
+	if (p->count != 1 || p->chains[0].count != 2)
+		return;
+
+	for (size_t i = 0; i < 2; ++i)
+	{
+		jq_filter const *f = &p->chains[0].filters[i];
+		if (f->kind == JQF_KEY)
+			plan->index_key = f;
+		else if (f->kind == JQF_FUNC && f->func == selector_value &&
+		         !jis_object((jvalue_ref) f->ctxt) && !jis_array((jvalue_ref) f->ctxt))
+			plan->index_value = f;
+	}
+	if (!plan->index_key || !plan->index_value)
+		plan->index_key = plan->index_value = NULL;
+}
+
+static void frame_free(gpointer data)
+{
+	jq_frame *frame = (jq_frame *) data;
+	g_ptr_array_free(frame->lookups, TRUE);
+	g_free(frame);
+}
+
+jq_plan *jq_plan_new(jquery_ptr query)
+{
+	jq_program *program = jq_program_compile(query, JQ_PROGRAM_DOM);
+	if (!program)
+		return NULL;
+
+	jq_plan *plan = g_new0(jq_plan, 1);
+	plan->program = program;
+	plan->owns_program = true;
+	plan->state = jq_state_new(program);
+	plan->frames = g_ptr_array_new_with_free_func(frame_free);
+	plan_find_index_filters(plan);
+	return plan;
+}
+
+jq_plan *jq_plan_fork(jq_plan const *plan)
+{
+	jq_plan *fork = g_new0(jq_plan, 1);
+	fork->program = plan->program;
+	fork->state = jq_state_new(plan->program);
+	fork->frames = g_ptr_array_new_with_free_func(frame_free);
+	fork->index_key = plan->index_key;
+	fork->index_value = plan->index_value;
+	return fork;
+}
+
+jq_plan *jq_plan_copy(jq_plan const *plan)
+{
+	jq_plan *copy = jq_plan_fork(plan);
+	copy->root = plan->root;
+	copy->indexed = plan->indexed;
+	if (plan->entries)
+	{
+		copy->entries = g_array_sized_new(FALSE, FALSE, sizeof(JIndexEntry), plan->entries->len);
+		g_array_append_vals(copy->entries, plan->entries->data, plan->entries->len);
+	}
+	copy->position = plan->position;
+
+	// The search results point to the parents in the frames
+	for (size_t i = 0; i < plan->depth; ++i)
+	{
+		jq_frame const *frame = (jq_frame const *) g_ptr_array_index(plan->frames, i);
+		jq_frame *parent = i ? (jq_frame *) g_ptr_array_index(copy->frames, i - 1) : NULL;
+		jq_frame *f = g_new(jq_frame, 1);
+		*f = *frame;
+		f->node.parent = parent ? &parent->node : NULL;
+		f->scope.node = &f->node;
+		f->scope.parent = parent ? &parent->scope : NULL;
+		f->lookups = g_ptr_array_sized_new(frame->lookups->len);
+		for (guint j = 0; j < frame->lookups->len; ++j)
+			g_ptr_array_add(f->lookups, g_ptr_array_index(frame->lookups, j));
+		g_ptr_array_add(copy->frames, f);
+	}
+	copy->depth = plan->depth;
+	return copy;
+}
+
+void jq_plan_free(jq_plan *plan)
+{
+	if (!plan)
+		return;
+	jq_state_free(plan->state);
+	if (plan->entries)
+		g_array_free(plan->entries, TRUE);
+	if (plan->owns_program)
+		jq_program_free(plan->program);
+	g_ptr_array_free(plan->frames, TRUE);
+	g_free(plan);
+}
+
+void jq_plan_init(jq_plan *plan, jvalue_ref json)
+{
+	plan->depth = 0;
+	plan->root = json;
+	jq_state_reset(plan->state);
+	if (plan->entries)
+		g_array_free(plan->entries, TRUE);
+	plan->entries = NULL;
+
+	plan->indexed = plan->index_key &&
+	                jindex_lookup_entries(json, plan->index_key->key_str, (jvalue_ref) plan->index_value->ctxt,
+	                                      &plan->entries);
+	plan->position = 0;
+	if (plan->indexed)
+		plan->root = NULL;
+}
+
+static bool lookup_exists(GPtrArray *lookups, jq_filter const *f)
+{
+	for (guint i = 0; i < lookups->len; ++i)
+	{
+		jq_filter const *other = (jq_filter const *) g_ptr_array_index(lookups, i);
+		// Keys are interned, the same key is the same string value
+		if (f->kind == JQF_KEY ? other->key == f->key : other->index == f->index)
+			return true;
+	}
+	return false;
+}
+
+/* Decide, which children of the container should be visited.
+ * If no chain can match below a child, that doesn't match anything itself,
+ * and every chain, that may match a child, selects it by the key or index,
+ * only the children with those keys or indexes are visited.
+ */
+static void frame_plan_visit(jq_program const *p, jq_frame *frame)
+{
+	guint64 child, deeper, deeper_free;
+	program_reach(p, &frame->scope, &child, &deeper, &deeper_free);
+
+	if (!jq_program_matches(p, child | deeper))
+	{
+		frame->visit = JQ_VISIT_NONE;
+		return;
+	}
+
+	jq_visit all = frame->scope.is_array ? JQ_VISIT_ITEMS : JQ_VISIT_MEMBERS;
+	if (deeper_free)
+	{
+		frame->visit = all;
+		return;
+	}
+
+	g_ptr_array_set_size(frame->lookups, 0);
+	frame->visit = JQ_VISIT_LOOKUPS;
+	jq_filter_kind kind = frame->scope.is_array ? JQF_NTH_CHILD : JQF_KEY;
+	for (size_t c = 0; c < p->count; ++c)
+	{
+		if (!(child & CHAIN_BIT(c)))
+			continue;
+
+		jq_chain const *chain = &p->chains[c];
+		size_t i = 0;
+		while (i < chain->count && chain->filters[i].kind != kind)
+			++i;
+		if (i == chain->count)
+		{
+			frame->visit = all;
+			return;
+		}
+		if (!lookup_exists(frame->lookups, &chain->filters[i]))
+			g_ptr_array_add(frame->lookups, (gpointer) &chain->filters[i]);
+	}
+}
+
+static void plan_push_frame(jq_plan *plan, jvalue_search_result node, guint64 bits, jq_scope *parent)
+{
+	if (plan->depth == plan->frames->len)
+	{
+		jq_frame *frame = g_new0(jq_frame, 1);
+		frame->lookups = g_ptr_array_new();
+		g_ptr_array_add(plan->frames, frame);
+	}
+	jq_frame *frame = (jq_frame *) g_ptr_array_index(plan->frames, plan->depth++);
+
+	frame->node = node;
+	frame->scope.bits = bits;
+	frame->scope.ancestors = bits | (parent ? parent->ancestors : 0);
+	frame->scope.is_array = jis_array(node.value);
+	frame->scope.known = 0;
+	// The lazy chains matching an ancestor match the ancestors of the node too
+	frame->scope.ancestors_known = frame->scope.ancestors & plan->program->lazy;
+	frame->scope.node = &frame->node;
+	frame->scope.parent = parent;
+	frame->position = 0;
+	frame_plan_visit(plan->program, frame);
+	if (frame->visit == JQ_VISIT_MEMBERS)
+		jobject_iter_init(&frame->iter, node.value);
+}
+
+static bool frame_next_child(jq_frame *frame, jvalue_search_result *child)
+{
+	*child = (jvalue_search_result) { NULL, &frame->node, -1, NULL };
+
+	switch (frame->visit)
+	{
+	case JQ_VISIT_NONE:
+		return false;
+	case JQ_VISIT_MEMBERS:
+		{
+			jobject_key_value keyval;
+			if (!jobject_iter_next(&frame->iter, &keyval))
+				return false;
+			child->value = keyval.value;
+			child->value_key = keyval.key;
+			return true;
+		}
+	case JQ_VISIT_ITEMS:
+		if (frame->position >= jarray_size(frame->node.value))
+			return false;
+		child->value_index = frame->position++;
+		child->value = jarray_get(frame->node.value, child->value_index);
+		return true;
+	case JQ_VISIT_LOOKUPS:
+		while (frame->position < frame->lookups->len)
+		{
+			jq_filter const *f = (jq_filter const *) g_ptr_array_index(frame->lookups, frame->position++);
+			if (f->kind == JQF_NTH_CHILD)
+			{
+				if (f->index >= jarray_size(frame->node.value))
+					continue;
+				child->value_index = f->index;
+				child->value = jarray_get(frame->node.value, f->index);
+				return true;
+			}
+
+			// The key of the member itself is needed, it's compared by the
+			// pointer to find the siblings
+			GHashTable *members = jobject_deref(frame->node.value)->m_members;
+			gpointer key, value;
+			if (members && g_hash_table_lookup_extended(members, f->key, &key, &value))
+			{
+				child->value = (jvalue_ref) value;
+				child->value_key = (jvalue_ref) key;
+				return true;
+			}
+		}
+		return false;
+	}
+	return false;
+}
+
+jvalue_ref jq_plan_next(jq_plan *plan)
+{
+	if (plan->indexed)
+	{
+		if (!plan->entries || plan->position >= plan->entries->len)
+			return jinvalid();
+		return g_array_index(plan->entries, JIndexEntry, plan->position++).value;
+	}
+
+	while (true)
+	{
+		jq_frame *parent = plan->depth
+		                   ? (jq_frame *) g_ptr_array_index(plan->frames, plan->depth - 1)
+		                   : NULL;
+
+		jvalue_search_result node;
+		if (plan->root)
+		{
+			node = (jvalue_search_result) { plan->root, NULL, -1, NULL };
+			plan->root = NULL;
+		}
+		else if (!parent)
+		{
+			return jinvalid();
+		}
+		else if (!frame_next_child(parent, &node))
+		{
+			--plan->depth;
+			continue;
+		}
+
+		jq_node n = {
+			.key_value = node.value_key,
+			.index = node.value_index,
+			.type = node.value->m_type,
+			.result = &node,
+		};
+		if (node.value_key)
+			n.key = jstring_get_fast(node.value_key);
+
+		guint64 bits = jq_program_check(plan->program, plan->state, &n, parent ? &parent->scope : NULL);
+		if (jis_object(node.value) || jis_array(node.value))
+			plan_push_frame(plan, node, bits, parent ? &parent->scope : NULL);
+
+		if (jq_program_matches(plan->program, bits))
+			return node.value;
+	}
+}
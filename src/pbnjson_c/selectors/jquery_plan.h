@@ -0,0 +1,187 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __JQUERY_PLAN_H_
+#define __JQUERY_PLAN_H_
+
+#include <stdbool.h>
+
+#include <glib.h>
+
+#include "jquery_internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A compiled query is a chain of selectors, which are applied to the same node.
+ * Combinators are selectors too: they check nested queries against the parent
+ * or the ancestors of the node. Thus every node can be checked as soon as it
+ * is reached from the root, if the results of all the nested queries for its
+ * ancestors are known. Every query in the tree becomes a program chain, and
+ * the evaluator keeps a bit per chain for every open container.
+ */
+
+// Count of the chains in a program
+#define JQ_PROGRAM_MAX_CHAINS 64
+
+typedef enum
+{
+	JQF_KEY,
+	JQF_TYPE,
+	JQF_ROOT,
+	JQF_NTH_CHILD,
+	JQF_FUNC,       // Original selector function, needs the value of the node
+	JQF_HAS,
+	JQF_PARENT,
+	JQF_ANCESTOR,
+	JQF_OR,
+} jq_filter_kind;
+
+typedef struct jq_program jq_program;
+
+typedef struct
+{
+	jq_filter_kind kind;
+	jvalue_ref key;                  // JQF_KEY: interned key string
+	raw_buffer key_str;              // JQF_KEY: contents of the key
+	JValueType type;                 // JQF_TYPE
+	ssize_t index;                   // JQF_NTH_CHILD: zero based
+	selector_filter_function func;   // JQF_FUNC
+	void *ctxt;
+	guint64 chains;                  // JQF_PARENT, JQF_ANCESTOR, JQF_OR: nested chains
+	query_context_destructor ctxt_destructor;  // JQF_FUNC: owner of the context
+	jquery_ptr query;                // JQF_HAS: nested query
+	jq_program *nested;              // JQF_HAS: the nested query, if it depends on the node only
+	size_t slot;                     // JQF_HAS, JQF_FUNC with nested queries: state of the evaluation
+} jq_filter;
+
+typedef struct
+{
+	jq_filter *filters;
+	size_t count;
+	// Query, which can't be compiled. It's evaluated by the generators on
+	// demand, instead of the filters.
+	jquery_ptr query;
+	size_t slot;           // Copy of the query in the state of the evaluation
+} jq_chain;
+
+struct jq_program
+{
+	// Nested chains go before the chains, which refer to them.
+	// The last one is the query itself.
+	jq_chain chains[JQ_PROGRAM_MAX_CHAINS];
+	size_t count;
+	guint64 lazy;          // Chains with the query
+	bool needs_values;     // There're JQF_FUNC or JQF_HAS filters
+	size_t slots;          // Size of the state of the evaluation
+};
+
+typedef enum
+{
+	// Only the selectors, that can be decided by a scalar value without
+	// looking at the rest of the document
+	JQ_PROGRAM_STREAM,
+	// Any selectors, the rest of them is called with the search result
+	JQ_PROGRAM_DOM,
+} jq_program_mode;
+
+// What is known about a node, when it's reached
+typedef struct
+{
+	raw_buffer key;               // Key in the parent object, or { NULL, 0 }
+	jvalue_ref key_value;         // The same key as a string value, or NULL
+	ssize_t index;                // Index in the parent array, or -1
+	JValueType type;
+	jvalue_search_result *result; // The node for JQF_FUNC, or NULL if its value isn't known
+} jq_node;
+
+// What is known about an open container
+typedef struct jq_scope jq_scope;
+struct jq_scope
+{
+	guint64 bits;          // Chains matching the container
+	guint64 ancestors;     // Chains matching the container or its ancestors
+	bool is_array;
+
+	// The lazy chains are checked, when they're needed for the first time
+	guint64 known;             // Lazy chains checked for the container
+	guint64 ancestors_known;   // Lazy chains checked for the container and its ancestors
+	jvalue_search_result *node;
+	jq_scope *parent;
+};
+
+/* Compile the query returned by jquery_create().
+ * Returns NULL if the query can't be evaluated in the mode.
+ */
+jq_program *jq_program_compile(jquery_ptr query, jq_program_mode mode);
+void jq_program_free(jq_program *p);
+
+/* State of an evaluation of a program.
+ *
+ * The program isn't changed by the evaluation, so it may be shared by
+ * several evaluations. Each of them keeps the copies of the nested queries,
+ * which are evaluated by the generators, and the memoized results in a state.
+ * The programs compiled for JQ_PROGRAM_STREAM don't need any.
+ */
+typedef struct jq_state jq_state;
+
+jq_state *jq_state_new(jq_program const *p);
+void jq_state_free(jq_state *st);
+
+/* Forget the results memoized for the previous document */
+void jq_state_reset(jq_state *st);
+
+/* Find the chains matching the node.
+ * parent is NULL for the root node. The lazy chains aren't checked.
+ * st may be NULL for the programs compiled for JQ_PROGRAM_STREAM.
+ */
+guint64 jq_program_check(jq_program const *p, jq_state *st, jq_node const *n, jq_scope *parent);
+
+static inline bool jq_program_matches(jq_program const *p, guint64 bits)
+{
+	return (bits >> (p->count - 1)) & 1;
+}
+
+/* Evaluation of the query over a DOM.
+ *
+ * The DOM is walked once, and every node is checked once. Subtrees, where the
+ * query can't match, are skipped. Objects are searched by the keys from the
+ * query with a direct lookup, when no other member can lead to a match.
+ */
+typedef struct jq_plan jq_plan;
+
+/* Returns NULL if the query can't be planned */
+jq_plan *jq_plan_new(jquery_ptr query);
+
+/* Another evaluation of the same compiled query. It shares the program
+ * with the plan, so the plan must outlive it. Only the program of the plan
+ * is read, so the plan may be evaluated meanwhile.
+ */
+jq_plan *jq_plan_fork(jq_plan const *plan);
+
+/* Fork of the plan, which continues from the same position */
+jq_plan *jq_plan_copy(jq_plan const *plan);
+
+void jq_plan_free(jq_plan *plan);
+void jq_plan_init(jq_plan *plan, jvalue_ref json);
+jvalue_ref jq_plan_next(jq_plan *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __JQUERY_PLAN_H_
@@ -41,16 +41,21 @@ bool selector_key(jvalue_search_result *json, void *ctxt)
 {
 	assert(ctxt);
 
-	const char *key = (const char *) ctxt;
+	jvalue_ref key = (jvalue_ref) ctxt;
 
 	if (!jis_valid(json->value_key))
 		return false;
 
+	// Keys of the parsed documents are interned the same way
+	if (json->value_key == key)
+		return true;
+
 	raw_buffer test = jstring_get_fast(json->value_key);
-	if (strlen(key) != test.m_len)
+	raw_buffer expected = jstring_get_fast(key);
+	if (expected.m_len != test.m_len)
 		return false;
 
-	return memcmp(key, test.m_str, test.m_len) == 0;
+	return memcmp(expected.m_str, test.m_str, test.m_len) == 0;
 }
 
 bool selector_contains(jvalue_search_result *json, void *ctxt)
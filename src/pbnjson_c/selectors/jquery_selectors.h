@@ -60,7 +60,7 @@ bool selector_type(jvalue_search_result *json, void *ctxt);
 /*
  * .key
  * A node that is a child of an object, and is a property with given key
- * Context char*
+ * Context is jvalue_ref - the key string
  */
 bool selector_key(jvalue_search_result *json, void *ctxt);
 
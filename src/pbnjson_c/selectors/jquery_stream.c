@@ -0,0 +1,362 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "jquery_internal.h"
+#include "jquery_plan.h"
+
+#include "jparse_stream.h"
+
+#include "../jerror_internal.h"
+#include "../key_dictionary.h"
+#include "../liblog.h"
+
+// The query is compiled into a program (see jquery_plan.h), and every node
+// is checked as soon as it starts.
+
+typedef struct _StreamResult
+{
+	jvalue_ref value;
+	bool ready;            // The value has been parsed completely
+} StreamResult;
+
+typedef struct _StreamFrame
+{
+	jq_scope scope;
+	ssize_t next_index;
+	jvalue_ref value;      // Container being built, or NULL
+	StreamResult *result;  // Result waiting for the container end, or NULL
+} StreamFrame;
+
+struct jquery_stream
+{
+	jsaxparser_ref parser;
+	jquery_ptr query;
+	jq_program *program;      // NULL if the query is evaluated over the whole document
+	GArray *frames;           // Open containers
+	GString *key;             // Key of the next object member
+	GQueue results;
+	jvalue_ref document;      // Whole document, if there's no program
+};
+
+static StreamFrame *top_frame(jquery_stream_ref s)
+{
+	if (!s->frames->len)
+		return NULL;
+	return &g_array_index(s->frames, StreamFrame, s->frames->len - 1);
+}
+
+static StreamResult *add_result(jquery_stream_ref s, jvalue_ref value, bool ready)
+{
+	StreamResult *r = g_slice_new(StreamResult);
+	r->value = value;
+	r->ready = ready;
+	g_queue_push_tail(&s->results, r);
+	return r;
+}
+
+/* Handle the start of a node.
+ *
+ * The value of a scalar node is passed ready, or is made of the raw text by
+ * make_scalar() only if needed. Containers are pushed to the frame stack.
+ */
+static bool start_node(jquery_stream_ref s, JValueType type,
+                       jvalue_ref (*make_scalar)(const char *, size_t), const char *str, size_t len)
+{
+	StreamFrame *parent = top_frame(s);
+	bool is_container = type == JV_OBJECT || type == JV_ARRAY;
+
+	jq_node n = {
+		.key = { NULL, 0 },
+		.key_value = NULL,
+		.index = -1,
+		.type = type,
+		.result = NULL,
+	};
+	if (parent && parent->scope.is_array)
+	{
+		n.index = parent->next_index++;
+	}
+	else if (parent)
+	{
+		n.key = j_str_to_buffer(s->key->str, s->key->len);
+	}
+
+	// The selectors, which need the value, are called with the scalar alone
+	jvalue_ref scalar = NULL;
+	jvalue_search_result scalar_result = { NULL, NULL, n.index, NULL };
+	bool building = !s->program || (parent && parent->value);
+	if (!is_container && (building || s->program->needs_values))
+	{
+		scalar = make_scalar(str, len);
+		scalar_result.value = scalar;
+		n.result = &scalar_result;
+	}
+
+	guint64 bits = 0;
+	bool matched = false;
+	if (s->program)
+	{
+		bits = jq_program_check(s->program, NULL, &n, parent ? &parent->scope : NULL);
+		matched = jq_program_matches(s->program, bits);
+	}
+
+	// Values are built for the matches and everything inside them
+	jvalue_ref value = NULL;
+	if (matched || building)
+	{
+		if (type == JV_OBJECT)
+			value = jobject_create();
+		else if (type == JV_ARRAY)
+			value = jarray_create(NULL);
+		else if (scalar)
+			value = jvalue_copy(scalar);
+		else
+			value = make_scalar(str, len);
+		if (UNLIKELY(!value))
+		{
+			j_release(&scalar);
+			return false;
+		}
+	}
+	j_release(&scalar);
+
+	StreamResult *result = NULL;
+	if (matched)
+		result = add_result(s, jvalue_copy(value), !is_container);
+
+	if (value)
+	{
+		if (parent && parent->value)
+		{
+			if (parent->scope.is_array)
+				jarray_append(parent->value, value);
+			else
+				jobject_put(parent->value, keyDictionaryLookup(n.key.m_str, n.key.m_len), value);
+		}
+		else if (!s->program)
+		{
+			s->document = value;
+		}
+		else
+		{
+			// The result holds the value
+			j_release(&value);
+		}
+	}
+
+	if (is_container)
+	{
+		StreamFrame frame = {
+			.scope = {
+				.bits = bits,
+				.ancestors = bits | (parent ? parent->scope.ancestors : 0),
+				.is_array = type == JV_ARRAY,
+			},
+			.next_index = 0,
+			.value = value,
+			.result = result,
+		};
+		g_array_append_val(s->frames, frame);
+	}
+	return true;
+}
+
+static bool end_container(jquery_stream_ref s)
+{
+	StreamFrame *frame = top_frame(s);
+	if (!frame)
+		return false;
+	if (frame->result)
+		frame->result->ready = true;
+	g_array_set_size(s->frames, s->frames->len - 1);
+	return true;
+}
+
+static jvalue_ref make_string(const char *str, size_t len)
+{
+	return jstring_create_copy(j_str_to_buffer(str, len));
+}
+
+static jvalue_ref make_number(const char *str, size_t len)
+{
+	return jnumber_create(j_str_to_buffer(str, len));
+}
+
+static jvalue_ref make_true(const char *str, size_t len)
+{
+	return jboolean_create(true);
+}
+
+static jvalue_ref make_false(const char *str, size_t len)
+{
+	return jboolean_create(false);
+}
+
+static jvalue_ref make_null(const char *str, size_t len)
+{
+	return jnull();
+}
+
+static int stream_object_start(JSAXContextRef ctxt)
+{
+	return start_node((jquery_stream_ref) jsax_getContext(ctxt), JV_OBJECT, NULL, NULL, 0);
+}
+
+static int stream_object_key(JSAXContextRef ctxt, const char *key, size_t keyLen)
+{
+	jquery_stream_ref s = (jquery_stream_ref) jsax_getContext(ctxt);
+	g_string_truncate(s->key, 0);
+	g_string_append_len(s->key, key, keyLen);
+	return 1;
+}
+
+static int stream_object_end(JSAXContextRef ctxt)
+{
+	return end_container((jquery_stream_ref) jsax_getContext(ctxt));
+}
+
+static int stream_array_start(JSAXContextRef ctxt)
+{
+	return start_node((jquery_stream_ref) jsax_getContext(ctxt), JV_ARRAY, NULL, NULL, 0);
+}
+
+static int stream_array_end(JSAXContextRef ctxt)
+{
+	return end_container((jquery_stream_ref) jsax_getContext(ctxt));
+}
+
+static int stream_string(JSAXContextRef ctxt, const char *string, size_t stringLen)
+{
+	return start_node((jquery_stream_ref) jsax_getContext(ctxt), JV_STR, make_string, string, stringLen);
+}
+
+static int stream_number(JSAXContextRef ctxt, const char *number, size_t numberLen)
+{
+	return start_node((jquery_stream_ref) jsax_getContext(ctxt), JV_NUM, make_number, number, numberLen);
+}
+
+static int stream_boolean(JSAXContextRef ctxt, bool value)
+{
+	return start_node((jquery_stream_ref) jsax_getContext(ctxt), JV_BOOL,
+	                  value ? make_true : make_false, NULL, 0);
+}
+
+static int stream_null(JSAXContextRef ctxt)
+{
+	return start_node((jquery_stream_ref) jsax_getContext(ctxt), JV_NULL, make_null, NULL, 0);
+}
+
+static PJSAXCallbacks stream_callbacks = {
+	stream_object_start,
+	stream_object_key,
+	stream_object_end,
+	stream_array_start,
+	stream_array_end,
+	stream_string,
+	stream_number,
+	stream_boolean,
+	stream_null
+};
+
+jquery_stream_ref jquery_stream_new(jquery_ptr query, const jschema_ref schema, jerror **err)
+{
+	CHECK_POINTER_SET_ERROR_RETURN_NULL(query, err);
+	CHECK_POINTER_SET_ERROR_RETURN_NULL(schema, err);
+
+	jquery_stream_ref s = g_new0(struct jquery_stream, 1);
+	s->parser = jsaxparser_new(schema, &stream_callbacks, s);
+	if (!s->parser)
+	{
+		jerror_set(err, JERROR_TYPE_INTERNAL, "Failed to create parser");
+		g_free(s);
+		return NULL;
+	}
+
+	s->query = query;
+	s->program = jq_program_compile(query, JQ_PROGRAM_STREAM);
+	s->frames = g_array_new(FALSE, FALSE, sizeof(StreamFrame));
+	s->key = g_string_new(NULL);
+	g_queue_init(&s->results);
+	return s;
+}
+
+bool jquery_stream_feed(jquery_stream_ref stream, const char *buf, int buf_len)
+{
+	CHECK_POINTER_RETURN_VALUE(stream, false);
+	return jsaxparser_feed(stream->parser, buf, buf_len);
+}
+
+bool jquery_stream_end(jquery_stream_ref stream)
+{
+	CHECK_POINTER_RETURN_VALUE(stream, false);
+	if (!jsaxparser_end(stream->parser))
+		return false;
+
+	if (!stream->program && stream->document)
+	{
+		jquery_init(stream->query, stream->document, NULL);
+		jvalue_ref value;
+		while (jis_valid(value = jquery_next(stream->query)))
+			add_result(stream, jvalue_copy(value), true);
+		j_release(&stream->document);
+	}
+	return true;
+}
+
+jvalue_ref jquery_stream_next(jquery_stream_ref stream)
+{
+	CHECK_POINTER_RETURN_VALUE(stream, jinvalid());
+
+	StreamResult *r = (StreamResult *) g_queue_peek_head(&stream->results);
+	if (!r || !r->ready)
+		return jinvalid();
+
+	g_queue_pop_head(&stream->results);
+	jvalue_ref value = r->value;
+	g_slice_free(StreamResult, r);
+	return value;
+}
+
+const char *jquery_stream_get_error(jquery_stream_ref stream)
+{
+	CHECK_POINTER_RETURN_NULL(stream);
+	return jsaxparser_get_error(stream->parser);
+}
+
+static void stream_result_free(gpointer data)
+{
+	StreamResult *r = (StreamResult *) data;
+	j_release(&r->value);
+	g_slice_free(StreamResult, r);
+}
+
+void jquery_stream_release(jquery_stream_ref *stream)
+{
+	CHECK_POINTER(stream);
+	jquery_stream_ref s = *stream;
+	if (!s)
+		return;
+
+	jsaxparser_release(&s->parser);
+	jq_program_free(s->program);
+	g_array_free(s->frames, TRUE);
+	g_string_free(s->key, TRUE);
+	g_queue_foreach(&s->results, (GFunc) stream_result_free, NULL);
+	g_queue_clear(&s->results);
+	j_release(&s->document);
+	g_free(s);
+	*stream = NULL;
+}
@@ -33,11 +33,13 @@
 %include {
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <glib.h>
 
 #include "../jerror_internal.h"
 #include "../jobject_internal.h"
+#include "../key_dictionary.h"
 #include "../jvalue/num_conversion.h"
 #include "jquery_internal.h"
 #include "expression.h"
@@ -190,8 +192,12 @@ key(A) ::= COLON pseudo(B).
 %destructor class { jquery_free($$.deepest_query); }
 class(A) ::= DOT json_string(B).
 {
-    A = (jquery_pair){ .root_query = jquery_new(selector_key, B, g_free, JQG_TYPE_SELF) };
+    A = (jquery_pair){ .root_query = jquery_new(selector_key,
+                                                keyDictionaryLookup(B, strlen(B)),
+                                                (query_context_destructor) j_release_helper,
+                                                JQG_TYPE_SELF) };
     A.deepest_query = A.root_query;
+    g_free(B);
 }
 class(A) ::= ASTERISK.
 {
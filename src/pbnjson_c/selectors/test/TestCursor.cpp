@@ -0,0 +1,97 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "Utils.hpp"
+
+namespace {
+
+using namespace std;
+using namespace pbnjson;
+
+vector<string> take(jquery_cursor_ref cursor)
+{
+	vector<string> result;
+	jvalue_ref v;
+	while (jis_valid(v = jquery_cursor_next(cursor)))
+		result.push_back(JValue(jvalue_copy(v)).stringify());
+	return result;
+}
+
+TEST(Selectors, TestCursorsAreIndependent)
+{
+	JValue json = JDomParser::fromString(R"({"a": [{"id": 1}, {"id": 2, "b": {"id": 3}}]})");
+	jerror *err = NULL;
+	jquery_ptr query = jquery_create(":has(.b) .id, :root > .a > :first-child > .id", &err);
+	ASSERT_TRUE(query != NULL);
+
+	jquery_cursor_ref first = jquery_cursor_new(query, json.peekRaw(), &err);
+	jquery_cursor_ref second = jquery_cursor_new(query, json.peekRaw(), &err);
+	ASSERT_TRUE(first != NULL);
+	ASSERT_TRUE(second != NULL);
+
+	// Evaluation of the query itself doesn't move the cursors
+	ASSERT_TRUE(jquery_init(query, json.peekRaw(), &err));
+	ASSERT_TRUE(jis_valid(jquery_next(query)));
+
+	ASSERT_TRUE(jis_valid(jquery_cursor_next(first)));
+	auto rest = take(first);
+	auto all = take(second);
+	ASSERT_EQ(all.size(), rest.size() + 1);
+	EXPECT_EQ(vector<string>(all.begin() + 1, all.end()), rest);
+
+	jquery_cursor_release(&first);
+	jquery_cursor_release(&second);
+	EXPECT_TRUE(first == NULL);
+	jquery_free(query);
+}
+
+TEST(Selectors, TestCursorCopy)
+{
+	jerror *err = NULL;
+	jquery_ptr query = jquery_create("number", &err);
+	ASSERT_TRUE(query != NULL);
+
+	// The cursor holds the JSON
+	jvalue_ref json = jdom_create(j_cstr_to_buffer("[1, [2]]"), jschema_all(), &err);
+	jquery_cursor_ref cursor = jquery_cursor_new(query, json, &err);
+	j_release(&json);
+
+	EXPECT_EQ(JValue(1), JValue(jvalue_copy(jquery_cursor_next(cursor))));
+	jquery_cursor_ref copy = jquery_cursor_copy(cursor);
+	EXPECT_EQ(JValue(2), JValue(jvalue_copy(jquery_cursor_next(copy))));
+	EXPECT_FALSE(jis_valid(jquery_cursor_next(copy)));
+
+	// The copy doesn't move the cursor
+	jquery_cursor_release(&copy);
+	EXPECT_EQ(JValue(2), JValue(jvalue_copy(jquery_cursor_next(cursor))));
+	EXPECT_FALSE(jis_valid(jquery_cursor_next(cursor)));
+	jquery_cursor_release(&cursor);
+	jquery_free(query);
+}
+
+TEST(Selectors, TestCursorInvalidParameters)
+{
+	jerror *err = NULL;
+	EXPECT_TRUE(jquery_cursor_new(NULL, jnull(), &err) == NULL);
+	EXPECT_TRUE(err != NULL);
+	jerror_free(err);
+}
+
+} // namespace
@@ -0,0 +1,179 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <string>
+#include <algorithm>
+
+#include "Utils.hpp"
+
+namespace {
+
+using namespace std;
+using namespace pbnjson;
+
+static jvalue_ref json = []()
+{
+	jerror *err = NULL;
+	jvalue_ref json = jdom_create(j_cstr_to_buffer(R"({"state": {"devices": [)"
+	                                               R"({"id": 1, "on": true, "tags": ["a"]},)"
+	                                               R"({"id": 2, "on": false, "tags": []},)"
+	                                               R"({"id": 3, "on": null, "state": {"id": 4}}],)"
+	                                               R"("id": 5}, "id": 6})"),
+	                             jschema_all(),
+	                             &err);
+
+	return json;
+}();
+
+// Results in the order of the document
+vector<string> ordered_results(const char *query_str, jvalue_ref json)
+{
+	jerror *err = NULL;
+	vector<string> result;
+	for (auto &v : getAllQueryResults(query_str, json, &err))
+		result.push_back(v.stringify());
+	return result;
+}
+
+// Results in any order: members of objects aren't ordered
+vector<string> results(const char *query_str, jvalue_ref json)
+{
+	vector<string> result = ordered_results(query_str, json);
+	sort(result.begin(), result.end());
+	return result;
+}
+
+TEST(Selectors, TestPlanDirectLookup)
+{
+	EXPECT_EQ(vector<string>({ "5" }), results(":root > .state > .id", json));
+	EXPECT_EQ(vector<string>({ "6" }), results(":root > .id", json));
+	EXPECT_EQ(vector<string>({ "2" }), results(":root > .state > .devices > :nth-child(2) > .id", json));
+	EXPECT_EQ(vector<string>({ "4" }), results(":root > .state > .devices > * > .state > .id", json));
+	EXPECT_EQ(vector<string>({ "1", "2", "3", "4" }), results(":root > .state > .devices .id", json));
+	EXPECT_EQ(vector<string>({ "5", "6" }), results(":root > .id, :root > .state > .id", json));
+
+	EXPECT_TRUE(results(":root > .missing", json).empty());
+	EXPECT_TRUE(results(":root > .missing .id", json).empty());
+	EXPECT_TRUE(results(":root > .state > .devices > :nth-child(4)", json).empty());
+	EXPECT_TRUE(results(":root > .id > .id", json).empty());
+}
+
+TEST(Selectors, TestPlanDocumentOrder)
+{
+	JValue doc = JDomParser::fromString(R"([{"id": 1}, [{"id": 2}, {"id": 3}], {"id": 4}])");
+
+	EXPECT_EQ(vector<string>({ "1", "2", "3", "4" }), ordered_results(".id", doc.peekRaw()));
+	EXPECT_EQ(vector<string>({ "1", "4" }), ordered_results(":root > * > .id", doc.peekRaw()));
+	EXPECT_EQ(vector<string>({ "1", "4" }), ordered_results(".id:val(4), .id:val(1)", doc.peekRaw()));
+	EXPECT_EQ(vector<string>({ "1", "2", "3" }),
+	          ordered_results(":root > .state > .devices > * > .id", json));
+}
+
+TEST(Selectors, TestPlanNoDuplicates)
+{
+	// Every node is reported once, even if it has several matching ancestors
+	EXPECT_EQ(vector<string>({ "1", "2", "3", "4", "5" }), results(".state .id", json));
+	EXPECT_EQ(vector<string>({ "1", "2", "3", "4", "5" }), results("object object .id", json));
+	EXPECT_EQ(vector<string>({ "1", "2", "3", "4", "5", "6" }), results(".id, :root > .id", json));
+}
+
+TEST(Selectors, TestPlanSelectorsNeedingParent)
+{
+	// Members found by the key still know their siblings and parents
+	EXPECT_EQ(vector<string>({ "[\"a\"]" }), results(":root > .state > .devices > * > .id ~ .tags:has(string)", json));
+	EXPECT_EQ(vector<string>({ "[]" }), results(":root > .state > .devices > * > .tags:empty", json));
+	EXPECT_EQ(vector<string>({ "null" }), results(":root > .state > .devices > :last-child > .on", json));
+	EXPECT_EQ(vector<string>({ "3" }), results(":root > .state > .devices > :has(.state) > .id", json));
+}
+
+TEST(Selectors, TestPlanNotParsedDocument)
+{
+	// Keys of the document aren't interned
+	JValue a = Object();
+	a.put("b", 1);
+	JValue doc = Object();
+	doc.put("a", a);
+	doc.put("b", 2);
+
+	EXPECT_EQ(vector<string>({ "1" }), results(":root > .a > .b", doc.peekRaw()));
+	EXPECT_EQ(vector<string>({ "1", "2" }), results(".b", doc.peekRaw()));
+}
+
+TEST(Selectors, TestPlanHas)
+{
+	EXPECT_EQ(vector<string>({ R"({"id":4})" }), results(":has(:root > .id:val(4))", json));
+	EXPECT_EQ(vector<string>({ "1", "2", "5", "6" }), results(":has(.tags) > .id", json));
+	EXPECT_EQ(vector<string>({ "3", "5", "6" }), results(":has(:has(.state)) > .id", json));
+	EXPECT_TRUE(results(":has(.missing)", json).empty());
+
+	// Nested queries, which look at the parents
+	EXPECT_EQ(vector<string>({ "1", "5", "6" }), results(":has(.id ~ .tags > string) > .id", json));
+	EXPECT_EQ(vector<string>({ "3", "4", "5", "6" }), results(":has(object > .id:val(4)) > .id", json));
+}
+
+TEST(Selectors, TestPlanHasAnotherDocument)
+{
+	// Results for the nodes of one document aren't reused for the next one
+	jerror *err = NULL;
+	jquery_ptr query = jquery_create(":has(.on:val(true)) > .id", &err);
+	ASSERT_TRUE(query != NULL);
+
+	for (int i = 0; i < 3; ++i)
+	{
+		JValue doc = JDomParser::fromString(i % 2 ? R"({"a": {"on": true, "id": 1}})"
+		                                          : R"({"a": {"on": false, "id": 1}})");
+		ASSERT_TRUE(jquery_init(query, doc.peekRaw(), &err));
+		EXPECT_EQ(i % 2 == 1, jis_valid(jquery_next(query)));
+	}
+
+	jquery_free(query);
+}
+
+TEST(Selectors, TestPlanNestedQueryNotCompiled)
+{
+	// The expression is checked against the parent and its descendants
+	EXPECT_EQ(vector<string>({ "3", "4", "5", "6" }), results(":expr(x = 4) > .id", json));
+	EXPECT_EQ(vector<string>({ "1", "2", "3", "4", "5" }), results(":expr(x = 4) object > .id", json));
+}
+
+TEST(Selectors, TestPlanReuse)
+{
+	jerror *err = NULL;
+	jquery_ptr query = jquery_create(":root > .state > .devices > * > .id", &err);
+	ASSERT_TRUE(query != NULL);
+
+	for (int i = 0; i < 2; ++i)
+	{
+		ASSERT_TRUE(jquery_init(query, json, &err));
+		size_t count = 0;
+		while (jis_valid(jquery_next(query)))
+			++count;
+		EXPECT_EQ(3u, count);
+	}
+
+	// Initialization in the middle of the walk starts it over
+	ASSERT_TRUE(jquery_init(query, json, &err));
+	ASSERT_TRUE(jis_valid(jquery_next(query)));
+	JValue other = JDomParser::fromString(R"({"state": {"devices": [{"id": 7}]}})");
+	ASSERT_TRUE(jquery_init(query, other.peekRaw(), &err));
+	EXPECT_EQ(JValue(7), JValue(jvalue_copy(jquery_next(query))));
+	EXPECT_FALSE(jis_valid(jquery_next(query)));
+
+	jquery_free(query);
+}
+
+} // namespace
@@ -0,0 +1,196 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <string>
+#include <algorithm>
+#include <cstring>
+
+#include "Utils.hpp"
+
+namespace {
+
+using namespace std;
+using namespace pbnjson;
+
+const char *input = R"({"name": "hub", "devices": [)"
+                    R"({"id": 1, "kind": "lamp", "on": true, "tags": ["a", "b"]},)"
+                    R"({"id": 2, "kind": "plug", "on": false, "tags": []},)"
+                    R"({"id": 3, "kind": "lamp", "on": null, "info": {"id": "x"}}],)"
+                    R"("id": 0})";
+
+vector<string> sorted(vector<string> v)
+{
+	sort(v.begin(), v.end());
+	return v;
+}
+
+// Values selected by the DOM evaluation of the query, order of them follows the hash of keys
+vector<string> domResults(const char *query_str)
+{
+	jerror *err = NULL;
+	JValue json = jdom_create(j_cstr_to_buffer(input), jschema_all(), &err);
+	vector<string> result;
+	for (auto &v : getAllQueryResults(query_str, json.peekRaw(), &err))
+		result.push_back(v.stringify());
+	return sorted(result);
+}
+
+// Values selected by the stream, the input is fed by chunks of the given size
+vector<string> streamResults(const char *query_str, size_t chunk, bool sort_results = true)
+{
+	jerror *err = NULL;
+	jquery_ptr query = jquery_create(query_str, &err);
+	EXPECT_TRUE(query != NULL) << getErrorString(err);
+
+	jquery_stream_ref stream = jquery_stream_new(query, jschema_all(), &err);
+	EXPECT_TRUE(stream != NULL);
+
+	vector<string> result;
+	auto take = [&]()
+	{
+		jvalue_ref v;
+		while (jis_valid(v = jquery_stream_next(stream)))
+		{
+			result.push_back(JValue(v).stringify());
+		}
+	};
+
+	string text(input);
+	for (size_t i = 0; i < text.size(); i += chunk)
+	{
+		EXPECT_TRUE(jquery_stream_feed(stream, text.data() + i, min(chunk, text.size() - i)));
+		take();
+	}
+	EXPECT_TRUE(jquery_stream_end(stream));
+	take();
+
+	jquery_stream_release(&stream);
+	EXPECT_TRUE(stream == NULL);
+	jquery_free(query);
+	return sort_results ? sorted(result) : result;
+}
+
+TEST(Selectors, TestStreamMatchesDom)
+{
+	const char *queries[] = {
+		"*",
+		".id",
+		".devices .id",
+		"object > .id",
+		".devices > object",
+		".tags > string",
+		".kind, .on",
+		":root",
+		":first-child",
+		":nth-child(2)",
+		"boolean, null",
+		":contains(\"am\")",
+		":val(\"lamp\")",
+		"object .info > .id",
+	};
+
+	for (auto query : queries)
+	{
+		SCOPED_TRACE(query);
+		auto expected = domResults(query);
+		EXPECT_EQ(expected, streamResults(query, 1));
+		EXPECT_EQ(expected, streamResults(query, 7));
+		EXPECT_EQ(expected, streamResults(query, 1024));
+	}
+}
+
+TEST(Selectors, TestStreamDocumentOrder)
+{
+	vector<string> expected = { "1", "2", "3", "\"x\"" };
+	ASSERT_EQ(expected, streamResults(".devices .id", 5, false));
+
+	// Containers come before their own matched descendants
+	expected = { R"({"id":"x"})", R"("x")" };
+	ASSERT_EQ(expected, streamResults(".info, .info > .id", 5, false));
+}
+
+TEST(Selectors, TestStreamFallback)
+{
+	const char *queries[] = {
+		":has(.info)",
+		".kind ~ .on",
+		":last-child",
+		":empty",
+		":val([])",
+		":expr(x > 1)",
+	};
+
+	for (auto query : queries)
+	{
+		SCOPED_TRACE(query);
+		auto expected = domResults(query);
+		EXPECT_EQ(expected, streamResults(query, 3));
+	}
+}
+
+TEST(Selectors, TestStreamReadyValues)
+{
+	jerror *err = NULL;
+	jquery_ptr query = jquery_create(".id", &err);
+	ASSERT_TRUE(query != NULL);
+
+	jquery_stream_ref stream = jquery_stream_new(query, jschema_all(), &err);
+	ASSERT_TRUE(stream != NULL);
+
+	const char *part = R"({"a": [{"id": 5}, {"id": {"x": )";
+	ASSERT_TRUE(jquery_stream_feed(stream, part, strlen(part)));
+
+	// The first value is complete, the second one isn't
+	JValue v = jquery_stream_next(stream);
+	EXPECT_EQ(JValue(5), v);
+	EXPECT_FALSE(jis_valid(jquery_stream_next(stream)));
+
+	part = R"(1}}]})";
+	ASSERT_TRUE(jquery_stream_feed(stream, part, strlen(part)));
+	ASSERT_TRUE(jquery_stream_end(stream));
+
+	v = jquery_stream_next(stream);
+	EXPECT_EQ("{\"x\":1}", v.stringify());
+	EXPECT_FALSE(jis_valid(jquery_stream_next(stream)));
+
+	jquery_stream_release(&stream);
+	jquery_free(query);
+}
+
+TEST(Selectors, TestStreamInvalidInput)
+{
+	jerror *err = NULL;
+	jquery_ptr query = jquery_create(".id", &err);
+	ASSERT_TRUE(query != NULL);
+
+	jquery_stream_ref stream = jquery_stream_new(query, jschema_all(), &err);
+	ASSERT_TRUE(stream != NULL);
+
+	const char *part = R"({"id": 1, "id2": ])";
+	EXPECT_FALSE(jquery_stream_feed(stream, part, strlen(part)));
+	EXPECT_TRUE(jquery_stream_get_error(stream) != NULL);
+
+	// Nothing leaks with the values left in the stream
+	jquery_stream_release(&stream);
+	jquery_free(query);
+
+	EXPECT_TRUE(jquery_stream_new(NULL, jschema_all(), &err) == NULL);
+	EXPECT_TRUE(err != NULL);
+	jerror_free(err);
+}
+
+} // namespace
@@ -20,6 +20,8 @@
 #include "generic_validator.h"
 #include "array_items.h"
 #include "validation_api.h"
+#include "schema_blob.h"
+#include "serialization_plan.h"
 #include <jobject.h>
 #include <glib.h>
 #include <string.h>
@@ -117,6 +119,11 @@ static bool check(Validator *v, ValidationEvent const *e, ValidationState *s, vo
 	return false;
 }
 
+static bool may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	return e->type == EV_ARR_START;
+}
+
 static bool check_generic(Validator *v, ValidationEvent const *e, ValidationState *s, void *ctxt)
 {
 	// depth is used to track when current and all nested arrays are closed
@@ -178,14 +185,14 @@ static void _cleanup_state(Validator *v, ValidationState *s)
 static Validator* ref(Validator *validator)
 {
 	ArrayValidator *v = (ArrayValidator *) validator;
-	++v->ref_count;
+	g_atomic_int_inc(&v->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	ArrayValidator *v = (ArrayValidator *) validator;
-	if (--v->ref_count)
+	if (!g_atomic_int_dec_and_test(&v->ref_count))
 		return;
 	array_validator_release(v);
 }
@@ -321,9 +328,51 @@ static bool equals(Validator *v, Validator *other)
 	return false;
 }
 
+static bool serialize(Validator *v, BlobWriter *w)
+{
+	ArrayValidator *a = (ArrayValidator *) v;
+	blob_write_tag(w, BLOB_ARRAY);
+	blob_write_bool(w, a->items);
+	if (a->items)
+	{
+		blob_write_validator(w, a->items->generic_validator);
+		blob_write_int(w, a->items->validator_count);
+		for (GList *it = a->items->validators; it; it = g_list_next(it))
+			blob_write_validator(w, it->data);
+	}
+	blob_write_validator(w, a->additional_items);
+	blob_write_int(w, a->max_items);
+	blob_write_int(w, a->min_items);
+	blob_write_bool(w, a->unique_items);
+	blob_write_jvalue(w, a->def_value);
+	return true;
+}
+
+static bool serialize_generic(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_ARRAY_GENERIC);
+	return true;
+}
+
+static PlanNode* compile_plan(Validator *v, PlanBuilder *b)
+{
+	ArrayValidator *a = (ArrayValidator *) v;
+	PlanNode *n = plan_node_new(b, v, PLAN_ARRAY);
+	// Only {"items": {...}} describes every item the same way
+	if (a->items && a->items->validator_count == 0)
+		n->items = plan_compile(b, a->items->generic_validator);
+	return n;
+}
+
+static PlanNode* compile_plan_generic(Validator *v, PlanBuilder *b)
+{
+	return plan_node_new(b, v, PLAN_ARRAY);
+}
+
 static ValidatorVtable generic_array_vtable =
 {
 	.check = check_generic,
+	.may_accept = may_accept,
 	.init_state = init_state_generic,
 	.cleanup_state = cleanup_state_generic,
 	.set_array_items = set_items_generic,
@@ -334,11 +383,14 @@ static ValidatorVtable generic_array_vtable =
 	.set_default = set_default_generic,
 	.dump_enter = dump_enter,
 	.dump_exit = dump_exit,
+	.serialize = serialize_generic,
+	.compile_plan = compile_plan_generic,
 };
 
 ValidatorVtable array_vtable =
 {
 	.check = check,
+	.may_accept = may_accept,
 	.equals = equals,
 	.init_state = _init_state,
 	.cleanup_state = _cleanup_state,
@@ -354,6 +406,8 @@ ValidatorVtable array_vtable =
 	.get_default = get_default,
 	.dump_enter = dump_enter,
 	.dump_exit = dump_exit,
+	.serialize = serialize,
+	.compile_plan = compile_plan,
 };
 
 ArrayValidator* array_validator_new(void)
@@ -394,6 +448,33 @@ void array_validator_set_min_items(ArrayValidator *a, size_t min)
 	a->min_items = min;
 }
 
+Validator* array_validator_load(BlobReader *r)
+{
+	ArrayValidator *a = array_validator_new();
+	if (blob_read_bool(r))
+	{
+		a->items = array_items_new();
+		Validator *generic = blob_read_validator(r);
+		if (generic)
+			array_items_set_generic_item(a->items, generic);
+		int count = blob_read_int(r);
+		for (int i = 0; i < count && blob_reader_ok(r); ++i)
+		{
+			Validator *item = blob_read_validator(r);
+			if (item)
+				array_items_add_item(a->items, item);
+			else
+				blob_reader_fail(r);
+		}
+	}
+	validator_unref(a->additional_items);
+	a->additional_items = blob_read_validator(r);
+	a->max_items = blob_read_int(r);
+	a->min_items = blob_read_int(r);
+	a->unique_items = blob_read_bool(r);
+	return &a->base;
+}
+
 static Validator ARRAY_VALIDATOR_IMPL =
 {
 	.vtable = &generic_array_vtable,
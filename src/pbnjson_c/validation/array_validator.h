@@ -24,6 +24,8 @@
 extern "C" {
 #endif
 
+typedef struct _BlobReader BlobReader;
+
 typedef struct _ArrayItems ArrayItems;
 
 /**
@@ -35,7 +37,7 @@ typedef struct _ArrayValidator
 	Validator base;
 
 	/** @brief Reference count */
-	unsigned ref_count;
+	int ref_count;
 
 	/** @brief Items of the array from "items": [...]. */
 	ArrayItems *items;
@@ -70,6 +72,9 @@ ArrayValidator* array_validator_new();
 /** @brief Destroy the array validator. */
 void array_validator_release(ArrayValidator *v);
 
+/** @brief Restore the validator from a precompiled schema, see schema_blob.h */
+Validator* array_validator_load(BlobReader *r);
+
 /** @brief Set maximal item count in the array. */
 void array_validator_set_max_items(ArrayValidator *a, size_t max);
 
@@ -17,19 +17,22 @@
 #include "boolean_validator.h"
 #include "validation_event.h"
 #include "validation_state.h"
+#include "schema_blob.h"
+#include "serialization_plan.h"
 #include <jobject.h>
+#include <glib.h>
 
 static Validator* ref(Validator *validator)
 {
 	BooleanValidator *v = (BooleanValidator *) validator;
-	++v->ref_count;
+	g_atomic_int_inc(&v->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	BooleanValidator *v = (BooleanValidator *) validator;
-	if (--v->ref_count)
+	if (!g_atomic_int_dec_and_test(&v->ref_count))
 		return;
 	j_release(&v->def_value);
 	g_free(v);
@@ -70,6 +73,33 @@ static bool check_false(Validator *v, ValidationEvent const *e, ValidationState
 	return false;
 }
 
+static bool may_accept_generic(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	return e->type == EV_BOOL;
+}
+
+static bool may_accept_true(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	return e->type == EV_BOOL && e->value.boolean;
+}
+
+static bool may_accept_false(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	return e->type == EV_BOOL && !e->value.boolean;
+}
+
+static char* get_value_key_true(Validator *v)
+{
+	ValidationEvent e = validation_event_boolean(true);
+	return validation_event_get_value_key(&e);
+}
+
+static char* get_value_key_false(Validator *v)
+{
+	ValidationEvent e = validation_event_boolean(false);
+	return validation_event_get_value_key(&e);
+}
+
 static Validator* set_default(Validator *v, jvalue_ref def_value)
 {
 	BooleanValidator *b = (BooleanValidator *) v;
@@ -89,31 +119,76 @@ static Validator* set_default_generic(Validator *v, jvalue_ref def_value)
 	return set_default(&boolean_validator_new()->base, def_value);
 }
 
+static bool serialize(Validator *v, BlobWriter *w)
+{
+	BooleanValidator *b = (BooleanValidator *) v;
+	blob_write_tag(w, BLOB_BOOLEAN);
+	blob_write_jvalue(w, b->def_value);
+	return true;
+}
+
+static bool serialize_generic(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_BOOLEAN_GENERIC);
+	return true;
+}
+
+static bool serialize_true(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_BOOLEAN_TRUE);
+	return true;
+}
+
+static bool serialize_false(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_BOOLEAN_FALSE);
+	return true;
+}
+
+static PlanNode* compile_plan(Validator *v, PlanBuilder *b)
+{
+	return plan_node_scalar(PLAN_BOOLEAN);
+}
+
 static ValidatorVtable boolean_vtable =
 {
 	.ref = ref,
 	.unref = unref,
 	.check = check_generic,
+	.may_accept = may_accept_generic,
 	.set_default = set_default,
 	.get_default = get_default,
+	.serialize = serialize,
+	.compile_plan = compile_plan,
 };
 
 static ValidatorVtable generic_boolean_vtable =
 {
 	.check = check_generic,
+	.may_accept = may_accept_generic,
 	.set_default = set_default_generic,
+	.serialize = serialize_generic,
+	.compile_plan = compile_plan,
 };
 
 static ValidatorVtable true_boolean_vtable =
 {
 	.check = check_true,
+	.may_accept = may_accept_true,
+	.get_value_key = get_value_key_true,
 	.set_default = set_default_generic,
+	.serialize = serialize_true,
+	.compile_plan = compile_plan,
 };
 
 static ValidatorVtable false_boolean_vtable =
 {
 	.check = check_false,
+	.may_accept = may_accept_false,
+	.get_value_key = get_value_key_false,
 	.set_default = set_default_generic,
+	.serialize = serialize_false,
+	.compile_plan = compile_plan,
 };
 
 static Validator GENERIC_BOOLEAN_VALIDATOR =
@@ -28,8 +28,10 @@
 #include "validation_state.h"
 #include "validation_event.h"
 #include "parser_context.h"
+#include "schema_blob.h"
 #include "type_parser.h"
 #include <jobject.h>
+#include <glib.h>
 #include <assert.h>
 
 static Validator* _get_current_validator(CombinedTypesValidator *c, ValidationEvent const *e)
@@ -71,6 +73,12 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 	return validator_check(vcur, e, s, c);
 }
 
+static bool _may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	Validator *vcur = _get_current_validator((CombinedTypesValidator *) v, e);
+	return vcur && validator_may_accept(vcur, e, s);
+}
+
 static bool equals(Validator *v, Validator *other)
 {
 	CombinedTypesValidator *c = (CombinedTypesValidator *) v;
@@ -86,14 +94,14 @@ static bool equals(Validator *v, Validator *other)
 static Validator* ref(Validator *validator)
 {
 	CombinedTypesValidator *v = (CombinedTypesValidator *) validator;
-	++v->ref_count;
+	g_atomic_int_inc(&v->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	CombinedTypesValidator *v = (CombinedTypesValidator *) validator;
-	if (--v->ref_count)
+	if (!g_atomic_int_dec_and_test(&v->ref_count))
 		return;
 	combined_types_validator_release(v);
 }
@@ -268,9 +276,21 @@ static void _visit(Validator *v,
 	}
 }
 
+static bool serialize(Validator *v, BlobWriter *w)
+{
+	CombinedTypesValidator *c = (CombinedTypesValidator *) v;
+	blob_write_tag(w, BLOB_COMBINED_TYPES);
+	int i = 0;
+	for (; i < V_TYPES_NUM; ++i)
+		blob_write_validator(w, c->types[i]);
+	blob_write_jvalue(w, c->def_value);
+	return true;
+}
+
 ValidatorVtable combined_types_vtable =
 {
 	.check = _check,
+	.may_accept = _may_accept,
 	.equals = equals,
 	.ref = ref,
 	.unref = unref,
@@ -293,6 +313,7 @@ ValidatorVtable combined_types_vtable =
 	.set_object_min_properties = set_min_properties,
 	.set_default = set_default,
 	.get_default = get_default,
+	.serialize = serialize,
 };
 
 CombinedTypesValidator* combined_types_validator_new(void)
@@ -313,6 +334,15 @@ void combined_types_validator_release(CombinedTypesValidator *v)
 	g_free(v);
 }
 
+Validator* combined_types_validator_load(BlobReader *r)
+{
+	CombinedTypesValidator *c = combined_types_validator_new();
+	int i = 0;
+	for (; i < V_TYPES_NUM; ++i)
+		c->types[i] = blob_read_validator(r);
+	return &c->base;
+}
+
 bool combined_types_validator_set_type(CombinedTypesValidator *c, const char *type_str, size_t len)
 {
 	StringSpan str = { .str = type_str, .str_len = len };
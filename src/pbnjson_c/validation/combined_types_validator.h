@@ -23,6 +23,7 @@
 extern "C" {
 #endif
 
+typedef struct _BlobReader BlobReader;
 
 /** @brief Expected validator type */
 typedef enum _ValidatorType
@@ -43,7 +44,7 @@ typedef enum _ValidatorType
 typedef struct _CombinedTypesValidator
 {
 	Validator base;                  /**< @brief Base class */
-	unsigned ref_count;              /**< @brief Reference count */
+	int ref_count;                   /**< @brief Reference count */
 	jvalue_ref def_value;            /**< @brief Default value attached to this validator */
 
 	Validator* types[V_TYPES_NUM];   /**< @brief Validators for specified types {"type":[...]}. */
@@ -58,6 +59,9 @@ CombinedTypesValidator* combined_types_validator_new();
 /** @brief Destructor */
 void combined_types_validator_release(CombinedTypesValidator *v);
 
+/** @brief Restore the validator from a precompiled schema, see schema_blob.h */
+Validator* combined_types_validator_load(BlobReader *r);
+
 /** @brief Add validator for a specific type. */
 bool combined_types_validator_set_type(CombinedTypesValidator *c, const char *type_str, size_t len);
 
@@ -19,15 +19,34 @@
 #include "validation_state.h"
 #include "validation_event.h"
 #include "validation_api.h"
+#include "schema_blob.h"
+#include "scalar_map.h"
 #include <jobject.h>
+#include <string.h>
 #include <assert.h>
 
+/** @brief Subschemas of objects by the value of the property, which they require */
+struct _TagIndex
+{
+	char *name;           // Name of the property
+	ScalarMap *values;    // Value key -> GSList of the tagged subschemas
+	GHashTable *tagged;   // Set of the tagged subschemas
+};
+
 typedef struct _MyContext
 {
 	GList *states;
 	Notification *notify;
+	bool has_started;
+	GArray *pending;  // Events of the object held back until its tag is seen
+	bool at_tag;      // Has the key of the tag just been seen?
+	int depth;        // Depth of the containers within the object
 } MyContext;
 
+// The tag usually comes first, the objects, which have it later, are
+// validated by every subschema
+#define MAX_PENDING_EVENTS 32
+
 static bool _all_of_check(ValidationEvent const *e,
                           ValidationState *real_state,
                           void *ctxt,
@@ -235,10 +254,215 @@ static bool not_check(ValidationEvent const *e,
 	return true;
 }
 
+static bool is_alternative(CombinedValidator *v)
+{
+	return v->check_all == any_of_check ||
+	       v->check_all == enum_check ||
+	       v->check_all == _one_of_check;
+}
+
+static ValidationErrorCode alternative_error(CombinedValidator *v)
+{
+	return v->check_all == enum_check ? VEC_UNEXPECTED_VALUE : VEC_NEITHER_OF_ANY;
+}
+
+// Returns false if no substate has been created for an alternative
+static bool init_states(CombinedValidator *vcomb, ValidationEvent const *e,
+                        ValidationState *s, MyContext *my_ctxt,
+                        TagIndex *tags, GSList *candidates)
+{
+	// Notification for the substates: either own with suppressed errors,
+	// or the general one if inner errors are collected.
+	Notification *notify = my_ctxt->notify ? my_ctxt->notify : s->notify;
+
+	// Alternatives, which can't accept the value, would be dropped right after
+	// the first event. Don't bother creating states for them, the summary error
+	// is reported if nothing is left. So are the objects with other tags.
+	bool skip_impossible = is_alternative(vcomb);
+
+	GSList *it = vcomb->validators;
+	while (it)
+	{
+		bool possible = !skip_impossible || validator_may_accept(it->data, e, s);
+		if (possible && tags && g_hash_table_contains(tags->tagged, it->data))
+			possible = g_slist_find(candidates, it->data) != NULL;
+		if (possible)
+		{
+			ValidationState *substate = validation_state_new(it->data, s->uri_resolver, notify);
+			my_ctxt->states = g_list_prepend(my_ctxt->states, substate);
+		}
+		it = g_slist_next(it);
+	}
+	my_ctxt->states = g_list_reverse(my_ctxt->states);
+
+	return my_ctxt->states || !skip_impossible;
+}
+
+static bool has_text(ValidationEvent const *e)
+{
+	return e->type == EV_STR || e->type == EV_OBJ_KEY ||
+	       (e->type == EV_NUM && e->number_format == EV_NUM_TEXT);
+}
+
+static void pending_push(MyContext *my_ctxt, ValidationEvent const *e)
+{
+	// The texts belong to the parser, keep own copies
+	ValidationEvent copy = *e;
+	if (has_text(e))
+		copy.value.string.ptr = g_strndup(e->value.string.ptr, e->value.string.len);
+	g_array_append_val(my_ctxt->pending, copy);
+}
+
+static void pending_free(GArray *pending)
+{
+	for (guint i = 0; i < pending->len; ++i)
+	{
+		ValidationEvent *e = &g_array_index(pending, ValidationEvent, i);
+		if (has_text(e))
+			g_free((char *) e->value.string.ptr);
+	}
+	g_array_free(pending, TRUE);
+}
+
+// Hold the events of the object back until its tag is seen.
+// Returns true when the substates are to be created, *tagged tells whether
+// the event is the value of the tag.
+static bool await_tag(CombinedValidator *vcomb, ValidationEvent const *e,
+                      MyContext *my_ctxt, bool *tagged)
+{
+	*tagged = false;
+	if (my_ctxt->at_tag)
+	{
+		// Only scalar values are indexed
+		*tagged = e->type != EV_OBJ_START && e->type != EV_ARR_START;
+		return true;
+	}
+
+	switch (e->type)
+	{
+	case EV_OBJ_START:
+	case EV_ARR_START:
+		++my_ctxt->depth;
+		break;
+	case EV_OBJ_END:
+	case EV_ARR_END:
+		if (!--my_ctxt->depth)
+			return true;
+		break;
+	case EV_OBJ_KEY:
+		my_ctxt->at_tag = my_ctxt->depth == 1 &&
+		                  e->value.string.len == strlen(vcomb->tags->name) &&
+		                  memcmp(e->value.string.ptr, vcomb->tags->name, e->value.string.len) == 0;
+		break;
+	default:
+		break;
+	}
+
+	// Don't keep much, if the tag comes late
+	if (my_ctxt->pending->len >= MAX_PENDING_EVENTS)
+		return true;
+
+	pending_push(my_ctxt, e);
+	return false;
+}
+
+// Create the substates for the object held back, and replay its events to them
+static bool check_pending(CombinedValidator *vcomb, ValidationEvent const *e,
+                          ValidationState *s, void *c, MyContext *my_ctxt, bool tagged)
+{
+	GArray *pending = my_ctxt->pending;
+	my_ctxt->pending = NULL;
+
+	gpointer candidates = NULL;
+	if (tagged)
+		scalar_map_lookup_event(vcomb->tags->values, e, &candidates);
+
+	bool res = init_states(vcomb, &g_array_index(pending, ValidationEvent, 0), s, my_ctxt,
+	                       tagged ? vcomb->tags : NULL, candidates);
+	if (!res)
+		validation_state_notify_error(s, alternative_error(vcomb), c);
+
+	bool all_finished = false;
+	for (guint i = 0; res && !all_finished && i <= pending->len; ++i)
+	{
+		ValidationEvent const *ev = i < pending->len ? &g_array_index(pending, ValidationEvent, i) : e;
+		res = vcomb->check_all(ev, s, c, &all_finished);
+	}
+	pending_free(pending);
+
+	if (!res || all_finished)
+		validation_state_pop_validator(s);
+	return res;
+}
+
+// Look up a scalar value in the enum index.
+// Returns true if the result is known, *found tells whether the value is listed.
+static bool enum_lookup(CombinedValidator *v, ValidationEvent const *e, bool *found)
+{
+	if (!v->values)
+		return false;
+
+	switch (e->type)
+	{
+	case EV_NULL:
+	case EV_BOOL:
+	case EV_NUM:
+	case EV_STR:
+		break;
+	default:
+		return false;
+	}
+
+	*found = scalar_map_lookup_event(v->values, e, NULL);
+
+	// Unindexed subschemas (arrays, objects) have to be checked the usual way
+	return *found || !v->unindexed_count;
+}
+
 static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, void *c)
 {
 	CombinedValidator *vcomb = (CombinedValidator *) v;
 
+	MyContext *my_ctxt = (MyContext *) validation_state_get_context(s);
+	assert(my_ctxt);
+	if (!my_ctxt->has_started)
+	{
+		my_ctxt->has_started = true;
+
+		bool found;
+		if (vcomb->check_all == enum_check && enum_lookup(vcomb, e, &found))
+		{
+			if (!found)
+				validation_state_notify_error(s, VEC_UNEXPECTED_VALUE, c);
+			validation_state_pop_validator(s);
+			return found;
+		}
+
+		// The subschemas of an object may be picked by its tag, wait for it
+		if (vcomb->tags && e->type == EV_OBJ_START)
+		{
+			my_ctxt->pending = g_array_new(FALSE, FALSE, sizeof(ValidationEvent));
+			my_ctxt->depth = 1;
+			pending_push(my_ctxt, e);
+			return true;
+		}
+
+		// Substates are created lazily, when the first event of the value is known
+		if (!init_states(vcomb, e, s, my_ctxt, NULL, NULL))
+		{
+			validation_state_notify_error(s, alternative_error(vcomb), c);
+			validation_state_pop_validator(s);
+			return false;
+		}
+	}
+	else if (my_ctxt->pending)
+	{
+		bool tagged;
+		if (!await_tag(vcomb, e, my_ctxt, &tagged))
+			return true;
+		return check_pending(vcomb, e, s, c, my_ctxt, tagged);
+	}
+
 	bool all_finished;
 	bool res = vcomb->check_all(e, s, c, &all_finished);
 	if (!res || all_finished)
@@ -249,39 +473,20 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 	return res;
 }
 
-static void init_states_with_notify(Validator *v, ValidationState *s, MyContext *my_ctxt, Notification* notify)
+static bool init_state(Validator *v, ValidationState *s)
 {
 	CombinedValidator *vcomb = (CombinedValidator *) v;
-	GSList *it = vcomb->validators;
-	while (it)
-	{
-		ValidationState *substate = validation_state_new(it->data, s->uri_resolver, notify);
-		my_ctxt->states = g_list_append(my_ctxt->states, substate);
-		it = g_slist_next(it);
-	}
-}
-
-static bool init_state_collect_errors(Validator *v, ValidationState *s)
-{
 	MyContext *my_ctxt = g_slice_new0(MyContext);
-	init_states_with_notify(v, s, my_ctxt, s->notify);
-	validation_state_push_context(s, my_ctxt);
-	return true;
-}
 
-static bool init_state_suppress_errors(Validator *v, ValidationState *s)
-{
-	Notification *notify = NULL;
-	if (s->notify)
+	// Errors of subschemas are suppressed, the summary one is reported instead
+	if (!vcomb->collect_errors && s->notify)
 	{
-		notify = g_slice_new0(Notification);
+		Notification *notify = g_slice_new0(Notification);
 		notify->default_property_func = s->notify->default_property_func;
 		notify->has_array_duplicates = s->notify->has_array_duplicates;
+		my_ctxt->notify = notify;
 	}
 
-	MyContext *my_ctxt = g_slice_new0(MyContext);
-	my_ctxt->notify = notify;
-	init_states_with_notify(v, s, my_ctxt, notify);
 	validation_state_push_context(s, my_ctxt);
 	return true;
 }
@@ -292,21 +497,178 @@ static void cleanup_state(Validator *v, ValidationState *s)
 	assert(c);
 
 	g_list_free_full(c->states, (GDestroyNotify) validation_state_free);
+	if (c->pending)
+		pending_free(c->pending);
 	g_slice_free(Notification, c->notify);
 	g_slice_free(MyContext, c);
 }
 
+static bool _may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	CombinedValidator *vcomb = (CombinedValidator *) v;
+	if (vcomb->check_all == not_check)
+		return true;
+
+	bool every = vcomb->check_all == _all_of_check;
+	GSList *it = vcomb->validators;
+	while (it)
+	{
+		if (validator_may_accept(it->data, e, s) != every)
+			return !every;
+		it = g_slist_next(it);
+	}
+	return every;
+}
+
+static char* get_value_key(Validator *v)
+{
+	CombinedValidator *vcomb = (CombinedValidator *) v;
+	if (vcomb->check_all == enum_check)
+	{
+		if (!vcomb->validators || vcomb->validators->next)
+			return NULL;
+		return validator_get_value_key(vcomb->validators->data);
+	}
+
+	// {"type": "string", "enum": ["a"]} can't accept anything but "a"
+	if (vcomb->check_all == _all_of_check)
+	{
+		for (GSList *it = vcomb->validators; it; it = g_slist_next(it))
+		{
+			char *key = validator_get_value_key(it->data);
+			if (key)
+				return key;
+		}
+	}
+	return NULL;
+}
+
+static void tag_index_free(TagIndex *tags)
+{
+	if (!tags)
+		return;
+	g_free(tags->name);
+	scalar_map_free(tags->values);
+	g_hash_table_destroy(tags->tagged);
+	g_free(tags);
+}
+
+static void _count_tag(char const *name, char *value_key, void *ctxt)
+{
+	GHashTable *counts = (GHashTable *) ctxt;
+	guint count = GPOINTER_TO_UINT(g_hash_table_lookup(counts, name));
+	g_hash_table_replace(counts, g_strdup(name), GUINT_TO_POINTER(count + 1));
+	g_free(value_key);
+}
+
+typedef struct _TagFilter
+{
+	char const *name;    // The tag to look for
+	char *value_key;     // Its value in the subschema
+} TagFilter;
+
+static void _find_tag(char const *name, char *value_key, void *ctxt)
+{
+	TagFilter *filter = (TagFilter *) ctxt;
+	if (!filter->value_key && strcmp(name, filter->name) == 0)
+		filter->value_key = value_key;
+	else
+		g_free(value_key);
+}
+
+// The validator, which describes the value of the subschema
+static Validator* final_target(Validator *v)
+{
+	Validator *target;
+	while ((target = validator_get_target(v)))
+		v = target;
+	return v;
+}
+
+// Pick the tag, which is required by the most of the subschemas
+static char* choose_tag(CombinedValidator *vcomb)
+{
+	GHashTable *counts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	for (GSList *it = vcomb->validators; it; it = g_slist_next(it))
+		validator_collect_tags(final_target(it->data), _count_tag, counts);
+
+	char const *best = NULL;
+	guint best_count = 1;
+	GHashTableIter it;
+	gpointer name, count;
+	g_hash_table_iter_init(&it, counts);
+	while (g_hash_table_iter_next(&it, &name, &count))
+	{
+		if (GPOINTER_TO_UINT(count) > best_count ||
+		    (GPOINTER_TO_UINT(count) == best_count && best && strcmp(name, best) < 0))
+		{
+			best = name;
+			best_count = GPOINTER_TO_UINT(count);
+		}
+	}
+
+	char *res = g_strdup(best);
+	g_hash_table_destroy(counts);
+	return res;
+}
+
+static TagIndex* tag_index_new(CombinedValidator *vcomb)
+{
+	char *name = choose_tag(vcomb);
+	if (!name)
+		return NULL;
+
+	TagIndex *tags = g_new0(TagIndex, 1);
+	tags->name = name;
+	tags->values = scalar_map_new((GDestroyNotify) g_slist_free);
+	tags->tagged = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+	for (GSList *it = vcomb->validators; it; it = g_slist_next(it))
+	{
+		TagFilter filter = { .name = name, .value_key = NULL };
+		validator_collect_tags(final_target(it->data), _find_tag, &filter);
+		if (!filter.value_key)
+			continue;
+
+		g_hash_table_add(tags->tagged, it->data);
+
+		gpointer data = NULL;
+		if (scalar_map_lookup_key(tags->values, filter.value_key, &data))
+		{
+			g_slist_append(data, it->data);
+			g_free(filter.value_key);
+		}
+		else
+			scalar_map_insert(tags->values, filter.value_key, g_slist_prepend(NULL, it->data));
+	}
+	return tags;
+}
+
+static void _link_exit(char const *key, Validator *v, void *ctxt, Validator **new_v)
+{
+	CombinedValidator *vcomb = (CombinedValidator *) v;
+
+	// The subschemas have been bound, look into their targets. The schema
+	// may be linked few times, the tree doesn't change meanwhile.
+	if (vcomb->tags ||
+	    (vcomb->check_all != any_of_check && vcomb->check_all != _one_of_check))
+	{
+		return;
+	}
+	vcomb->tags = tag_index_new(vcomb);
+}
+
 static Validator* ref(Validator *validator)
 {
 	CombinedValidator *v = (CombinedValidator *) validator;
-	++v->ref_count;
+	g_atomic_int_inc(&v->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	CombinedValidator *v = (CombinedValidator *) validator;
-	if (--v->ref_count)
+	if (!g_atomic_int_dec_and_test(&v->ref_count))
 		return;
 	combined_validator_release(v);
 }
@@ -344,6 +706,12 @@ static void _visit(Validator *v,
 		{
 			validator_unref(item);
 			iter->data = new_v;
+
+			// The indexes may not match the subschemas anymore
+			scalar_map_free(a->values);
+			a->values = NULL;
+			tag_index_free(a->tags);
+			a->tags = NULL;
 		}
 		iter = g_slist_next(iter);
 	}
@@ -362,10 +730,50 @@ static void _dump_exit(char const *key, Validator *v, void *ctxt, Validator **ne
 	fprintf((FILE *) ctxt, ">");
 }
 
+/** @brief Kinds of the combined validator in a precompiled schema */
+enum
+{
+	COMBINED_NONE = 0,
+	COMBINED_ALL_OF,
+	COMBINED_ANY_OF,
+	COMBINED_ONE_OF,
+	COMBINED_NOT,
+	COMBINED_ENUM,
+};
+
+static bool _serialize(Validator *v, BlobWriter *w)
+{
+	CombinedValidator *c = (CombinedValidator *) v;
+	int kind = COMBINED_NONE;
+	if (c->check_all == _all_of_check)
+		kind = COMBINED_ALL_OF;
+	else if (c->check_all == any_of_check)
+		kind = COMBINED_ANY_OF;
+	else if (c->check_all == _one_of_check)
+		kind = COMBINED_ONE_OF;
+	else if (c->check_all == not_check)
+		kind = COMBINED_NOT;
+	else if (c->check_all == enum_check)
+		kind = COMBINED_ENUM;
+	else if (c->check_all)
+		return false;
+
+	blob_write_tag(w, BLOB_COMBINED);
+	blob_write_int(w, kind);
+	blob_write_bool(w, c->collect_errors);
+	blob_write_int(w, g_slist_length(c->validators));
+	for (GSList *it = c->validators; it; it = g_slist_next(it))
+		blob_write_validator(w, it->data);
+	blob_write_jvalue(w, c->def_value);
+	return true;
+}
+
 ValidatorVtable combined_vtable =
 {
 	.check = _check,
-	.init_state = init_state_suppress_errors,
+	.may_accept = _may_accept,
+	.get_value_key = get_value_key,
+	.init_state = init_state,
 	.cleanup_state = cleanup_state,
 	.ref = ref,
 	.unref = unref,
@@ -374,6 +782,8 @@ ValidatorVtable combined_vtable =
 	.get_default = get_default,
 	.dump_enter = _dump_enter,
 	.dump_exit = _dump_exit,
+	.link_exit = _link_exit,
+	.serialize = _serialize,
 };
 
 CombinedValidator* combined_validator_new(void)
@@ -441,8 +851,30 @@ void combined_validator_convert_to_not(CombinedValidator *v)
 	combined_validator_add_value(v, inverse_generic_validator_instance());
 }
 
+static void enum_index_value(CombinedValidator *c, Validator *v)
+{
+	char *key = validator_get_value_key(v);
+	if (!key)
+	{
+		++c->unindexed_count;
+		return;
+	}
+
+	if (!c->values)
+		c->values = scalar_map_new(NULL);
+	scalar_map_insert(c->values, key, NULL);
+}
+
 static bool enum_check_add_value(CombinedValidator *c, Validator *v)
 {
+	char *key = validator_get_value_key(v);
+	if (key)
+	{
+		bool unique = !c->values || !scalar_map_lookup_key(c->values, key, NULL);
+		g_free(key);
+		return unique;
+	}
+
 	GSList *it = c->validators;
 	while (it)
 	{
@@ -456,16 +888,23 @@ static bool enum_check_add_value(CombinedValidator *c, Validator *v)
 void combined_validator_convert_to_enum(CombinedValidator *v)
 {
 	v->check_all = enum_check;
+
+	GSList *it = v->validators;
+	while (it)
+	{
+		enum_index_value(v, it->data);
+		it = g_slist_next(it);
+	}
 }
 
 void combined_validator_collect_errors(CombinedValidator *v)
 {
-	v->base.vtable->init_state = init_state_collect_errors;
+	v->collect_errors = true;
 }
 
 void combined_validator_suppress_errors(CombinedValidator *v)
 {
-	v->base.vtable->init_state = init_state_suppress_errors;
+	v->collect_errors = false;
 }
 
 
@@ -477,6 +916,8 @@ static void _validator_release(gpointer data)
 void combined_validator_release(CombinedValidator *v)
 {
 	g_slist_free_full(v->validators, _validator_release);
+	scalar_map_free(v->values);
+	tag_index_free(v->tags);
 	j_release(&v->def_value);
 	g_free(v);
 }
@@ -484,6 +925,8 @@ void combined_validator_release(CombinedValidator *v)
 void combined_validator_add_value(CombinedValidator *a, Validator *v)
 {
 	a->validators = g_slist_prepend(a->validators, v);
+	if (a->check_all == enum_check)
+		enum_index_value(a, v);
 }
 
 bool combined_validator_add_enum_value(CombinedValidator *a, Validator *v)
@@ -497,3 +940,52 @@ bool combined_validator_add_enum_value(CombinedValidator *a, Validator *v)
 	combined_validator_add_value(a, v);
 	return true;
 }
+
+Validator* combined_validator_load(BlobReader *r)
+{
+	CombinedValidator *c = combined_validator_new();
+	int kind = blob_read_int(r);
+	c->collect_errors = blob_read_bool(r);
+
+	// The values are prepended, restore them in reverse order to keep the original one
+	int count = blob_read_int(r);
+	GSList *validators = NULL;
+	for (int i = 0; i < count && blob_reader_ok(r); ++i)
+	{
+		Validator *v = blob_read_validator(r);
+		if (!v)
+			blob_reader_fail(r);
+		validators = g_slist_prepend(validators, v);
+	}
+	for (GSList *it = validators; it; it = g_slist_next(it))
+	{
+		if (it->data)
+			combined_validator_add_value(c, it->data);
+	}
+	g_slist_free(validators);
+
+	switch (kind)
+	{
+	case COMBINED_NONE:
+		break;
+	case COMBINED_ALL_OF:
+		combined_validator_convert_to_all_of(c);
+		break;
+	case COMBINED_ANY_OF:
+		combined_validator_convert_to_any_of(c);
+		break;
+	case COMBINED_ONE_OF:
+		combined_validator_convert_to_one_of(c);
+		break;
+	case COMBINED_NOT:
+		// The inverse generic validator has been restored with the rest
+		c->check_all = not_check;
+		break;
+	case COMBINED_ENUM:
+		combined_validator_convert_to_enum(c);
+		break;
+	default:
+		blob_reader_fail(r);
+	}
+	return &c->base;
+}
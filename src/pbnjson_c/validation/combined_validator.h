@@ -24,16 +24,30 @@
 extern "C" {
 #endif
 
+typedef struct _BlobReader BlobReader;
+typedef struct _ScalarMap ScalarMap;
+typedef struct _TagIndex TagIndex;
 
 /** @brief Combinator of validators like in "allOf": [...] */
 typedef struct _CombinedValidator
 {
 	Validator base;          /**< @brief Base class */
-	unsigned ref_count;      /**< @brief Reference count */
+	int ref_count;           /**< @brief Reference count */
 	jvalue_ref def_value;    /**< @brief Default value attached to this validator */
 
 	GSList *validators;      /**< @brief Validators for subschemas to combine */
 
+	ScalarMap *values;       /**< @brief Set of constant scalar subschemas (for enum) */
+	size_t unindexed_count;  /**< @brief Count of subschemas, which aren't in #values (for enum) */
+
+	/** @brief Subschemas of objects by the value of their common tag, or NULL
+	 *
+	 * Built for alternatives by linking, see validator_link().
+	 */
+	TagIndex *tags;
+
+	bool collect_errors;     /**< @brief Report errors of subschemas instead of a summary one */
+
 	/** @brief Checking functions
 	 *
 	 * @param[in] e Validation event from YAJL to check.
@@ -54,6 +68,9 @@ CombinedValidator* combined_validator_new();
 /** @brief Destructor */
 void combined_validator_release(CombinedValidator *v);
 
+/** @brief Restore the validator from a precompiled schema, see schema_blob.h */
+Validator* combined_validator_load(BlobReader *r);
+
 /** @brief Construct validator for {"allOf": [...]} */
 CombinedValidator* all_of_validator_new();
 
@@ -69,7 +86,8 @@ CombinedValidator* not_validator_new();
 /** @brief Construct validator for {"enum": [...]}
  *
  * NOTE: Basically same as anyOf but will return UNEXPECTED_VALUE error in case of failed validation
- *       and do not support duplicate values
+ *       and do not support duplicate values. Scalar values are matched by a single lookup
+ *       in the hash set of their canonical keys.
  */
 CombinedValidator* enum_validator_new();
 
@@ -38,14 +38,14 @@ static void _release_definition(gpointer d)
 static Validator* ref(Validator *validator)
 {
 	Definitions *d = (Definitions *) validator;
-	++d->ref_count;
+	g_atomic_int_inc(&d->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	Definitions *d = (Definitions *) validator;
-	if (!d || --d->ref_count)
+	if (!d || !g_atomic_int_dec_and_test(&d->ref_count))
 		return;
 	g_slist_free_full(d->validators, _release_definition);
 	g_free(d->name);
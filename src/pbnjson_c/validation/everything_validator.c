@@ -15,6 +15,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "everything_validator.h"
+#include "schema_blob.h"
 
 static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, void *ctxt)
 {
@@ -22,9 +23,16 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 	return true;
 }
 
+static bool _serialize(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_EVERYTHING);
+	return true;
+}
+
 static ValidatorVtable everything_vtable =
 {
 	.check = _check,
+	.serialize = _serialize,
 };
 
 Validator EVERYTHING_VALIDATOR_IMPL =
@@ -15,6 +15,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "feature.h"
+#include <glib.h>
 #include <assert.h>
 
 void feature_init(Feature *f, FeatureVtable *vtable)
@@ -27,13 +28,13 @@ Feature* feature_ref(Feature *f)
 {
 	if (!f)
 		return f;
-	++f->ref_count;
+	g_atomic_int_inc(&f->ref_count);
 	return f;
 }
 
 void feature_unref(Feature *f)
 {
-	if (!f || --f->ref_count)
+	if (!f || !g_atomic_int_dec_and_test(&f->ref_count))
 		return;
 	if (!f->vtable || !f->vtable->release)
 		return;
@@ -17,20 +17,21 @@
 #include "generic_validator.h"
 #include "validation_state.h"
 #include "validation_event.h"
+#include "schema_blob.h"
 #include <jobject.h>
 #include <glib.h>
 
 static Validator* ref(Validator *validator)
 {
 	GenericValidator *v = (GenericValidator *) validator;
-	++v->ref_count;
+	g_atomic_int_inc(&v->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	GenericValidator *v = (GenericValidator *) validator;
-	if (--v->ref_count)
+	if (!g_atomic_int_dec_and_test(&v->ref_count))
 		return;
 	j_release(&v->def_value);
 	g_free(v);
@@ -126,6 +127,26 @@ static void dump_enter(char const *key, Validator *v, void *ctxt)
 	fprintf((FILE *) ctxt, "(*)");
 }
 
+static bool serialize(Validator *validator, BlobWriter *w)
+{
+	GenericValidator *v = (GenericValidator *) validator;
+	blob_write_tag(w, BLOB_GENERIC);
+	blob_write_jvalue(w, v->def_value);
+	return true;
+}
+
+static bool serialize_static(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_GENERIC_STATIC);
+	return true;
+}
+
+static bool serialize_inverse(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_GENERIC_INVERSE);
+	return true;
+}
+
 static ValidatorVtable generic_vtable =
 {
 	.ref = ref,
@@ -136,6 +157,7 @@ static ValidatorVtable generic_vtable =
 	.set_default = set_default,
 	.get_default = get_default,
 	.dump_enter = dump_enter,
+	.serialize = serialize,
 };
 
 static ValidatorVtable generic_static_vtable =
@@ -145,6 +167,7 @@ static ValidatorVtable generic_static_vtable =
 	.cleanup_state = cleanup_state,
 	.set_default = set_default_generic,
 	.dump_enter = dump_enter,
+	.serialize = serialize_static,
 };
 
 static ValidatorVtable inverse_generic_static_vtable =
@@ -153,6 +176,7 @@ static ValidatorVtable inverse_generic_static_vtable =
 	.init_state = init_state,
 	.cleanup_state = cleanup_state,
 	.dump_enter = dump_enter,
+	.serialize = serialize_inverse,
 };
 
 GenericValidator *generic_validator_new(void)
@@ -30,7 +30,7 @@ extern "C" {
 typedef struct _GenericValidator
 {
 	Validator base;        /**< @brief Base class */
-	unsigned ref_count;    /**< @brief Reference count */
+	int ref_count;         /**< @brief Reference count */
 	jvalue_ref def_value;  /**< @brief Default value attached to this validator */
 } GenericValidator;
 
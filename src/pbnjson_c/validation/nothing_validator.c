@@ -15,6 +15,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "nothing_validator.h"
+#include "schema_blob.h"
 
 static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, void *ctxt)
 {
@@ -22,9 +23,22 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 	return false;
 }
 
+static bool _may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	return false;
+}
+
+static bool _serialize(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_NOTHING);
+	return true;
+}
+
 static ValidatorVtable nothing_vtable =
 {
 	.check = _check,
+	.may_accept = _may_accept,
+	.serialize = _serialize,
 };
 
 Validator NOTHING_VALIDATOR_IMPL =
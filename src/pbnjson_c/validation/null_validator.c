@@ -18,19 +18,22 @@
 #include "validation_event.h"
 #include "validation_state.h"
 #include "error_code.h"
+#include "schema_blob.h"
+#include "serialization_plan.h"
 #include <jobject.h>
+#include <glib.h>
 
 static Validator* ref(Validator *validator)
 {
 	NullValidator *v = (NullValidator *) validator;
-	++v->ref_count;
+	g_atomic_int_inc(&v->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	NullValidator *v = (NullValidator *) validator;
-	if (--v->ref_count)
+	if (!g_atomic_int_dec_and_test(&v->ref_count))
 		return;
 	j_release(&v->def_value);
 	g_free(v);
@@ -63,10 +66,44 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 	return e->type == EV_NULL;
 }
 
+static bool _may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	return e->type == EV_NULL;
+}
+
+static char* get_value_key(Validator *v)
+{
+	ValidationEvent e = validation_event_null();
+	return validation_event_get_value_key(&e);
+}
+
+static bool serialize(Validator *validator, BlobWriter *w)
+{
+	NullValidator *v = (NullValidator *) validator;
+	blob_write_tag(w, BLOB_NULL);
+	blob_write_jvalue(w, v->def_value);
+	return true;
+}
+
+static bool serialize_generic(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_NULL_GENERIC);
+	return true;
+}
+
+static PlanNode* compile_plan(Validator *v, PlanBuilder *b)
+{
+	return plan_node_scalar(PLAN_NULL);
+}
+
 static ValidatorVtable generic_null_vtable =
 {
 	.check = _check,
+	.may_accept = _may_accept,
+	.get_value_key = get_value_key,
 	.set_default = set_default_generic,
+	.serialize = serialize_generic,
+	.compile_plan = compile_plan,
 };
 
 static ValidatorVtable null_vtable =
@@ -74,8 +111,12 @@ static ValidatorVtable null_vtable =
 	.ref = ref,
 	.unref = unref,
 	.check = _check,
+	.may_accept = _may_accept,
+	.get_value_key = get_value_key,
 	.set_default = set_default,
 	.get_default = get_default,
+	.serialize = serialize,
+	.compile_plan = compile_plan,
 };
 
 static Validator NULL_VALIDATOR_IMPL =
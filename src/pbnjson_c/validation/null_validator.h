@@ -27,7 +27,7 @@ extern "C" {
 typedef struct _NullValidator
 {
 	Validator base;        /**< @brief Base class */
-	unsigned ref_count;    /**< @brief Reference count */
+	int ref_count;         /**< @brief Reference count */
 	jvalue_ref def_value;  /**< @brief Default value attached to this validator */
 } NullValidator;
 
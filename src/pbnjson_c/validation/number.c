@@ -15,7 +15,11 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "number.h"
+#include <glib.h>
 #include <stdio.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <math.h>
 
 void number_init(Number *number)
 {
@@ -41,6 +45,37 @@ int number_set_n(Number *number, char const *str, size_t len)
 	return number_set(number, buffer);
 }
 
+void number_set_int64(Number *number, int64_t value)
+{
+	if (value >= LONG_MIN && value <= LONG_MAX)
+	{
+		mpf_set_si(number->f, (long) value);
+		return;
+	}
+
+	// long is narrower than int64_t on this platform
+	char buffer[24];
+	snprintf(buffer, sizeof(buffer), "%" PRId64, value);
+	number_set(number, buffer);
+}
+
+int number_set_double(Number *number, double value)
+{
+	if (!isfinite(value))
+		return -1;
+
+	// Integers below 10^14 are printed exactly, no need to round them
+	if (value == trunc(value) && fabs(value) < 1e14)
+	{
+		mpf_set_d(number->f, value);
+		return 0;
+	}
+
+	char buffer[24];
+	snprintf(buffer, sizeof(buffer), "%.14lg", value);
+	return number_set(number, buffer);
+}
+
 void number_copy(Number *dest, Number *src)
 {
 	mpf_set(dest->f, src->f);
@@ -75,3 +110,132 @@ void number_div(Number const *a, Number const *b, Number *res)
 {
 	mpf_div(res->f, a->f, b->f);
 }
+
+char* number_get_canonical(Number const *n)
+{
+	// Digits of the mantissa with implicit radix point before them,
+	// trailing zeros are stripped by GMP.
+	mp_exp_t exp;
+	char *digits = mpf_get_str(NULL, &exp, 10, 0, n->f);
+	char *res = g_strdup_printf("%se%ld", digits, (long) exp);
+
+	void (*free_func)(void *, size_t);
+	mp_get_memory_functions(NULL, NULL, &free_func);
+	free_func(digits, strlen(digits) + 1);
+	return res;
+}
+
+char* number_get_string(Number const *n)
+{
+	mp_exp_t exp;
+	char *digits = mpf_get_str(NULL, &exp, 10, 0, n->f);
+	char *res = NULL;
+	if (!*digits)
+		res = g_strdup("0");
+	else if (*digits == '-')
+		res = g_strdup_printf("-0.%se%ld", digits + 1, (long) exp);
+	else
+		res = g_strdup_printf("0.%se%ld", digits, (long) exp);
+
+	void (*free_func)(void *, size_t);
+	mp_get_memory_functions(NULL, NULL, &free_func);
+	free_func(digits, strlen(digits) + 1);
+	return res;
+}
+
+bool number_text_get_int64(char const *str, size_t len, int64_t *value)
+{
+	char const *p = str, *end = str + len;
+	bool negative = p < end && *p == '-';
+	if (negative)
+		++p;
+
+	// Up to 19 significant digits fit into the mantissa, the rest have to be zeros
+	uint64_t mantissa = 0;
+	int digits = 0;
+	long exponent = 0;
+	bool seen_digit = false, fraction = false;
+	for (; p < end; ++p)
+	{
+		if (*p == '.' && !fraction)
+		{
+			fraction = true;
+			continue;
+		}
+		if (*p < '0' || *p > '9')
+			break;
+		seen_digit = true;
+		int d = *p - '0';
+		if (mantissa == 0 && d == 0)
+		{
+			if (fraction)
+				--exponent;
+			continue;
+		}
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + d;
+			++digits;
+			if (fraction)
+				--exponent;
+		}
+		else if (d)
+			return false;
+		else if (!fraction)
+			++exponent;
+	}
+	if (!seen_digit)
+		return false;
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		++p;
+		bool negative_exp = p < end && *p == '-';
+		if (p < end && (*p == '-' || *p == '+'))
+			++p;
+		if (p == end)
+			return false;
+		long e = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; ++p)
+		{
+			// Too big exponents don't give int64 anyway
+			if (e < 1000)
+				e = e * 10 + (*p - '0');
+		}
+		exponent += negative_exp ? -e : e;
+	}
+	if (p != end)
+		return false;
+
+	if (mantissa == 0)
+	{
+		*value = 0;
+		return true;
+	}
+	for (; exponent < 0; ++exponent)
+	{
+		if (mantissa % 10)
+			return false;
+		mantissa /= 10;
+	}
+	for (; exponent > 0; --exponent)
+	{
+		if (mantissa > UINT64_MAX / 10)
+			return false;
+		mantissa *= 10;
+	}
+
+	if (negative)
+	{
+		if (mantissa > (uint64_t) INT64_MAX + 1)
+			return false;
+		*value = mantissa == (uint64_t) INT64_MAX + 1 ? INT64_MIN : -(int64_t) mantissa;
+	}
+	else
+	{
+		if (mantissa > INT64_MAX)
+			return false;
+		*value = (int64_t) mantissa;
+	}
+	return true;
+}
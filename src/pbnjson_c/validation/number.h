@@ -17,6 +17,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <gmp.h>
 
@@ -54,6 +55,18 @@ int number_set(Number *number, char const *str);
  */
 int number_set_n(Number *number, char const *str, size_t len);
 
+/** @brief Set number value from integer. */
+void number_set_int64(Number *number, int64_t value);
+
+/** @brief Set number value from floating point.
+ *
+ * The value is taken as it is serialized into JSON (14 significant digits),
+ * so that DOM numbers compare with schema constants the same way as parsed ones.
+ *
+ * @return 0 on success, -1 if the value isn't finite.
+ */
+int number_set_double(Number *number, double value);
+
 /** @brief Copy number to another number. */
 void number_copy(Number *dest, Number *src);
 
@@ -78,6 +91,34 @@ long number_get_long(Number const *n);
 /** @brief Calculates division of two numbers (res = a / b) */
 void number_div(Number const *a, Number const *b, Number *res);
 
+/** @brief Format the number in canonical form.
+ *
+ * Equal numbers get equal representation regardless of their original
+ * notation (e.g. "10", "1e1" and "10.0").
+ *
+ * @return Newly allocated string, release with g_free()
+ */
+char* number_get_canonical(Number const *n);
+
+/** @brief Get the value of JSON number text as 64-bit integer.
+ *
+ * The text is converted exactly without GMP and allocations, so that it can
+ * be used on the hot paths. "10", "1e1" and "10.0" give the same value.
+ *
+ * @param[in] str Pointer to the number text
+ * @param[in] len Length of the text
+ * @param[out] value The integer
+ * @return false if the number isn't an integer within int64_t range,
+ *         or the text has more than 19 significant digits
+ */
+bool number_text_get_int64(char const *str, size_t len, int64_t *value);
+
+/** @brief Convert number to a string accepted back by number_set() without loss.
+ *
+ * @return Newly allocated string, release with g_free()
+ */
+char* number_get_string(Number const *n);
+
 
 #ifdef __cplusplus
 }
@@ -19,6 +19,8 @@
 #include "validation_state.h"
 #include "validation_event.h"
 #include "parser_context.h"
+#include "schema_blob.h"
+#include "serialization_plan.h"
 #include <jobject.h>
 #include <glib.h>
 #include <string.h>
@@ -88,9 +90,22 @@ static bool check_generic(Validator *v, ValidationEvent const *e, ValidationStat
 	return true;
 }
 
+static bool may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	return e->type == EV_NUM;
+}
+
+static char* get_value_key(Validator *v)
+{
+	NumberValidator *n = (NumberValidator *) v;
+	if (!n->expected_set || n->integer || n->max_set || n->min_set || n->multiple_of_set)
+		return NULL;
+	return validation_event_get_number_key(&n->expected_value);
+}
+
 static bool check_integer_conditions(Number *n, ValidationEvent const *e, ValidationState *s, void *ctxt)
 {
-	if (number_set_n(n, e->value.string.ptr, e->value.string.len))
+	if (validation_event_get_number(e, n))
 	{
 		// TODO: Number format error
 		validation_state_notify_error(s, VEC_NOT_NUMBER, ctxt);
@@ -115,6 +130,13 @@ static bool check_integer_generic(Validator *v, ValidationEvent const *e, Valida
 		return false;
 	}
 
+	// Typed integers need no conversion at all
+	if (e->number_format == EV_NUM_INT64)
+	{
+		validation_state_pop_validator(s);
+		return true;
+	}
+
 	Number n;
 	number_init(&n);
 
@@ -135,7 +157,7 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 
 	Number n;
 	number_init(&n);
-	if (number_set_n(&n, e->value.string.ptr, e->value.string.len))
+	if (validation_event_get_number(e, &n))
 	{
 		number_clear(&n);
 		// TODO: Number format error
@@ -154,14 +176,14 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 static Validator* ref(Validator *validator)
 {
 	NumberValidator *v = (NumberValidator *) validator;
-	++v->ref_count;
+	g_atomic_int_inc(&v->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	NumberValidator *v = (NumberValidator *) validator;
-	if (--v->ref_count)
+	if (!g_atomic_int_dec_and_test(&v->ref_count))
 		return;
 	number_validator_release(v);
 }
@@ -300,26 +322,71 @@ static bool equals(Validator *v, Validator *other)
 	return false;
 }
 
+static void serialize_number(BlobWriter *w, bool set, Number const *n)
+{
+	blob_write_bool(w, set);
+	if (set)
+		blob_write_number(w, n);
+}
+
+static bool serialize(Validator *v, BlobWriter *w)
+{
+	NumberValidator *n = (NumberValidator *) v;
+	blob_write_tag(w, BLOB_NUMBER);
+	blob_write_bool(w, n->integer);
+	serialize_number(w, n->expected_set, &n->expected_value);
+	serialize_number(w, n->max_set, &n->max);
+	blob_write_bool(w, n->max_exclusive);
+	serialize_number(w, n->min_set, &n->min);
+	blob_write_bool(w, n->min_exclusive);
+	serialize_number(w, n->multiple_of_set, &n->multiple_of);
+	blob_write_jvalue(w, n->def_value);
+	return true;
+}
+
+static bool serialize_generic(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_NUMBER_GENERIC);
+	return true;
+}
+
+static bool serialize_integer_generic(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_INTEGER_GENERIC);
+	return true;
+}
+
+static PlanNode* compile_plan(Validator *v, PlanBuilder *b)
+{
+	return plan_node_scalar(PLAN_NUMBER);
+}
+
 static ValidatorVtable generic_number_vtable =
 {
 	.check = check_generic,
+	.may_accept = may_accept,
 	.set_number_maximum = set_maximum_generic,
 	.set_number_maximum_exclusive = set_maximum_exclusive_generic,
 	.set_number_minimum = set_minimum_generic,
 	.set_number_minimum_exclusive = set_minimum_exclusive_generic,
 	.set_number_multiple_of = set_multiple_of_generic,
 	.set_default = set_default_generic,
+	.serialize = serialize_generic,
+	.compile_plan = compile_plan,
 };
 
 static ValidatorVtable generic_integer_vtable =
 {
 	.check = check_integer_generic,
+	.may_accept = may_accept,
 	.set_number_maximum = set_maximum_integer_generic,
 	.set_number_maximum_exclusive = set_maximum_exclusive_integer_generic,
 	.set_number_minimum = set_minimum_integer_generic,
 	.set_number_minimum_exclusive = set_minimum_exclusive_integer_generic,
 	.set_number_multiple_of = set_multiple_of_integer_generic,
 	.set_default = set_default_integer_generic,
+	.serialize = serialize_integer_generic,
+	.compile_plan = compile_plan,
 };
 
 static ValidatorVtable number_vtable =
@@ -327,6 +394,8 @@ static ValidatorVtable number_vtable =
 	.ref = ref,
 	.unref = unref,
 	.check = _check,
+	.may_accept = may_accept,
+	.get_value_key = get_value_key,
 	.equals = equals,
 	.set_number_maximum = set_maximum,
 	.set_number_maximum_exclusive = set_maximum_exclusive,
@@ -335,6 +404,8 @@ static ValidatorVtable number_vtable =
 	.set_number_multiple_of = set_multiple_of,
 	.set_default = set_default,
 	.get_default = get_default,
+	.serialize = serialize,
+	.compile_plan = compile_plan,
 };
 
 NumberValidator* number_validator_new(void)
@@ -419,6 +490,28 @@ bool number_validator_add_expected_value(NumberValidator *n, StringSpan *span)
 	return true;
 }
 
+static bool load_number(BlobReader *r, Number *n)
+{
+	if (!blob_read_bool(r))
+		return false;
+	number_init(n);
+	blob_read_number(r, n);
+	return true;
+}
+
+Validator* number_validator_load(BlobReader *r)
+{
+	NumberValidator *n = number_validator_new();
+	n->integer = blob_read_bool(r);
+	n->expected_set = load_number(r, &n->expected_value);
+	n->max_set = load_number(r, &n->max);
+	n->max_exclusive = blob_read_bool(r);
+	n->min_set = load_number(r, &n->min);
+	n->min_exclusive = blob_read_bool(r);
+	n->multiple_of_set = load_number(r, &n->multiple_of);
+	return &n->base;
+}
+
 static Validator NUMBER_VALIDATOR_IMPL =
 {
 	.vtable = &generic_number_vtable,
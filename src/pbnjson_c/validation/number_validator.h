@@ -24,6 +24,7 @@
 extern "C" {
 #endif
 
+typedef struct _BlobReader BlobReader;
 
 typedef struct _StringSpan StringSpan;
 
@@ -32,7 +33,7 @@ typedef struct _StringSpan StringSpan;
 typedef struct _NumberValidator
 {
 	Validator base;          /**< @brief Base class */
-	unsigned ref_count;      /**< @brief Reference count */
+	int ref_count;           /**< @brief Reference count */
 	jvalue_ref def_value;    /**< @brief Default value attached to this validator */
 
 	bool integer;            /**< @brief Should a valid instance be integer? */
@@ -69,6 +70,9 @@ NumberValidator* integer_validator_new();
 /** @brief Destructor. */
 void number_validator_release(NumberValidator *v);
 
+/** @brief Restore the validator from a precompiled schema, see schema_blob.h */
+Validator* number_validator_load(BlobReader *r);
+
 // Methods for unit tests
 bool number_validator_add_min_constraint(NumberValidator *n, const char* val);
 void number_validator_add_min_exclusive_constraint(NumberValidator *n, bool exclusive);
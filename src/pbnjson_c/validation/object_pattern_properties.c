@@ -20,6 +20,7 @@
 
 #include "validator.h"
 #include "combined_validator.h"
+#include "schema_blob.h"
 
 
 typedef struct _Entry
@@ -122,7 +123,7 @@ Validator* object_pattern_properties_find(ObjectPatternProperties *o, const char
 	// accept the property value.
 	CombinedValidator *ret = any_of_validator_new();
 	for (GSList *s = validators; s != NULL; s = g_slist_next(s))
-		combined_validator_add_value(ret, s->data);
+		combined_validator_add_value(ret, validator_ref(s->data));
 	g_slist_free(validators);
 	return &ret->base;
 }
@@ -150,3 +151,52 @@ void object_pattern_properties_visit(ObjectPatternProperties *o,
 		}
 	}
 }
+
+void object_pattern_properties_serialize(ObjectPatternProperties *o, BlobWriter *w)
+{
+	blob_write_int(w, o ? g_slist_length(o->patterns) : 0);
+	if (!o)
+		return;
+
+	for (GSList *s = o->patterns; s != NULL; s = g_slist_next(s))
+	{
+		Entry *entry = (Entry *) s->data;
+		blob_write_string(w, g_regex_get_pattern(entry->regex));
+		blob_write_validator(w, entry->validator);
+	}
+}
+
+ObjectPatternProperties* object_pattern_properties_load(BlobReader *r)
+{
+	int count = blob_read_int(r);
+	if (count <= 0)
+		return NULL;
+
+	ObjectPatternProperties *o = object_pattern_properties_new();
+
+	// The entries are prepended, restore them in reverse order to keep the original one
+	GSList *patterns = NULL;
+	GSList *validators = NULL;
+	for (int i = 0; i < count && blob_reader_ok(r); ++i)
+	{
+		patterns = g_slist_prepend(patterns, blob_read_string(r));
+		validators = g_slist_prepend(validators, blob_read_validator(r));
+	}
+
+	for (GSList *p = patterns, *v = validators; p && v; p = g_slist_next(p), v = g_slist_next(v))
+	{
+		char const *pattern = p->data;
+		if (!pattern || !v->data)
+		{
+			validator_unref(v->data);
+			blob_reader_fail(r);
+		}
+		// The validator is released by the function on failure
+		else if (!object_pattern_properties_add(o, pattern, strlen(pattern), v->data))
+			blob_reader_fail(r);
+	}
+
+	g_slist_free_full(patterns, g_free);
+	g_slist_free(validators);
+	return o;
+}
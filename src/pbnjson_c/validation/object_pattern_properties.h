@@ -25,6 +25,9 @@
 extern "C" {
 #endif
 
+typedef struct _BlobWriter BlobWriter;
+typedef struct _BlobReader BlobReader;
+
 /** @brief Object patternProperties class */
 typedef struct _ObjectPatternProperties
 {
@@ -71,6 +74,15 @@ void object_pattern_properties_visit(ObjectPatternProperties *o,
                                      VisitorEnterFunc enter_func, VisitorExitFunc exit_func,
                                      void *ctxt);
 
+/** @brief Write the patterns with their validators into a precompiled schema. */
+void object_pattern_properties_serialize(ObjectPatternProperties *o, BlobWriter *w);
+
+/** @brief Restore the patterns written with object_pattern_properties_serialize().
+ *
+ * @return New object or NULL if there were no patterns.
+ */
+ObjectPatternProperties* object_pattern_properties_load(BlobReader *r);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -88,6 +88,16 @@ Validator* object_properties_lookup(ObjectProperties *o, char const *key)
 	return (Validator *) g_hash_table_lookup(o->keys, key);
 }
 
+Validator* object_properties_lookup_key(ObjectProperties *o, char const *key, char const **prop_key)
+{
+	assert(o && o->keys);
+
+	Validator *v = NULL;
+	if (!g_hash_table_lookup_extended(o->keys, key, (gpointer *) prop_key, (gpointer *) &v))
+		*prop_key = NULL;
+	return v;
+}
+
 Validator* object_properties_lookup_n(ObjectProperties *o, char const *key, size_t key_len)
 {
 	// lookup validator by key
@@ -118,9 +128,15 @@ void object_properties_visit(ObjectProperties *o,
 	}
 }
 
-GHashTable *object_properties_gather_default(ObjectProperties *o, ValidationState *s)
+static ObjectDefaults no_defaults = { .count = 0, .items = NULL, .index = NULL };
+
+ObjectDefaults *object_properties_collect_defaults(ObjectProperties *o, ValidationState *s)
 {
-	GHashTable *result = NULL;
+	// The list and its items go in a single allocation, trimmed at the end
+	size_t size = g_hash_table_size(o->keys);
+	ObjectDefaults *result = g_malloc(sizeof(ObjectDefaults) + size * sizeof(ObjectDefault));
+	ObjectDefault *items = (ObjectDefault *) (result + 1);
+	size_t count = 0;
 
 	GHashTableIter it;
 	g_hash_table_iter_init(&it, o->keys);
@@ -131,15 +147,37 @@ GHashTable *object_properties_gather_default(ObjectProperties *o, ValidationStat
 		jvalue_ref def_value = validator_get_default(v, s);
 		if (!def_value)
 			continue;
-		if (!result)
-		{
-			result = g_hash_table_new(g_str_hash, g_str_equal);
-		}
-		g_hash_table_insert(result, (gpointer) key, (gpointer) def_value);
+		items[count].key = key;
+		items[count].validator = v;
+		items[count].value = def_value;
+		++count;
 	}
+
+	if (!count)
+	{
+		g_free(result);
+		return &no_defaults;
+	}
+
+	result = g_realloc(result, sizeof(ObjectDefaults) + count * sizeof(ObjectDefault));
+	result->count = count;
+	result->items = (ObjectDefault *) (result + 1);
+
+	// The seen keys are marked by the key of the property, found with the validator
+	result->index = g_hash_table_new(g_direct_hash, g_direct_equal);
+	for (size_t i = 0; i < count; ++i)
+		g_hash_table_insert(result->index, (gpointer) result->items[i].key, GSIZE_TO_POINTER(i + 1));
 	return result;
 }
 
+void object_defaults_free(ObjectDefaults *d)
+{
+	if (d == &no_defaults)
+		return;
+	g_hash_table_destroy(d->index);
+	g_free(d);
+}
+
 bool object_properties_equals(ObjectProperties *o, ObjectProperties *other)
 {
 	if (o == other)
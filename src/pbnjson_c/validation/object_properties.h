@@ -27,6 +27,7 @@ extern "C" {
 
 typedef struct _UriResolver UriResolver;
 typedef struct _ValidationState ValidationState;
+typedef struct jvalue* jvalue_ref;
 
 /** @brief Object properties class */
 typedef struct _ObjectProperties
@@ -72,6 +73,9 @@ size_t object_properties_length(ObjectProperties *o);
 /** @brief Find the validator for a given NULL-terminated key. */
 Validator* object_properties_lookup(ObjectProperties *o, char const *key);
 
+/** @brief Find the validator and the property key owned by the properties (see ObjectDefaults::index) */
+Validator* object_properties_lookup_key(ObjectProperties *o, char const *key, char const **prop_key);
+
 /** @brief Find the validator for a given key. */
 Validator* object_properties_lookup_n(ObjectProperties *o, char const *key, size_t key_len);
 
@@ -80,11 +84,34 @@ void object_properties_visit(ObjectProperties *o,
                              VisitorEnterFunc enter_func, VisitorExitFunc exit_func,
                              void *ctxt);
 
-/** @brief Create hash table of the properties with default values.
+/** @brief Property with a default value */
+typedef struct _ObjectDefault
+{
+	char const *key;       /**< @brief Property key, owned by ObjectProperties */
+	Validator *validator;  /**< @brief Validator of the property, owned by ObjectProperties */
+	jvalue_ref value;      /**< @brief Default value, owned by the validator */
+} ObjectDefault;
+
+/** @brief List of the properties with default values */
+typedef struct _ObjectDefaults
+{
+	size_t count;          /**< @brief Count of the items */
+	ObjectDefault *items;  /**< @brief Properties with default values */
+	GHashTable *index;     /**< @brief Property key (by pointer) -> index of the item + 1 */
+} ObjectDefaults;
+
+/** @brief Collect the properties with default values.
+ *
+ * The list is meant to be computed once per schema, and then shared by all
+ * the validated instances.
  *
- * @return Hash table property key -> jvalue
+ * @return The list to be released with object_defaults_free(). Never NULL,
+ *         the list is empty if no property has a default value.
  */
-GHashTable *object_properties_gather_default(ObjectProperties *o, ValidationState *s);
+ObjectDefaults *object_properties_collect_defaults(ObjectProperties *o, ValidationState *s);
+
+/** @brief Release the list of the properties with default values */
+void object_defaults_free(ObjectDefaults *d);
 
 /** @brief Check if two ObjectProperties structures are equal. */
 bool object_properties_equals(ObjectProperties *o, ObjectProperties *other);
@@ -21,34 +21,86 @@
 #include "object_properties.h"
 #include "object_required.h"
 #include "object_pattern_properties.h"
+#include "schema_blob.h"
+#include "serialization_plan.h"
 #include <jobject.h>
 #include <string.h>
 #include <stdio.h>
 #include <glib.h>
 #include <assert.h>
 
+// Keys of the properties with defaults are tracked in a bitset. Small
+// schemas fit into the context, otherwise the words are allocated.
+#define SEEN_WORD_BITS 64
+
 typedef struct _MyContext
 {
 	bool has_started;   // Has an object been opened with "{"?
 	size_t required_count; // Count of required properties
 	size_t properties_count;
 
-	GHashTable *default_properties; // char const * -> jvalue_ref, doesn't own anything.
+	ObjectDefaults *defaults; // Shared by the validator, or NULL if defaults aren't tracked.
+	bool owns_defaults;       // The defaults were collected for this instance only
+	guint64 *seen;            // Bitset over defaults->items
+	guint64 seen_inline;
 	Validator *pattern_properties_validator;  // May be combined validator if multiple patternProperties matched.
 } MyContext;
 
+static ObjectDefaults *get_defaults(ObjectValidator *o, ValidationState *s, bool *owned)
+{
+	ObjectDefaults *defaults = g_atomic_pointer_get(&o->defaults);
+	if (defaults)
+		return defaults;
+
+	defaults = object_properties_collect_defaults(o->properties, s);
+
+	// The defaults behind unbound references may be missed, keep the list
+	// only once the validator has been linked.
+	*owned = !g_atomic_int_get(&o->linked);
+	if (*owned)
+		return defaults;
+
+	// Validators are shared between threads: the one, which publishes the
+	// list first, wins.
+	if (!g_atomic_pointer_compare_and_exchange(&o->defaults, NULL, defaults))
+	{
+		object_defaults_free(defaults);
+		defaults = g_atomic_pointer_get(&o->defaults);
+	}
+	return defaults;
+}
+
 static void prepare_default_properties(ObjectValidator *o, ValidationState *s, MyContext *my_ctxt)
 {
 	if (!o->properties ||
-	    !validation_state_have_default_properties(s) ||
-	    !o->default_properties_count)
+	    !validation_state_have_default_properties(s))
 	{
 		return;
 	}
 
-	GHashTable *defaults = object_properties_gather_default(o->properties, s);
-	o->default_properties_count = defaults ? g_hash_table_size(defaults) : 0;
-	my_ctxt->default_properties = defaults;
+	bool owned = false;
+	ObjectDefaults *defaults = get_defaults(o, s, &owned);
+	if (!defaults->count)
+	{
+		if (owned)
+			object_defaults_free(defaults);
+		return;
+	}
+
+	my_ctxt->defaults = defaults;
+	my_ctxt->owns_defaults = owned;
+	if (defaults->count <= SEEN_WORD_BITS)
+		my_ctxt->seen = &my_ctxt->seen_inline;
+	else
+		my_ctxt->seen = g_new0(guint64, (defaults->count + SEEN_WORD_BITS - 1) / SEEN_WORD_BITS);
+}
+
+static void mark_default_seen(MyContext *my_ctxt, char const *prop_key)
+{
+	size_t i = GPOINTER_TO_SIZE(g_hash_table_lookup(my_ctxt->defaults->index, prop_key));
+	if (!i--)
+		return;
+	my_ctxt->seen[i / SEEN_WORD_BITS] |= ((guint64) 1) << (i % SEEN_WORD_BITS);
 }
 
 static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, void *ctxt)
@@ -91,16 +143,16 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 		}
 
 		// Issue the default properties not seen before.
-		if (my_ctxt->default_properties && g_hash_table_size(my_ctxt->default_properties))
+		if (my_ctxt->defaults)
 		{
 			assert(validation_state_have_default_properties(s));
-			GHashTableIter it;
-			g_hash_table_iter_init(&it, my_ctxt->default_properties);
-			char const *key = NULL;
-			jvalue_ref value = NULL;
-			while (g_hash_table_iter_next(&it, (gpointer *) &key, (gpointer *) &value))
+			ObjectDefaults *defaults = my_ctxt->defaults;
+			for (size_t i = 0; i < defaults->count; ++i)
 			{
-				if (!validation_state_issue_default_property(s, key, value, ctxt))
+				if (my_ctxt->seen[i / SEEN_WORD_BITS] & (((guint64) 1) << (i % SEEN_WORD_BITS)))
+					continue;
+				if (!validation_state_issue_default_property(s, defaults->items[i].key,
+				                                             defaults->items[i].value, ctxt))
 					return false;
 			}
 		}
@@ -128,20 +180,19 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 		return false;
 	}
 
-	// Since the key has been seen, don't expect it among defaults.
-	if (my_ctxt->default_properties)
-	{
-		g_hash_table_remove(my_ctxt->default_properties, key);
-	}
-
 	// lookup validator by key
 	// if not found, use generic validator
 	Validator *child = NULL;
+	char const *prop_key = NULL;
 	if (vobj->properties)
-		child = object_properties_lookup(vobj->properties, key);
+		child = object_properties_lookup_key(vobj->properties, key, &prop_key);
 
 	if (child)
 	{
+		// Since the key has been seen, don't expect it among defaults.
+		if (my_ctxt->defaults)
+			mark_default_seen(my_ctxt, prop_key);
+
 		validation_state_push_validator(s, child);
 		return true;
 	}
@@ -169,6 +220,11 @@ static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, v
 	return false;
 }
 
+static bool may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	return e->type == EV_OBJ_START;
+}
+
 static bool check_generic(Validator *v, ValidationEvent const *e, ValidationState *s, void *ctxt)
 {
 	// depth is used to track when current and all nested objects are closed
@@ -227,8 +283,10 @@ static void _cleanup_state(Validator *v, ValidationState *s)
 {
 	MyContext *my_ctxt = validation_state_pop_context(s);
 	assert(my_ctxt);
-	if (my_ctxt->default_properties)
-		g_hash_table_destroy(my_ctxt->default_properties);
+	if (my_ctxt->seen != &my_ctxt->seen_inline)
+		g_free(my_ctxt->seen);
+	if (my_ctxt->owns_defaults)
+		object_defaults_free(my_ctxt->defaults);
 	validator_unref(my_ctxt->pattern_properties_validator);
 	g_slice_free(MyContext, my_ctxt);
 }
@@ -236,21 +294,29 @@ static void _cleanup_state(Validator *v, ValidationState *s)
 static Validator* ref(Validator *validator)
 {
 	ObjectValidator *v = (ObjectValidator *) validator;
-	++v->ref_count;
+	g_atomic_int_inc(&v->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	ObjectValidator *v = (ObjectValidator *) validator;
-	if (--v->ref_count)
+	if (!g_atomic_int_dec_and_test(&v->ref_count))
 		return;
 	object_validator_release(v);
 }
 
+static void drop_defaults(ObjectValidator *o)
+{
+	ObjectDefaults *defaults = g_atomic_pointer_get(&o->defaults);
+	if (defaults && g_atomic_pointer_compare_and_exchange(&o->defaults, defaults, NULL))
+		object_defaults_free(defaults);
+}
+
 static Validator* set_properties(Validator *v, ObjectProperties *p)
 {
 	ObjectValidator *o = (ObjectValidator *) v;
+	drop_defaults(o);
 	if (o->properties)
 		object_properties_unref(o->properties);
 	o->properties = object_properties_ref(p);
@@ -396,9 +462,103 @@ static bool equals(Validator *v, Validator *other)
 	return false;
 }
 
+static bool serialize(Validator *v, BlobWriter *w)
+{
+	ObjectValidator *o = (ObjectValidator *) v;
+	blob_write_tag(w, BLOB_OBJECT);
+
+	blob_write_int(w, o->properties ? object_properties_length(o->properties) : -1);
+	if (o->properties)
+	{
+		GHashTableIter it;
+		g_hash_table_iter_init(&it, o->properties->keys);
+		char const *key = NULL;
+		Validator *prop = NULL;
+		while (g_hash_table_iter_next(&it, (gpointer *) &key, (gpointer *) &prop))
+		{
+			blob_write_string(w, key);
+			blob_write_validator(w, prop);
+		}
+	}
+
+	blob_write_validator(w, o->additional_properties);
+
+	blob_write_int(w, o->required ? object_required_size(o->required) : -1);
+	if (o->required)
+	{
+		GHashTableIter it;
+		g_hash_table_iter_init(&it, o->required->keys);
+		char const *key = NULL;
+		while (g_hash_table_iter_next(&it, (gpointer *) &key, NULL))
+			blob_write_string(w, key);
+	}
+
+	blob_write_int(w, o->max_properties);
+	blob_write_int(w, o->min_properties);
+	object_pattern_properties_serialize(o->pattern_properties, w);
+	blob_write_jvalue(w, o->def_value);
+	return true;
+}
+
+static bool serialize_generic(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_OBJECT_GENERIC);
+	return true;
+}
+
+static void _link_exit(char const *key, Validator *v, void *ctxt, Validator **new_v)
+{
+	// The properties are bound now, their defaults may be collected once and for all.
+	// The list is kept until the validator is destroyed.
+	g_atomic_int_set(&((ObjectValidator *) v)->linked, 1);
+}
+
+static void collect_tags(Validator *v, ValidatorTagFunc func, void *ctxt)
+{
+	ObjectValidator *o = (ObjectValidator *) v;
+	if (!o->required || !o->properties)
+		return;
+
+	GHashTableIter it;
+	gpointer name;
+	g_hash_table_iter_init(&it, o->required->keys);
+	while (g_hash_table_iter_next(&it, &name, NULL))
+	{
+		Validator *child = object_properties_lookup(o->properties, name);
+		if (!child)
+			continue;
+		Validator *target = validator_get_target(child);
+		char *value_key = validator_get_value_key(target ? target : child);
+		if (value_key)
+			func(name, value_key, ctxt);
+	}
+}
+
+static PlanNode* compile_plan(Validator *v, PlanBuilder *b)
+{
+	ObjectValidator *o = (ObjectValidator *) v;
+	PlanNode *n = plan_node_new(b, v, PLAN_OBJECT);
+	if (!o->properties)
+		return n;
+
+	// Additional and pattern properties are left to the generic serializer
+	GHashTableIter it;
+	gpointer key, value;
+	g_hash_table_iter_init(&it, o->properties->keys);
+	while (g_hash_table_iter_next(&it, &key, &value))
+		plan_node_add_property(n, key, strlen(key), plan_compile(b, value));
+	return n;
+}
+
+static PlanNode* compile_plan_generic(Validator *v, PlanBuilder *b)
+{
+	return plan_node_new(b, v, PLAN_OBJECT);
+}
+
 static ValidatorVtable generic_object_vtable =
 {
 	.check = check_generic,
+	.may_accept = may_accept,
 	.init_state = init_state_generic,
 	.cleanup_state = cleanup_state_generic,
 	.set_object_properties = set_properties_generic,
@@ -410,11 +570,14 @@ static ValidatorVtable generic_object_vtable =
 	.set_default = set_default_generic,
 	.dump_enter = dump_enter,
 	.dump_exit = dump_exit,
+	.serialize = serialize_generic,
+	.compile_plan = compile_plan_generic,
 };
 
 ValidatorVtable object_vtable =
 {
 	.check = _check,
+	.may_accept = may_accept,
 	.equals = equals,
 	.init_state = _init_state,
 	.cleanup_state = _cleanup_state,
@@ -431,6 +594,10 @@ ValidatorVtable object_vtable =
 	.visit = _visit,
 	.dump_enter = dump_enter,
 	.dump_exit = dump_exit,
+	.link_exit = _link_exit,
+	.collect_tags = collect_tags,
+	.serialize = serialize,
+	.compile_plan = compile_plan,
 };
 
 ObjectValidator* object_validator_new(void)
@@ -439,7 +606,6 @@ ObjectValidator* object_validator_new(void)
 	self->ref_count = 1;
 	self->max_properties = -1;
 	self->min_properties = -1;
-	self->default_properties_count = -1;
 	validator_init(&self->base, &object_vtable);
 	self->additional_properties = GENERIC_VALIDATOR;
 	return self;
@@ -448,6 +614,7 @@ ObjectValidator* object_validator_new(void)
 void object_validator_release(ObjectValidator *v)
 {
 	object_properties_unref(v->properties);
+	drop_defaults(v);
 	validator_unref(v->additional_properties);
 	object_required_unref(v->required);
 	object_pattern_properties_unref(v->pattern_properties);
@@ -465,6 +632,51 @@ void object_validator_set_min_properties(ObjectValidator *o, size_t min)
 	o->min_properties = min;
 }
 
+Validator* object_validator_load(BlobReader *r)
+{
+	ObjectValidator *o = object_validator_new();
+
+	int count = blob_read_int(r);
+	if (count >= 0)
+	{
+		o->properties = object_properties_new();
+		for (int i = 0; i < count && blob_reader_ok(r); ++i)
+		{
+			char *key = blob_read_string(r);
+			Validator *prop = blob_read_validator(r);
+			if (key && prop)
+				object_properties_add_key(o->properties, key, prop);
+			else
+			{
+				validator_unref(prop);
+				blob_reader_fail(r);
+			}
+			g_free(key);
+		}
+	}
+
+	validator_unref(o->additional_properties);
+	o->additional_properties = blob_read_validator(r);
+
+	count = blob_read_int(r);
+	if (count >= 0)
+	{
+		o->required = object_required_new();
+		for (int i = 0; i < count && blob_reader_ok(r); ++i)
+		{
+			char *key = blob_read_string(r);
+			if (!key || !object_required_add_key(o->required, key))
+				blob_reader_fail(r);
+			g_free(key);
+		}
+	}
+
+	o->max_properties = blob_read_int(r);
+	o->min_properties = blob_read_int(r);
+	o->pattern_properties = object_pattern_properties_load(r);
+	return &o->base;
+}
+
 static Validator OBJECT_VALIDATOR_IMPL =
 {
 	.vtable = &generic_object_vtable,
@@ -23,8 +23,11 @@
 extern "C" {
 #endif
 
+typedef struct _BlobReader BlobReader;
+
 typedef struct _ObjectProperties ObjectProperties;
 typedef struct _ObjectRequired ObjectRequired;
+typedef struct _ObjectDefaults ObjectDefaults;
 
 /**
  * Object validator for {"type": "object"}
@@ -34,7 +37,7 @@ typedef struct _ObjectValidator
 	/** @brief Base class is Validator */
 	Validator base;
 	/** @brief Reference count */
-	unsigned ref_count;
+	int ref_count;
 	/** @brief Default value attached to this validator */
 	jvalue_ref def_value;
 
@@ -51,13 +54,16 @@ typedef struct _ObjectValidator
 	/** @brief Pattern properties described by "patternProperties" */
 	ObjectPatternProperties *pattern_properties;
 
-	/** @brief Count of properties, which have default value.
+	/** @brief Properties, which have default value, or NULL until known.
 	 *
 	 * Default values are contained by the validators in the properties.
-	 * We count them before the main work to decide if properties with
-	 * defaults should be tracked at all.
+	 * The list is collected when the first instance is validated after
+	 * linking, and then shared by all the instances, which only track the
+	 * seen keys. Before linking every instance collects its own list.
 	 */
-	int default_properties_count;
+	ObjectDefaults *defaults;
+
+	int linked;              /**< @brief Set once the properties are linked, see validator_link() */
 } ObjectValidator;
 
 //_Static_assert(offsetof(GenericValidator, base) == 0, "");
@@ -71,6 +77,9 @@ ObjectValidator* object_validator_new(void);
 /** @brief Destroy object validator. */
 void object_validator_release(ObjectValidator *v);
 
+/** @brief Restore the validator from a precompiled schema, see schema_blob.h */
+Validator* object_validator_load(BlobReader *r);
+
 /** @brief Set maximal count of properties. */
 void object_validator_set_max_properties(ObjectValidator *o, size_t max);
 
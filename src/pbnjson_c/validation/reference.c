@@ -19,6 +19,8 @@
 #include "validation_state.h"
 #include "uri_resolver.h"
 #include "uri_scope.h"
+#include "schema_blob.h"
+#include "serialization_plan.h"
 #include <jobject.h>
 #include <glib.h>
 #include <assert.h>
@@ -28,14 +30,14 @@
 static Validator* ref(Validator *v)
 {
 	Reference *r = (Reference *) v;
-	++r->ref_count;
+	g_atomic_int_inc(&r->ref_count);
 	return v;
 }
 
 static void unref(Validator *v)
 {
 	Reference *r = (Reference *) v;
-	if (--r->ref_count)
+	if (!g_atomic_int_dec_and_test(&r->ref_count))
 		return;
 	j_release(&r->def_value);
 	g_free(r->target);
@@ -88,6 +90,29 @@ static bool _init_state(Validator *v, ValidationState *s)
 	return true;
 }
 
+static bool _may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	Reference *r = (Reference *) v;
+	// The references are bound by linking (see validator_link()). Unbound one
+	// is resolved and reported by _init_state(), the schema isn't modified here.
+	if (!r->validator)
+		return true;
+
+	// Recursive schemas can bring us here again, be optimistic then.
+	if (g_slist_find(s->probing, r))
+		return true;
+	GSList probing = { .data = r, .next = s->probing };
+	s->probing = &probing;
+	bool res = validator_may_accept(r->validator, e, s);
+	s->probing = probing.next;
+	return res;
+}
+
+static Validator* _get_target(Validator *v)
+{
+	return ((Reference *) v)->validator;
+}
+
 static void _reactivate(Validator *v, ValidationState *s)
 {
 	validation_state_pop_validator(s);
@@ -138,6 +163,21 @@ static void _collect_uri_exit(char const *key, Validator *v, void *ctxt, Validat
 	//UriScope *uri_scope = (UriScope *) ctxt;
 }
 
+static void _link(char const *key, Validator *v, void *ctxt)
+{
+	Reference *r = (Reference *) v;
+	LinkContext *link = (LinkContext *) ctxt;
+
+	if (!r->validator && r->document)
+		r->validator = uri_resolver_lookup_validator(link->uri_resolver,
+		                                             r->document, r->fragment);
+	if (!r->validator)
+	{
+		fprintf(stderr, "Can't resolve %s %s\n", r->document, r->fragment);
+		link->failed = true;
+	}
+}
+
 static bool _check(Validator *v, ValidationEvent const *e, ValidationState *s, void *ctxt)
 {
 	Reference *r = (Reference *) v;
@@ -161,6 +201,23 @@ static void _dump_enter(char const *key, Validator *v, void *ctxt)
 		fprintf((FILE *) ctxt, "($%s %s)", r->document, r->fragment);
 }
 
+static bool _serialize(Validator *v, BlobWriter *w)
+{
+	Reference *r = (Reference *) v;
+	blob_write_tag(w, BLOB_REFERENCE);
+	blob_write_string(w, r->target);
+	blob_write_string(w, r->document);
+	blob_write_string(w, r->fragment);
+	blob_write_jvalue(w, r->def_value);
+	return true;
+}
+
+static PlanNode* _compile_plan(Validator *v, PlanBuilder *b)
+{
+	Reference *r = (Reference *) v;
+	return plan_compile(b, r->validator);
+}
+
 static ValidatorVtable reference_vtable =
 {
 	.ref = ref,
@@ -170,10 +227,15 @@ static ValidatorVtable reference_vtable =
 	.init_state = _init_state,
 	.reactivate = _reactivate,
 	.check = _check,
+	.may_accept = _may_accept,
+	.get_target = _get_target,
 	.collect_uri_enter = _collect_uri_enter,
 	.collect_schemas = _collect_schemas,
 	.collect_uri_exit = _collect_uri_exit,
+	.link = _link,
 	.dump_enter = _dump_enter,
+	.serialize = _serialize,
+	.compile_plan = _compile_plan,
 };
 
 Reference *reference_new(void)
@@ -197,6 +259,16 @@ void reference_unref(Reference *r)
 		validator_unref(&r->base);
 }
 
+Validator* reference_load(BlobReader *r)
+{
+	Reference *ref = reference_new();
+	ref->target = blob_read_string(r);
+	ref->document = blob_read_string(r);
+	ref->fragment = blob_read_string(r);
+	// The target validator is looked up on the first use
+	return &ref->base;
+}
+
 void reference_set_target(Reference *r, StringSpan *target)
 {
 	assert(r);
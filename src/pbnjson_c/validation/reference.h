@@ -22,13 +22,15 @@
 extern "C" {
 #endif
 
+typedef struct _BlobReader BlobReader;
+
 typedef struct _StringSpan StringSpan;
 
 /** @brief Reference validator class */
 typedef struct _Reference
 {
 	Validator base;        /**< @brief Base class */
-	unsigned ref_count;    /**< @brief Reference count */
+	int ref_count;         /**< @brief Reference count */
 	jvalue_ref def_value;  /**< @brief Default value attached to this validator */
 
 	char *target;          /**< @brief Original parsed value like "other.json#/definitions/a" */
@@ -47,6 +49,9 @@ Reference *reference_ref(Reference *r);
 /** @brief Decrement reference counter. Once it drops to zero, the object is destructed. */
 void reference_unref(Reference *r);
 
+/** @brief Restore the validator from a precompiled schema, see schema_blob.h */
+Validator* reference_load(BlobReader *r);
+
 /** @brief Remember target from the parser. */
 void reference_set_target(Reference *r, StringSpan *target);
 
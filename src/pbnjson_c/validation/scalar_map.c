@@ -0,0 +1,178 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "scalar_map.h"
+#include "number.h"
+#include <string.h>
+
+/* Canonical keys are C strings starting with the type tag (see
+ * validation_event_get_value_key()). Events are looked up in the same hash
+ * table through a probe, which is told apart from the keys by its first byte.
+ * Integer numbers are kept in a separate table by their values instead.
+ */
+#define PROBE_MARKER '\1'
+
+typedef struct _ScalarProbe
+{
+	char marker;              /**< @brief Always PROBE_MARKER */
+	char tag;                 /**< @brief Type tag of the canonical key */
+	char const *str;          /**< @brief The rest of the canonical key, not terminated */
+	size_t len;               /**< @brief Length of the rest of the key */
+} ScalarProbe;
+
+struct _ScalarMap
+{
+	GHashTable *keys;         /**< @brief Canonical key or probe -> data */
+	GHashTable *integers;     /**< @brief Integer number (gint64) -> data */
+};
+
+static inline guint hash_step(guint h, char c)
+{
+	return (h << 5) + h + (unsigned char) c;
+}
+
+static guint key_hash(gconstpointer key)
+{
+	char const *k = key;
+	guint h = 5381;
+	if (*k == PROBE_MARKER)
+	{
+		ScalarProbe const *probe = key;
+		h = hash_step(h, probe->tag);
+		for (size_t i = 0; i < probe->len; ++i)
+			h = hash_step(h, probe->str[i]);
+		return h;
+	}
+	for (; *k; ++k)
+		h = hash_step(h, *k);
+	return h;
+}
+
+static gboolean key_equal(gconstpointer a, gconstpointer b)
+{
+	char const *ka = a, *kb = b;
+	if (*kb == PROBE_MARKER)
+	{
+		char const *swap = ka;
+		ka = kb;
+		kb = swap;
+	}
+	if (*ka != PROBE_MARKER)
+		return strcmp(ka, kb) == 0;
+
+	// The probe never contains zeros, see scalar_map_lookup_event()
+	ScalarProbe const *probe = (ScalarProbe const *) ka;
+	return kb[0] == probe->tag &&
+	       strncmp(kb + 1, probe->str, probe->len) == 0 &&
+	       kb[probe->len + 1] == '\0';
+}
+
+// Number keys are "d", the digits of the mantissa with radix point before them, "e", exponent
+static bool key_get_int64(char const *key, int64_t *value)
+{
+	if (key[0] != 'd')
+		return false;
+
+	char const *digits = key + 1;
+	bool negative = *digits == '-';
+	if (negative)
+		++digits;
+	char const *exponent = strchr(digits, 'e');
+	if (!exponent)
+		return false;
+
+	char *text = g_strdup_printf("%s0.%.*se%s", negative ? "-" : "",
+	                             (int) (exponent - digits), digits, exponent + 1);
+	bool res = number_text_get_int64(text, strlen(text), value);
+	g_free(text);
+	return res;
+}
+
+ScalarMap* scalar_map_new(GDestroyNotify data_destroy)
+{
+	ScalarMap *m = g_new0(ScalarMap, 1);
+	m->keys = g_hash_table_new_full(key_hash, key_equal, g_free, data_destroy);
+	m->integers = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, data_destroy);
+	return m;
+}
+
+void scalar_map_free(ScalarMap *m)
+{
+	if (!m)
+		return;
+	g_hash_table_destroy(m->keys);
+	g_hash_table_destroy(m->integers);
+	g_free(m);
+}
+
+void scalar_map_insert(ScalarMap *m, char *key, gpointer data)
+{
+	gint64 integer;
+	if (key_get_int64(key, &integer))
+	{
+		g_free(key);
+		gint64 *stored = g_new(gint64, 1);
+		*stored = integer;
+		g_hash_table_insert(m->integers, stored, data);
+	}
+	else
+		g_hash_table_insert(m->keys, key, data);
+}
+
+bool scalar_map_lookup_key(ScalarMap const *m, char const *key, gpointer *data)
+{
+	gint64 integer;
+	if (key_get_int64(key, &integer))
+		return g_hash_table_lookup_extended(m->integers, &integer, NULL, data);
+	return g_hash_table_lookup_extended(m->keys, key, NULL, data);
+}
+
+bool scalar_map_lookup_event(ScalarMap const *m, ValidationEvent const *e, gpointer *data)
+{
+	ScalarProbe probe = { .marker = PROBE_MARKER, .str = "" };
+	switch (e->type)
+	{
+	case EV_NULL:
+		probe.tag = 'n';
+		break;
+	case EV_BOOL:
+		probe.tag = e->value.boolean ? 't' : 'f';
+		break;
+	case EV_STR:
+		// Keys are C strings, no expected value contains '\0'
+		if (memchr(e->value.string.ptr, 0, e->value.string.len))
+			return false;
+		probe.tag = 's';
+		probe.str = e->value.string.ptr;
+		probe.len = e->value.string.len;
+		break;
+	case EV_NUM:
+	{
+		gint64 integer;
+		if (validation_event_get_int64(e, &integer))
+			return g_hash_table_lookup_extended(m->integers, &integer, NULL, data);
+
+		// Rare in enums, and may be rounded to an integer by GMP
+		char *key = validation_event_get_value_key(e);
+		bool res = key && scalar_map_lookup_key(m, key, data);
+		g_free(key);
+		return res;
+	}
+	default:
+		return false;
+	}
+	return g_hash_table_lookup_extended(m->keys, &probe, NULL, data);
+}
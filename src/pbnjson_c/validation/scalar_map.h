@@ -0,0 +1,73 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "validation_event.h"
+#include <stdbool.h>
+#include <glib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Map from constant scalar values to arbitrary data
+ *
+ * The values are added by their canonical keys (see validator_get_value_key()),
+ * and looked up by validation events. Strings, nulls, booleans and integer
+ * numbers are looked up without allocations: the event is hashed and compared
+ * as it is. Other numbers are canonicalized through GMP first.
+ */
+typedef struct _ScalarMap ScalarMap;
+
+/** @brief Constructor
+ *
+ * @param[in] data_destroy Function to release the data, may be NULL
+ */
+ScalarMap* scalar_map_new(GDestroyNotify data_destroy);
+
+/** @brief Destructor */
+void scalar_map_free(ScalarMap *m);
+
+/** @brief Add the value to the map, or replace its data
+ *
+ * @param[in] m This map
+ * @param[in] key Canonical key of the value, the map takes ownership of it
+ * @param[in] data Data to associate with the value
+ */
+void scalar_map_insert(ScalarMap *m, char *key, gpointer data);
+
+/** @brief Look up the value by its canonical key
+ *
+ * @param[in] m This map
+ * @param[in] key Canonical key of the value
+ * @param[out] data The data of the value (may be NULL)
+ * @return true if the value is in the map
+ */
+bool scalar_map_lookup_key(ScalarMap const *m, char const *key, gpointer *data);
+
+/** @brief Look up the value of the event
+ *
+ * @param[in] m This map
+ * @param[in] e Event of null, boolean, number or string
+ * @param[out] data The data of the value (may be NULL)
+ * @return true if the value is in the map
+ */
+bool scalar_map_lookup_event(ScalarMap const *m, ValidationEvent const *e, gpointer *data);
+
+#ifdef __cplusplus
+}
+#endif
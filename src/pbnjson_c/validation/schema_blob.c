@@ -0,0 +1,497 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "schema_blob.h"
+#include "validator.h"
+#include "uri_resolver.h"
+#include "number.h"
+#include "null_validator.h"
+#include "boolean_validator.h"
+#include "number_validator.h"
+#include "string_validator.h"
+#include "array_validator.h"
+#include "object_validator.h"
+#include "generic_validator.h"
+#include "combined_validator.h"
+#include "combined_types_validator.h"
+#include "reference.h"
+#include "everything_validator.h"
+#include "nothing_validator.h"
+#include <jobject.h>
+#include <jparse_stream.h>
+#include <jvalue_stringify.h>
+#include <assert.h>
+#include <string.h>
+
+// Layout of the blob (native byte order, the blob isn't portable between architectures):
+//
+//   header:     magic, version, byte order mark, count of validators
+//   validators: tag + payload for every validator, children always precede parents
+//   root:       index of the root validator
+//   documents:  count, then (document, count, (fragment, index)...)...
+//
+// Validators refer to each other by indices, so that shared subschemas
+// are restored as shared.
+
+#define BLOB_MAGIC "PBNJSCB"
+#define BLOB_VERSION 1
+#define BLOB_BYTE_ORDER 0x01020304
+#define BLOB_NONE UINT32_MAX
+
+typedef struct _BlobHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint32_t count;
+} BlobHeader;
+
+struct _BlobWriter
+{
+	GByteArray *nodes;     // Serialized validators in the order of their indices
+	GByteArray *current;   // Record being written at the moment
+	GHashTable *indices;   // Validator * -> index + 1, 0 while the validator is being written
+	uint32_t count;        // Count of validators written
+	bool failed;
+};
+
+struct _BlobReader
+{
+	char const *pos;
+	char const *end;
+	GPtrArray *nodes;      // Validators restored so far, the array holds references
+	bool failed;
+};
+
+static void _write(BlobWriter *w, void const *data, size_t len)
+{
+	g_byte_array_append(w->current, data, len);
+}
+
+static void _write_u32(BlobWriter *w, uint32_t value)
+{
+	_write(w, &value, sizeof(value));
+}
+
+void blob_write_tag(BlobWriter *w, BlobTag tag)
+{
+	uint8_t value = tag;
+	_write(w, &value, sizeof(value));
+}
+
+void blob_write_int(BlobWriter *w, int value)
+{
+	int32_t v = value;
+	_write(w, &v, sizeof(v));
+}
+
+void blob_write_bool(BlobWriter *w, bool value)
+{
+	uint8_t v = value;
+	_write(w, &v, sizeof(v));
+}
+
+static void _write_string_n(BlobWriter *w, char const *str, size_t len)
+{
+	_write_u32(w, len);
+	_write(w, str, len);
+}
+
+void blob_write_string(BlobWriter *w, char const *str)
+{
+	if (!str)
+		_write_u32(w, BLOB_NONE);
+	else
+		_write_string_n(w, str, strlen(str));
+}
+
+void blob_write_number(BlobWriter *w, Number const *n)
+{
+	char *str = number_get_string(n);
+	blob_write_string(w, str);
+	g_free(str);
+}
+
+static bool _append_output(void *ctxt, const char *data, size_t len)
+{
+	g_string_append_len((GString *) ctxt, data, len);
+	return true;
+}
+
+void blob_write_jvalue(BlobWriter *w, jvalue_ref value)
+{
+	if (!value)
+	{
+		_write_u32(w, BLOB_NONE);
+		return;
+	}
+
+	GString *str = g_string_new(NULL);
+	if (!jvalue_stringify_sink(value, _append_output, str))
+	{
+		w->failed = true;
+		g_string_assign(str, "null");
+	}
+	blob_write_string(w, str->str);
+	g_string_free(str, TRUE);
+}
+
+void blob_write_validator(BlobWriter *w, Validator *v)
+{
+	if (!v)
+	{
+		_write_u32(w, BLOB_NONE);
+		return;
+	}
+
+	gpointer index = NULL;
+	if (g_hash_table_lookup_extended(w->indices, v, NULL, &index))
+	{
+		// A validator can't contain itself directly, only through references.
+		if (!index)
+			w->failed = true;
+		_write_u32(w, GPOINTER_TO_UINT(index) - 1);
+		return;
+	}
+
+	g_hash_table_insert(w->indices, v, NULL);
+
+	GByteArray *parent = w->current;
+	w->current = g_byte_array_new();
+	if (!validator_serialize(v, w))
+		w->failed = true;
+	g_byte_array_append(w->nodes, w->current->data, w->current->len);
+	g_byte_array_free(w->current, TRUE);
+	w->current = parent;
+
+	uint32_t new_index = w->count++;
+	g_hash_table_insert(w->indices, v, GUINT_TO_POINTER(new_index + 1));
+	_write_u32(w, new_index);
+}
+
+GByteArray *schema_blob_write(Validator *v, UriResolver *u)
+{
+	BlobWriter w =
+	{
+		.nodes = g_byte_array_new(),
+		.current = g_byte_array_new(),
+		.indices = g_hash_table_new(g_direct_hash, g_direct_equal),
+	};
+
+	blob_write_validator(&w, v);
+
+	_write_u32(&w, u ? g_hash_table_size(u->documents) : 0);
+	if (u)
+	{
+		GHashTableIter it;
+		g_hash_table_iter_init(&it, u->documents);
+		char const *document = NULL;
+		GHashTable *fragments = NULL;
+		while (g_hash_table_iter_next(&it, (gpointer *) &document, (gpointer *) &fragments))
+		{
+			blob_write_string(&w, document);
+			_write_u32(&w, fragments ? g_hash_table_size(fragments) : 0);
+			if (!fragments)
+				continue;
+
+			GHashTableIter it2;
+			g_hash_table_iter_init(&it2, fragments);
+			char const *fragment = NULL;
+			Validator *fv = NULL;
+			while (g_hash_table_iter_next(&it2, (gpointer *) &fragment, (gpointer *) &fv))
+			{
+				blob_write_string(&w, fragment);
+				blob_write_validator(&w, fv);
+			}
+		}
+	}
+
+	GByteArray *res = NULL;
+	if (!w.failed)
+	{
+		BlobHeader header =
+		{
+			.magic = BLOB_MAGIC,
+			.version = BLOB_VERSION,
+			.byte_order = BLOB_BYTE_ORDER,
+			.count = w.count,
+		};
+		res = g_byte_array_sized_new(sizeof(header) + w.nodes->len + w.current->len);
+		g_byte_array_append(res, (guint8 const *) &header, sizeof(header));
+		g_byte_array_append(res, w.nodes->data, w.nodes->len);
+		g_byte_array_append(res, w.current->data, w.current->len);
+	}
+
+	g_hash_table_destroy(w.indices);
+	g_byte_array_free(w.current, TRUE);
+	g_byte_array_free(w.nodes, TRUE);
+	return res;
+}
+
+void blob_reader_fail(BlobReader *r)
+{
+	r->failed = true;
+	r->pos = r->end;
+}
+
+bool blob_reader_ok(BlobReader *r)
+{
+	return !r->failed;
+}
+
+static bool _read(BlobReader *r, void *data, size_t len)
+{
+	if ((size_t) (r->end - r->pos) < len)
+	{
+		blob_reader_fail(r);
+		memset(data, 0, len);
+		return false;
+	}
+	memcpy(data, r->pos, len);
+	r->pos += len;
+	return true;
+}
+
+static uint32_t _read_u32(BlobReader *r)
+{
+	uint32_t value;
+	_read(r, &value, sizeof(value));
+	return value;
+}
+
+static BlobTag _read_tag(BlobReader *r)
+{
+	uint8_t value;
+	_read(r, &value, sizeof(value));
+	return value;
+}
+
+int blob_read_int(BlobReader *r)
+{
+	int32_t value;
+	_read(r, &value, sizeof(value));
+	return value;
+}
+
+bool blob_read_bool(BlobReader *r)
+{
+	uint8_t value;
+	_read(r, &value, sizeof(value));
+	return value;
+}
+
+// The string isn't null-terminated, it points into the blob.
+static char const *_read_string_n(BlobReader *r, size_t *len)
+{
+	uint32_t length = _read_u32(r);
+	if (length == BLOB_NONE || r->failed)
+		return NULL;
+	if ((size_t) (r->end - r->pos) < length)
+	{
+		blob_reader_fail(r);
+		return NULL;
+	}
+	char const *str = r->pos;
+	r->pos += length;
+	*len = length;
+	return str;
+}
+
+char *blob_read_string(BlobReader *r)
+{
+	size_t len = 0;
+	char const *str = _read_string_n(r, &len);
+	return str ? g_strndup(str, len) : NULL;
+}
+
+bool blob_read_number(BlobReader *r, Number *n)
+{
+	size_t len = 0;
+	char const *str = _read_string_n(r, &len);
+	if (!str || number_set_n(n, str, len))
+	{
+		blob_reader_fail(r);
+		return false;
+	}
+	return true;
+}
+
+jvalue_ref blob_read_jvalue(BlobReader *r)
+{
+	size_t len = 0;
+	char const *str = _read_string_n(r, &len);
+	if (!str)
+		return NULL;
+
+	jvalue_ref value = jdom_create(j_str_to_buffer(str, len), jschema_all(), NULL);
+	if (!jis_valid(value))
+	{
+		blob_reader_fail(r);
+		return NULL;
+	}
+	return value;
+}
+
+Validator *blob_read_validator(BlobReader *r)
+{
+	uint32_t index = _read_u32(r);
+	if (index == BLOB_NONE || r->failed)
+		return NULL;
+	if (index >= r->nodes->len)
+	{
+		blob_reader_fail(r);
+		return NULL;
+	}
+	return validator_ref(g_ptr_array_index(r->nodes, index));
+}
+
+static Validator *_load_default(BlobReader *r, Validator *v)
+{
+	if (!v)
+		return NULL;
+
+	jvalue_ref def_value = blob_read_jvalue(r);
+	if (def_value)
+	{
+		v = validator_set_default(v, def_value);
+		j_release(&def_value);
+	}
+	return v;
+}
+
+static Validator *_load_validator(BlobReader *r)
+{
+	switch (_read_tag(r))
+	{
+	case BLOB_NULL_GENERIC:
+		return null_validator_instance();
+	case BLOB_NULL:
+		return _load_default(r, &null_validator_new()->base);
+	case BLOB_BOOLEAN_GENERIC:
+		return boolean_validator_instance();
+	case BLOB_BOOLEAN_TRUE:
+		return boolean_validator_new_with_value(true);
+	case BLOB_BOOLEAN_FALSE:
+		return boolean_validator_new_with_value(false);
+	case BLOB_BOOLEAN:
+		return _load_default(r, &boolean_validator_new()->base);
+	case BLOB_NUMBER_GENERIC:
+		return number_validator_instance();
+	case BLOB_INTEGER_GENERIC:
+		return integer_validator_instance();
+	case BLOB_NUMBER:
+		return _load_default(r, number_validator_load(r));
+	case BLOB_STRING_GENERIC:
+		return string_validator_instance();
+	case BLOB_STRING:
+		return _load_default(r, string_validator_load(r));
+	case BLOB_ARRAY_GENERIC:
+		return array_validator_instance();
+	case BLOB_ARRAY:
+		return _load_default(r, array_validator_load(r));
+	case BLOB_OBJECT_GENERIC:
+		return object_validator_instance();
+	case BLOB_OBJECT:
+		return _load_default(r, object_validator_load(r));
+	case BLOB_GENERIC_STATIC:
+		return generic_validator_instance();
+	case BLOB_GENERIC_INVERSE:
+		return inverse_generic_validator_instance();
+	case BLOB_GENERIC:
+		return _load_default(r, &generic_validator_new()->base);
+	case BLOB_COMBINED:
+		return _load_default(r, combined_validator_load(r));
+	case BLOB_COMBINED_TYPES:
+		return _load_default(r, combined_types_validator_load(r));
+	case BLOB_REFERENCE:
+		return _load_default(r, reference_load(r));
+	case BLOB_EVERYTHING:
+		return EVERYTHING_VALIDATOR;
+	case BLOB_NOTHING:
+		return NOTHING_VALIDATOR;
+	}
+
+	blob_reader_fail(r);
+	return NULL;
+}
+
+static void _validator_release(gpointer data)
+{
+	validator_unref((Validator *) data);
+}
+
+Validator *schema_blob_read(char const *data, size_t len, UriResolver *u)
+{
+	BlobHeader header;
+	if (len < sizeof(header))
+		return NULL;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, BLOB_MAGIC, sizeof(header.magic)) ||
+	    header.version != BLOB_VERSION ||
+	    header.byte_order != BLOB_BYTE_ORDER)
+		return NULL;
+
+	BlobReader r =
+	{
+		.pos = data + sizeof(header),
+		.end = data + len,
+		.nodes = g_ptr_array_new_with_free_func(_validator_release),
+	};
+
+	for (uint32_t i = 0; i < header.count && !r.failed; ++i)
+	{
+		Validator *v = _load_validator(&r);
+		if (!v)
+			blob_reader_fail(&r);
+		g_ptr_array_add(r.nodes, v);
+	}
+
+	Validator *root = blob_read_validator(&r);
+
+	uint32_t documents = _read_u32(&r);
+	for (uint32_t i = 0; i < documents && !r.failed; ++i)
+	{
+		char *document = blob_read_string(&r);
+		uint32_t fragments = _read_u32(&r);
+		if (!document)
+		{
+			blob_reader_fail(&r);
+			break;
+		}
+		uri_resolver_add_document(u, document);
+		for (uint32_t j = 0; j < fragments && !r.failed; ++j)
+		{
+			char *fragment = blob_read_string(&r);
+			Validator *v = blob_read_validator(&r);
+			if (fragment && v)
+				uri_resolver_add_validator(u, document, fragment, v);
+			else
+				blob_reader_fail(&r);
+			validator_unref(v);
+			g_free(fragment);
+		}
+		g_free(document);
+	}
+
+	if (r.failed || r.pos != r.end || !root)
+	{
+		validator_unref(root);
+		root = NULL;
+	}
+
+	g_ptr_array_free(r.nodes, TRUE);
+	return root;
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _Validator Validator;
+typedef struct _UriResolver UriResolver;
+typedef struct _Number Number;
+typedef struct jvalue* jvalue_ref;
+
+/** @brief Precompiled schema writer, see validator_serialize() */
+typedef struct _BlobWriter BlobWriter;
+
+/** @brief Precompiled schema reader */
+typedef struct _BlobReader BlobReader;
+
+/** @brief Kind of a validator in the precompiled schema.
+ *
+ * Every serialized validator starts with its tag. The values are stored
+ * in the files, never reorder them.
+ */
+typedef enum _BlobTag
+{
+	BLOB_NULL_GENERIC = 1,   /**< @brief null_validator_instance() */
+	BLOB_NULL,               /**< @brief NullValidator: default */
+	BLOB_BOOLEAN_GENERIC,    /**< @brief boolean_validator_instance() */
+	BLOB_BOOLEAN_TRUE,       /**< @brief boolean_validator_new_with_value(true) */
+	BLOB_BOOLEAN_FALSE,      /**< @brief boolean_validator_new_with_value(false) */
+	BLOB_BOOLEAN,            /**< @brief BooleanValidator: default */
+	BLOB_NUMBER_GENERIC,     /**< @brief number_validator_instance() */
+	BLOB_INTEGER_GENERIC,    /**< @brief integer_validator_instance() */
+	BLOB_NUMBER,             /**< @brief NumberValidator, see number_validator_load() */
+	BLOB_STRING_GENERIC,     /**< @brief string_validator_instance() */
+	BLOB_STRING,             /**< @brief StringValidator, see string_validator_load() */
+	BLOB_ARRAY_GENERIC,      /**< @brief array_validator_instance() */
+	BLOB_ARRAY,              /**< @brief ArrayValidator, see array_validator_load() */
+	BLOB_OBJECT_GENERIC,     /**< @brief object_validator_instance() */
+	BLOB_OBJECT,             /**< @brief ObjectValidator, see object_validator_load() */
+	BLOB_GENERIC_STATIC,     /**< @brief generic_validator_instance() */
+	BLOB_GENERIC_INVERSE,    /**< @brief inverse_generic_validator_instance() */
+	BLOB_GENERIC,            /**< @brief GenericValidator: default */
+	BLOB_COMBINED,           /**< @brief CombinedValidator, see combined_validator_load() */
+	BLOB_COMBINED_TYPES,     /**< @brief CombinedTypesValidator, see combined_types_validator_load() */
+	BLOB_REFERENCE,          /**< @brief Reference, see reference_load() */
+	BLOB_EVERYTHING,         /**< @brief EVERYTHING_VALIDATOR */
+	BLOB_NOTHING,            /**< @brief NOTHING_VALIDATOR */
+} BlobTag;
+
+/** @name Serialization primitives used by the validators
+ *  @{
+ */
+void blob_write_tag(BlobWriter *w, BlobTag tag);
+void blob_write_int(BlobWriter *w, int value);
+void blob_write_bool(BlobWriter *w, bool value);
+/** @brief Write null-terminated string, NULL is allowed */
+void blob_write_string(BlobWriter *w, char const *str);
+void blob_write_number(BlobWriter *w, Number const *n);
+/** @brief Write JSON value (default value of the validator), NULL is allowed */
+void blob_write_jvalue(BlobWriter *w, jvalue_ref value);
+/** @brief Write reference to a validator, NULL is allowed.
+ *
+ * The validator is serialized before the current one, if it hasn't been yet.
+ */
+void blob_write_validator(BlobWriter *w, Validator *v);
+
+int blob_read_int(BlobReader *r);
+bool blob_read_bool(BlobReader *r);
+/** @brief Read string into newly allocated buffer (g_free()), may return NULL */
+char *blob_read_string(BlobReader *r);
+/** @brief Read number into already initialized Number */
+bool blob_read_number(BlobReader *r, Number *n);
+/** @brief Read JSON value, the caller owns the result */
+jvalue_ref blob_read_jvalue(BlobReader *r);
+/** @brief Read reference to a validator, the caller owns the returned reference */
+Validator *blob_read_validator(BlobReader *r);
+/** @brief Mark the input as corrupted */
+void blob_reader_fail(BlobReader *r);
+/** @brief Check that the input has been consistent so far */
+bool blob_reader_ok(BlobReader *r);
+/** @} */
+
+/** @brief Serialize validator tree with all the documents known to the URI resolver.
+ *
+ * @param[in] v Root validator
+ * @param[in] u URI resolver with the external documents (may be NULL)
+ * @return Newly allocated blob or NULL if some validator can't be serialized.
+ */
+GByteArray *schema_blob_write(Validator *v, UriResolver *u);
+
+/** @brief Restore validator tree from the precompiled blob.
+ *
+ * @param[in] data Blob created by schema_blob_write()
+ * @param[in] len Size of the blob
+ * @param[in] u URI resolver to fill with the stored documents
+ * @return Root validator or NULL if the blob is corrupted.
+ */
+Validator *schema_blob_read(char const *data, size_t len, UriResolver *u);
+
+#ifdef __cplusplus
+}
+#endif
@@ -41,14 +41,14 @@ static void _release_validator(gpointer data)
 static Validator* ref(Validator *v)
 {
 	SchemaParsing *s = (SchemaParsing *) v;
-	++s->ref_count;
+	g_atomic_int_inc(&s->ref_count);
 	return v;
 }
 
 static void unref(Validator *v)
 {
 	SchemaParsing *s = (SchemaParsing *) v;
-	if (--s->ref_count)
+	if (!g_atomic_int_dec_and_test(&s->ref_count))
 		return;
 
 	g_slist_free_full(s->features, _release_feature);
@@ -0,0 +1,130 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "serialization_plan.h"
+#include "validator.h"
+#include "key_dictionary.h"
+#include "jvalue_writer.h"
+#include <jobject.h>
+#include <assert.h>
+#include <stdlib.h>
+
+struct _PlanBuilder
+{
+	SerializationPlan *plan;
+	GHashTable *compiled;    /**< @brief Validator -> PlanNode */
+};
+
+static PlanNode scalar_nodes[] =
+{
+	[PLAN_ANY] = { .kind = PLAN_ANY },
+	[PLAN_NULL] = { .kind = PLAN_NULL },
+	[PLAN_BOOLEAN] = { .kind = PLAN_BOOLEAN },
+	[PLAN_NUMBER] = { .kind = PLAN_NUMBER },
+	[PLAN_STRING] = { .kind = PLAN_STRING },
+};
+
+PlanNode *plan_node_scalar(PlanKind kind)
+{
+	assert(kind < PLAN_ARRAY);
+	return &scalar_nodes[kind];
+}
+
+static void plan_node_free(gpointer data)
+{
+	PlanNode *n = (PlanNode *) data;
+	for (size_t i = 0; i < n->property_count; ++i)
+	{
+		j_release(&n->properties[i].key);
+		free(n->properties[i].literal);
+	}
+	g_free(n->properties);
+	if (n->property_index)
+		g_hash_table_destroy(n->property_index);
+	g_free(n);
+}
+
+PlanNode *plan_node_new(PlanBuilder *b, Validator *v, PlanKind kind)
+{
+	PlanNode *n = g_new0(PlanNode, 1);
+	n->kind = kind;
+	n->items = plan_node_scalar(PLAN_ANY);
+	g_ptr_array_add(b->plan->nodes, n);
+	g_hash_table_insert(b->compiled, v, n);
+	return n;
+}
+
+bool plan_node_add_property(PlanNode *n, char const *key, size_t key_len, PlanNode *value)
+{
+	assert(n->kind == PLAN_OBJECT);
+
+	JWriter w;
+	jwriter_init(&w);
+	jwriter_write_string(&w, key, key_len);
+	jwriter_write_raw(&w, ":", 1);
+	size_t literal_len;
+	char *literal = jwriter_finish(&w, &literal_len);
+	if (!literal)
+		return false;
+
+	n->properties = g_renew(PlanProperty, n->properties, n->property_count + 1);
+	PlanProperty *p = &n->properties[n->property_count++];
+	p->literal = literal;
+	p->literal_len = literal_len;
+	p->key = keyDictionaryLookup(key, key_len);
+	p->value = value;
+
+	if (!n->property_index)
+		n->property_index = g_hash_table_new(g_direct_hash, g_direct_equal);
+	g_hash_table_insert(n->property_index, p->key, GSIZE_TO_POINTER(n->property_count));
+	return true;
+}
+
+PlanNode *plan_compile(PlanBuilder *b, Validator *v)
+{
+	if (!v)
+		return plan_node_scalar(PLAN_ANY);
+
+	PlanNode *n = (PlanNode *) g_hash_table_lookup(b->compiled, v);
+	if (n)
+		return n;
+
+	n = validator_compile_plan(v, b);
+	return n ? n : plan_node_scalar(PLAN_ANY);
+}
+
+SerializationPlan *serialization_plan_create(Validator *v)
+{
+	SerializationPlan *plan = g_new0(SerializationPlan, 1);
+	plan->nodes = g_ptr_array_new_with_free_func(plan_node_free);
+
+	PlanBuilder b = {
+		.plan = plan,
+		.compiled = g_hash_table_new(g_direct_hash, g_direct_equal),
+	};
+	plan->root = plan_compile(&b, v);
+	g_hash_table_destroy(b.compiled);
+
+	return plan;
+}
+
+void serialization_plan_free(SerializationPlan *plan)
+{
+	if (!plan)
+		return;
+	g_ptr_array_free(plan->nodes, TRUE);
+	g_free(plan);
+}
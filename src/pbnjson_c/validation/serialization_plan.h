@@ -0,0 +1,106 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <glib.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _Validator Validator;
+typedef struct jvalue* jvalue_ref;
+
+/** @brief Kind of values expected by a plan node */
+typedef enum _PlanKind
+{
+	PLAN_ANY,       /**< @brief Nothing is known, use the generic serializer */
+	PLAN_NULL,
+	PLAN_BOOLEAN,
+	PLAN_NUMBER,
+	PLAN_STRING,
+	PLAN_ARRAY,
+	PLAN_OBJECT,
+} PlanKind;
+
+typedef struct _PlanNode PlanNode;
+
+/** @brief Known property of an object */
+typedef struct _PlanProperty
+{
+	jvalue_ref key;        /**< @brief Interned key, the same instance as in the parsed objects */
+	char *literal;         /**< @brief Escaped "key": ready for the output */
+	size_t literal_len;    /**< @brief Length of the literal */
+	PlanNode *value;       /**< @brief Plan for the property value */
+} PlanProperty;
+
+/**
+ * Serialization plan for the values accepted by a validator.
+ *
+ * The plan is a hint: whenever a value doesn't match it, the serializer falls
+ * back to the generic path, so the output is always the same as jvalue_stringify().
+ * Nodes may form cycles for recursive schemas.
+ */
+struct _PlanNode
+{
+	PlanKind kind;
+	PlanNode *items;             /**< @brief PLAN_ARRAY: plan for every item */
+	size_t property_count;       /**< @brief PLAN_OBJECT: count of the known properties */
+	PlanProperty *properties;    /**< @brief PLAN_OBJECT: known properties */
+	GHashTable *property_index;  /**< @brief PLAN_OBJECT: interned key -> index of the property + 1 */
+};
+
+/** @brief Compiled plan with all its nodes, see jstringify_plan_new() */
+typedef struct jstringify_plan
+{
+	PlanNode *root;
+	GPtrArray *nodes;    /**< @brief Nodes owned by the plan */
+} SerializationPlan;
+
+/** @brief Compilation context, passed to validator_compile_plan() */
+typedef struct _PlanBuilder PlanBuilder;
+
+/** @brief Plan node for a kind of scalar values, or for PLAN_ANY */
+PlanNode *plan_node_scalar(PlanKind kind);
+
+/** @brief Create a container plan node for the validator.
+ *
+ * The node is registered before the nested plans are compiled, so that recursive
+ * schemas end up in a cycle instead of infinite recursion.
+ */
+PlanNode *plan_node_new(PlanBuilder *b, Validator *v, PlanKind kind);
+
+/** @brief Add a known property to the PLAN_OBJECT node */
+bool plan_node_add_property(PlanNode *n, char const *key, size_t key_len, PlanNode *value);
+
+/** @brief Get the plan for the validator, compiling it if needed. NULL validator means PLAN_ANY. */
+PlanNode *plan_compile(PlanBuilder *b, Validator *v);
+
+/** @brief Compile the plan for the validator tree.
+ *
+ * The references must be linked (see validator_link()).
+ */
+SerializationPlan *serialization_plan_create(Validator *v);
+
+/** @brief Release the plan with all its nodes */
+void serialization_plan_free(SerializationPlan *plan);
+
+#ifdef __cplusplus
+}
+#endif
@@ -19,6 +19,8 @@
 #include "validation_state.h"
 #include "validation_event.h"
 #include "parser_context.h"
+#include "schema_blob.h"
+#include "serialization_plan.h"
 #include <jobject.h>
 #include <glib.h>
 #include <string.h>
@@ -91,17 +93,44 @@ static bool check_generic(Validator *v, ValidationEvent const *e, ValidationStat
 	return true;
 }
 
+static bool _may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	StringValidator *vstr = (StringValidator *) v;
+	if (e->type != EV_STR)
+		return false;
+
+	// Discriminate enum values and constant strings without creating a state
+	return !vstr->expected_value ||
+	       (strlen(vstr->expected_value) == e->value.string.len &&
+	        !strncmp(vstr->expected_value, e->value.string.ptr, e->value.string.len));
+}
+
+static char* get_value_key(Validator *v)
+{
+	StringValidator *vstr = (StringValidator *) v;
+	if (!vstr->expected_value || vstr->min_length >= 0 || vstr->max_length >= 0 || vstr->pattern)
+		return NULL;
+
+	ValidationEvent e = validation_event_string(vstr->expected_value, strlen(vstr->expected_value));
+	return validation_event_get_value_key(&e);
+}
+
+static bool may_accept_generic(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	return e->type == EV_STR;
+}
+
 static Validator* ref(Validator *validator)
 {
 	StringValidator *v = (StringValidator *) validator;
-	++v->ref_count;
+	g_atomic_int_inc(&v->ref_count);
 	return validator;
 }
 
 static void unref(Validator *validator)
 {
 	StringValidator *v = (StringValidator *) validator;
-	if (--v->ref_count)
+	if (!g_atomic_int_dec_and_test(&v->ref_count))
 		return;
 	string_validator_release(v);
 }
@@ -181,19 +210,47 @@ static bool equals(Validator *v, Validator *other)
 	return false;
 }
 
+static bool serialize(Validator *v, BlobWriter *w)
+{
+	StringValidator *s = (StringValidator *) v;
+	blob_write_tag(w, BLOB_STRING);
+	blob_write_string(w, s->expected_value);
+	blob_write_int(w, s->min_length);
+	blob_write_int(w, s->max_length);
+	blob_write_string(w, s->pattern ? g_regex_get_pattern(s->pattern) : NULL);
+	blob_write_jvalue(w, s->def_value);
+	return true;
+}
+
+static bool serialize_generic(Validator *v, BlobWriter *w)
+{
+	blob_write_tag(w, BLOB_STRING_GENERIC);
+	return true;
+}
+
+static PlanNode* compile_plan(Validator *v, PlanBuilder *b)
+{
+	return plan_node_scalar(PLAN_STRING);
+}
+
 static ValidatorVtable generic_string_vtable =
 {
 	.check = check_generic,
+	.may_accept = may_accept_generic,
 	.set_string_max_length = set_max_length_generic,
 	.set_string_min_length = set_min_length_generic,
 	.set_string_pattern = set_pattern_generic,
 	.set_default = set_default_generic,
 	.dump_enter = dump_enter,
+	.serialize = serialize_generic,
+	.compile_plan = compile_plan,
 };
 
 static ValidatorVtable string_vtable =
 {
 	.check = _check,
+	.may_accept = _may_accept,
+	.get_value_key = get_value_key,
 	.equals = equals,
 	.ref = ref,
 	.unref = unref,
@@ -203,6 +260,8 @@ static ValidatorVtable string_vtable =
 	.set_default = set_default,
 	.get_default = get_default,
 	.dump_enter = dump_enter,
+	.serialize = serialize,
+	.compile_plan = compile_plan,
 };
 
 StringValidator* string_validator_new(void)
@@ -247,6 +306,24 @@ void string_validator_add_expected_value(StringValidator *v, StringSpan *span)
 	v->expected_value = g_strndup(span->str, span->str_len);
 }
 
+Validator* string_validator_load(BlobReader *r)
+{
+	StringValidator *s = string_validator_new();
+	s->expected_value = blob_read_string(r);
+	s->min_length = blob_read_int(r);
+	s->max_length = blob_read_int(r);
+
+	char *pattern = blob_read_string(r);
+	if (pattern)
+	{
+		s->pattern = g_regex_new(pattern, G_REGEX_JAVASCRIPT_COMPAT, 0, NULL);
+		if (!s->pattern)
+			blob_reader_fail(r);
+		g_free(pattern);
+	}
+	return &s->base;
+}
+
 static Validator STRING_VALIDATOR_IMPL =
 {
 	.vtable = &generic_string_vtable,
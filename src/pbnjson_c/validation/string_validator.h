@@ -24,13 +24,15 @@
 extern "C" {
 #endif
 
+typedef struct _BlobReader BlobReader;
+
 typedef struct _StringSpan StringSpan;
 
 /** @brief String validator class for {"type": "string"} */
 typedef struct _StringValidator
 {
 	Validator base;        /**< @brief Base class */
-	unsigned ref_count;    /**< @brief Reference count */
+	int ref_count;         /**< @brief Reference count */
 	jvalue_ref def_value;  /**< @brief Default value attached to this validator */
 
 	char *expected_value;  /**< @brief Expected value if not NULL (for enums) */
@@ -51,6 +53,9 @@ StringValidator* string_validator_new();
 /** @brief Destructor */
 void string_validator_release(StringValidator *v);
 
+/** @brief Restore the validator from a precompiled schema, see schema_blob.h */
+Validator* string_validator_load(BlobReader *r);
+
 /** @brief Remember minimal length */
 void string_validator_add_min_length_constraint(StringValidator *v, size_t min_length);
 
@@ -110,3 +110,23 @@ TEST_F(TestAllOfValidator, AlwaysFails2)
 	//EXPECT_EQ(VEC_NOT_BOOLEAN, error);
 	EXPECT_EQ(0U, g_slist_length(s->validator_stack));
 }
+
+TEST_F(TestAllOfValidator, CollectErrorsPerValidator)
+{
+	CombinedValidator *w = all_of_validator_new();
+	combined_validator_collect_errors(w);
+	combined_validator_add_value(w, NULL_VALIDATOR);
+	combined_validator_add_value(v, NULL_VALIDATOR);
+
+	// Only the validator asked for it reports the errors of its subschemas
+	auto s = mk_ptr(validation_state_new(&w->base, NULL, &notify), validation_state_free);
+	EXPECT_FALSE(validation_check(&(e = validation_event_boolean(true)), s.get(), this));
+	EXPECT_EQ(VEC_NOT_NULL, error);
+
+	error = VEC_OK;
+	s = mk_ptr(validation_state_new(&v->base, NULL, &notify), validation_state_free);
+	EXPECT_FALSE(validation_check(&(e = validation_event_boolean(true)), s.get(), this));
+	EXPECT_EQ(VEC_NOT_EVERY_ALL_OF, error);
+
+	combined_validator_release(w);
+}
@@ -144,3 +144,68 @@ TEST(TestEnum, StringWithArrayInEnum)
 	EXPECT_FALSE(validate_json_plain("\"array\"", v.get()));
 	EXPECT_FALSE(validate_json_plain("\"file\"", v.get()));
 }
+
+TEST(TestEnum, NumberNotation)
+{
+	char const *const SCHEMA = "{ \"enum\": [10, -2.5, 0] }";
+	auto v = mk_ptr(parse_schema_bare(SCHEMA), validator_unref);
+	ASSERT_TRUE(v != NULL);
+
+	EXPECT_TRUE(validate_json_plain("10", v.get()));
+	EXPECT_TRUE(validate_json_plain("10.0", v.get()));
+	EXPECT_TRUE(validate_json_plain("1e1", v.get()));
+	EXPECT_TRUE(validate_json_plain("-25e-1", v.get()));
+	EXPECT_TRUE(validate_json_plain("-0", v.get()));
+	EXPECT_TRUE(validate_json_plain("0.0", v.get()));
+
+	EXPECT_FALSE(validate_json_plain("2.5", v.get()));
+	EXPECT_FALSE(validate_json_plain("100", v.get()));
+	EXPECT_FALSE(validate_json_plain("\"10\"", v.get()));
+}
+
+TEST(TestEnum, NumbersBeyondInt64)
+{
+	char const *const SCHEMA = "{ \"enum\": [1e30, 5012349872340987234123, 0.5] }";
+	auto v = mk_ptr(parse_schema_bare(SCHEMA), validator_unref);
+	ASSERT_TRUE(v != NULL);
+
+	EXPECT_TRUE(validate_json_plain("1e30", v.get()));
+	EXPECT_TRUE(validate_json_plain("10e29", v.get()));
+	EXPECT_TRUE(validate_json_plain("5012349872340987234123", v.get()));
+	EXPECT_TRUE(validate_json_plain("5e-1", v.get()));
+
+	EXPECT_FALSE(validate_json_plain("1e29", v.get()));
+	EXPECT_FALSE(validate_json_plain("5", v.get()));
+}
+
+TEST(TestEnum, StringPrefixes)
+{
+	char const *const SCHEMA = "{ \"enum\": [\"red\", \"\"] }";
+	auto v = mk_ptr(parse_schema_bare(SCHEMA), validator_unref);
+	ASSERT_TRUE(v != NULL);
+
+	EXPECT_TRUE(validate_json_plain("\"red\"", v.get()));
+	EXPECT_TRUE(validate_json_plain("\"\"", v.get()));
+
+	EXPECT_FALSE(validate_json_plain("\"re\"", v.get()));
+	EXPECT_FALSE(validate_json_plain("\"redd\"", v.get()));
+	EXPECT_FALSE(validate_json_plain("\"red\\u0000\"", v.get()));
+	EXPECT_FALSE(validate_json_plain("null", v.get()));
+}
+
+TEST(TestEnum, MixedScalarsAndArrays)
+{
+	char const *const SCHEMA = "{ \"enum\": [\"a\", 1, [\"a\"], null] }";
+	auto v = mk_ptr(parse_schema_bare(SCHEMA), validator_unref);
+	ASSERT_TRUE(v != NULL);
+
+	EXPECT_TRUE(validate_json_plain("\"a\"", v.get()));
+	EXPECT_TRUE(validate_json_plain("1", v.get()));
+	EXPECT_TRUE(validate_json_plain("[\"a\"]", v.get()));
+	EXPECT_TRUE(validate_json_plain("null", v.get()));
+
+	EXPECT_FALSE(validate_json_plain("\"b\"", v.get()));
+	EXPECT_FALSE(validate_json_plain("[\"b\"]", v.get()));
+	EXPECT_FALSE(validate_json_plain("false", v.get()));
+	EXPECT_FALSE(validate_json_plain("{}", v.get()));
+}
@@ -15,6 +15,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "../number.h"
+#include <cmath>
+#include <cstring>
 #include <gtest/gtest.h>
 
 
@@ -30,3 +32,56 @@ TEST(Number, IsInteger)
 	EXPECT_FALSE(number_is_integer(&n));
 	number_clear(&n);
 }
+
+TEST(Number, SetTyped)
+{
+	Number n, m;
+	number_init(&n);
+	number_init(&m);
+
+	number_set_int64(&n, INT64_MIN);
+	ASSERT_EQ(0, number_set(&m, "-9223372036854775808"));
+	EXPECT_EQ(0, number_compare(&n, &m));
+
+	// Floating point numbers are compared as they're serialized
+	ASSERT_EQ(0, number_set_double(&n, 0.1));
+	ASSERT_EQ(0, number_set(&m, "0.1"));
+	EXPECT_EQ(0, number_compare(&n, &m));
+
+	ASSERT_EQ(0, number_set_double(&n, 1e20));
+	EXPECT_TRUE(number_is_integer(&n));
+	ASSERT_EQ(0, number_set_double(&n, -2.5));
+	EXPECT_FALSE(number_is_integer(&n));
+
+	EXPECT_NE(0, number_set_double(&n, INFINITY));
+
+	number_clear(&m);
+	number_clear(&n);
+}
+
+TEST(Number, TextToInt64)
+{
+	auto get = [](char const *text, int64_t *value) { return number_text_get_int64(text, strlen(text), value); };
+	int64_t i = 0;
+
+	EXPECT_TRUE(get("10", &i)); EXPECT_EQ(10, i);
+	EXPECT_TRUE(get("1e1", &i)); EXPECT_EQ(10, i);
+	EXPECT_TRUE(get("10.00", &i)); EXPECT_EQ(10, i);
+	EXPECT_TRUE(get("1000e-2", &i)); EXPECT_EQ(10, i);
+	EXPECT_TRUE(get("0.05E+2", &i)); EXPECT_EQ(5, i);
+	EXPECT_TRUE(get("-0", &i)); EXPECT_EQ(0, i);
+	EXPECT_TRUE(get("0e400", &i)); EXPECT_EQ(0, i);
+	EXPECT_TRUE(get("-9223372036854775808", &i)); EXPECT_EQ(INT64_MIN, i);
+	EXPECT_TRUE(get("9223372036854775807", &i)); EXPECT_EQ(INT64_MAX, i);
+	EXPECT_TRUE(get("12300000000000000000000e-4", &i)); EXPECT_EQ(1230000000000000000, i);
+
+	EXPECT_FALSE(get("9223372036854775808", &i));
+	EXPECT_FALSE(get("1e19", &i));
+	EXPECT_FALSE(get("2.5", &i));
+	EXPECT_FALSE(get("1e-1", &i));
+	EXPECT_FALSE(get("1.00000000000000000001", &i));
+	EXPECT_FALSE(get("", &i));
+	EXPECT_FALSE(get("-", &i));
+	EXPECT_FALSE(get("1e", &i));
+	EXPECT_FALSE(get("1x", &i));
+}
@@ -187,3 +187,25 @@ TEST_F(TestNumberValidator, NumberMinMaxConstraintNegativeGreater)
 	EXPECT_EQ(VEC_NUMBER_TOO_BIG, error);
 	EXPECT_EQ(0U, g_slist_length(s->validator_stack));
 }
+
+TEST_F(TestNumberValidator, TypedNumbers)
+{
+	ASSERT_TRUE(number_validator_add_min_constraint(v, "0.1"));
+	ASSERT_TRUE(number_validator_add_max_constraint(v, "2"));
+	EXPECT_TRUE(validation_check(&(e = validation_event_number_int64(2)), s, NULL));
+	EXPECT_EQ(0U, g_slist_length(s->validator_stack));
+
+	validation_state_free(s);
+	s = validation_state_new(&v->base, NULL, NULL);
+	EXPECT_TRUE(validation_check(&(e = validation_event_number_double(0.1)), s, NULL));
+	EXPECT_EQ(0U, g_slist_length(s->validator_stack));
+
+	validation_state_free(s);
+	s = validation_state_new(&v->base, NULL, NULL);
+	EXPECT_TRUE(validation_check(&(e = validation_event_number_double(2.0)), s, NULL));
+
+	validation_state_free(s);
+	s = validation_state_new(&v->base, NULL, NULL);
+	EXPECT_FALSE(validation_check(&(e = validation_event_number_int64(3)), s, NULL));
+	EXPECT_EQ(0U, g_slist_length(s->validator_stack));
+}
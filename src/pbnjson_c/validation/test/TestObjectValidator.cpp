@@ -24,7 +24,10 @@
 #include "../object_required.h"
 #include "../object_pattern_properties.h"
 #include "Util.hpp"
+#include <jobject.h>
 #include <gtest/gtest.h>
+#include <set>
+#include <string>
 
 using namespace std;
 
@@ -310,3 +313,59 @@ TEST_F(TestObjectValidator, PatternProperties)
 	EXPECT_FALSE(validate_json_plain(R"({"0asd": "string"})", &v->base));
 	EXPECT_FALSE(validate_json_plain(R"({"s0": 17})", &v->base));
 }
+
+static bool OnDefault(ValidationState *s, char const *key, jvalue_ref value, void *ctxt)
+{
+	auto keys = reinterpret_cast<set<string> *>(ctxt);
+	keys->insert(key);
+	return true;
+}
+
+TEST_F(TestObjectValidator, Defaults)
+{
+	static Notification notify { &OnError, &OnDefault };
+
+	// More than fits into a single word of the seen bitset
+	for (int i = 0; i < 70; ++i)
+	{
+		Validator *num = &number_validator_new()->base;
+		jvalue_ref def_value = jnumber_create_i32(i);
+		validator_set_default(num, def_value);
+		j_release(&def_value);
+		object_properties_add_key(p, ("p" + to_string(i)).c_str(), num);
+	}
+	object_properties_add_key(p, "null", NULL_VALIDATOR);
+
+	auto check = [&](char const *key)
+	{
+		bool is_null = !strcmp(key, "null");
+		set<string> keys;
+		ValidationState *ds = validation_state_new(&v->base, NULL, &notify);
+		EXPECT_TRUE(validation_check(&(e = validation_event_obj_start()), ds, &keys));
+		EXPECT_TRUE(validation_check(&(e = validation_event_obj_key(key, strlen(key))), ds, &keys));
+		EXPECT_TRUE(validation_check(&(e = is_null ? validation_event_null()
+		                                           : validation_event_number("1", 1)), ds, &keys));
+		EXPECT_TRUE(validation_check(&(e = validation_event_obj_end()), ds, &keys));
+		EXPECT_EQ(0U, g_slist_length(ds->validator_stack));
+		validation_state_free(ds);
+
+		EXPECT_EQ(is_null ? 70U : 69U, keys.size());
+		EXPECT_EQ(0U, keys.count(key));
+	};
+
+	// Until the validator is linked, every instance collects the defaults
+	check("p3");
+	EXPECT_TRUE(v->defaults == NULL);
+
+	// The list of defaults is shared by the instances, the seen keys aren't
+	ASSERT_TRUE(validator_link(&v->base, NULL));
+	for (char const *key : {"p3", "p65", "null"})
+		check(key);
+	ObjectDefaults *defaults = v->defaults;
+	EXPECT_TRUE(defaults != NULL);
+
+	// Linking again keeps the list, other threads may be using it
+	ASSERT_TRUE(validator_link(&v->base, NULL));
+	EXPECT_EQ(defaults, v->defaults);
+	check("p65");
+}
@@ -21,6 +21,7 @@
 #include "../boolean_validator.h"
 #include "../object_validator.h"
 #include "../object_required.h"
+#include "../object_properties.h"
 #include "Util.hpp"
 #include <gtest/gtest.h>
 
@@ -58,6 +59,48 @@ protected:
 		combined_validator_add_value(v, (Validator*)ov);
 	}
 
+	// Add {"properties": {"tag": {"enum": [tag]}, "x": x}, "required": ["tag"]}
+	void add_tagged_object(bool tag, Validator *x)
+	{
+		auto tag_enum = enum_validator_new();
+		combined_validator_add_value(tag_enum, boolean_validator_new_with_value(tag));
+
+		auto p = object_properties_new();
+		object_properties_add_key(p, "tag", &tag_enum->base);
+		object_properties_add_key(p, "x", x);
+		auto r = object_required_new();
+		object_required_add_key(r, "tag");
+
+		auto ov = object_validator_new();
+		validator_set_object_properties(&ov->base, p);
+		validator_set_object_required(&ov->base, r);
+		object_properties_unref(p);
+		object_required_unref(r);
+		combined_validator_add_value(v, &ov->base);
+	}
+
+	// Validate {"x": null, "tag": tag}
+	bool validate_tagged_object(ValidationEvent tag)
+	{
+		auto s = mk_ptr(validation_state_new(&v->base, NULL, &notify), validation_state_free);
+		bool res = validation_check(&(e = validation_event_obj_start()), s.get(), this) &&
+		           validation_check(&(e = validation_event_obj_key("x", 1)), s.get(), this) &&
+		           validation_check(&(e = validation_event_null()), s.get(), this) &&
+		           validation_check(&(e = validation_event_obj_key("tag", 3)), s.get(), this) &&
+		           validation_check(&(e = tag), s.get(), this) &&
+		           validation_check(&(e = validation_event_obj_end()), s.get(), this);
+		EXPECT_EQ(0U, g_slist_length(s->validator_stack));
+		return res;
+	}
+
+	static int checked;
+	static bool CountCheck(Validator *v, ValidationEvent const *e, ValidationState *s, void *ctxt)
+	{
+		++checked;
+		validation_state_pop_validator(s);
+		return true;
+	}
+
 	static void OnError(ValidationState *s, ValidationErrorCode error, void *ctxt)
 	{
 		TestOneOfValidator *n = reinterpret_cast<TestOneOfValidator *>(ctxt);
@@ -68,6 +111,7 @@ protected:
 };
 
 Notification TestOneOfValidator::notify { &OnError };
+int TestOneOfValidator::checked = 0;
 
 
 TEST_F(TestOneOfValidator, OnlyGeneric)
@@ -198,3 +242,65 @@ TEST_F(TestOneOfValidator, OverlappedRequired)
 	EXPECT_FALSE(validation_check(&(e = validation_event_obj_end()), s.get(), this));
 	EXPECT_EQ(0U, g_slist_length(s->validator_stack));
 }
+
+TEST_F(TestOneOfValidator, ImpossibleAlternatives)
+{
+	combined_validator_add_value(v, NULL_VALIDATOR);
+	combined_validator_add_value(v, boolean_validator_new_with_value(true));
+	combined_validator_add_value(v, &object_validator_new()->base);
+
+	EXPECT_TRUE(validator_may_accept(&v->base, &(e = validation_event_null()), NULL));
+	EXPECT_TRUE(validator_may_accept(&v->base, &(e = validation_event_boolean(true)), NULL));
+	EXPECT_FALSE(validator_may_accept(&v->base, &(e = validation_event_boolean(false)), NULL));
+	EXPECT_TRUE(validator_may_accept(&v->base, &(e = validation_event_obj_start()), NULL));
+	EXPECT_FALSE(validator_may_accept(&v->base, &(e = validation_event_arr_start()), NULL));
+
+	auto s = mk_ptr(validation_state_new(&v->base, NULL, &notify), validation_state_free);
+	EXPECT_TRUE(validation_check(&(e = validation_event_boolean(true)), s.get(), this));
+	EXPECT_EQ(0U, g_slist_length(s->validator_stack));
+	EXPECT_EQ(VEC_OK, error);
+
+	s.reset(validation_state_new(&v->base, NULL, &notify));
+	EXPECT_FALSE(validation_check(&(e = validation_event_boolean(false)), s.get(), this));
+	EXPECT_EQ(0U, g_slist_length(s->validator_stack));
+	EXPECT_EQ(VEC_NEITHER_OF_ANY, error);
+
+	error = VEC_OK;
+	s.reset(validation_state_new(&v->base, NULL, &notify));
+	EXPECT_TRUE(validation_check(&(e = validation_event_obj_start()), s.get(), this));
+	EXPECT_TRUE(validation_check(&(e = validation_event_obj_end()), s.get(), this));
+	EXPECT_EQ(0U, g_slist_length(s->validator_stack));
+	EXPECT_EQ(VEC_OK, error);
+}
+
+TEST_F(TestOneOfValidator, TaggedAlternatives)
+{
+	// The subschema counts the values it sees
+	ValidatorVtable counting_vtable {};
+	counting_vtable.check = &CountCheck;
+	Validator counting;
+	validator_init(&counting, &counting_vtable);
+
+	add_tagged_object(true, GENERIC_VALIDATOR);
+	add_tagged_object(false, &counting);
+
+	// Without the index every subschema starts with the object
+	checked = 0;
+	EXPECT_TRUE(validate_tagged_object(validation_event_boolean(true)));
+	EXPECT_EQ(1, checked);
+
+	// The subschemas aren't started until the tag is seen, only the one
+	// with the same tag is
+	ASSERT_TRUE(validator_link(&v->base, NULL));
+	checked = 0;
+	EXPECT_TRUE(validate_tagged_object(validation_event_boolean(true)));
+	EXPECT_EQ(0, checked);
+	EXPECT_EQ(VEC_OK, error);
+
+	EXPECT_TRUE(validate_tagged_object(validation_event_boolean(false)));
+	EXPECT_EQ(1, checked);
+
+	EXPECT_FALSE(validate_tagged_object(validation_event_null()));
+	EXPECT_EQ(VEC_NEITHER_OF_ANY, error);
+	EXPECT_EQ(1, checked);
+}
@@ -18,6 +18,7 @@
 #include "../uri_resolver.h"
 #include "../validator.h"
 #include "../validation_api.h"
+#include "../validation_state.h"
 #include <gtest/gtest.h>
 
 
@@ -72,3 +73,43 @@ TEST(TestReference, selfReference)
 	validator_unref(v);
 	uri_resolver_free(u);
 }
+
+TEST(TestReference, linked)
+{
+	auto u = uri_resolver_new();
+	ASSERT_TRUE(u != NULL);
+	auto v = parse_schema( R"schema(
+		{
+			"definitions": {
+				"node": {
+					"type": "object",
+					"properties": {
+						"name"     : {"type": "string"},
+						"children" : {"type": "array", "items": {"$ref": "#/definitions/node"}}
+					}
+				}
+			},
+			"$ref": "#/definitions/node"
+		})schema",
+		u, "file:///test4.json",
+		NULL, NULL
+		);
+	ASSERT_TRUE(v != NULL);
+
+	ASSERT_TRUE(validator_link(v, u));
+	ASSERT_TRUE(uri_resolver_link(u));
+
+	// The root reference is skipped by the validation stack
+	auto node = uri_resolver_lookup_validator(u, "file:///test4.json", "#/definitions/node");
+	ASSERT_TRUE(node != NULL);
+	EXPECT_EQ(node, validator_get_target(v));
+	ValidationState *s = validation_state_new(v, u, NULL);
+	EXPECT_EQ(node, validation_state_get_validator(s));
+	validation_state_free(s);
+
+	EXPECT_TRUE(validate_json(R"({"name": "a", "children": [{"name": "b", "children": []}]})", v, u, NULL));
+	EXPECT_FALSE(validate_json(R"({"children": [{"children": [{"name": 1}]}]})", v, u, NULL));
+
+	validator_unref(v);
+	uri_resolver_free(u);
+}
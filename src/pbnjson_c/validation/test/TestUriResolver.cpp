@@ -15,6 +15,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "../uri_resolver.h"
+#include "../null_validator.h"
+#include "../boolean_validator.h"
 #include <gtest/gtest.h>
 
 TEST(TestUriResolver, AddDocument)
@@ -31,3 +33,36 @@ TEST(TestUriResolver, AddDocument)
 
 	uri_resolver_free(u);
 }
+
+TEST(TestUriResolver, MergeConflict)
+{
+	UriResolver *u = uri_resolver_new();
+	UriResolver *source = uri_resolver_new();
+	Validator *ours = (Validator *) null_validator_new();
+	Validator *theirs = (Validator *) boolean_validator_new();
+
+	uri_resolver_add_validator(u, "common.json", "#", ours);
+	uri_resolver_add_validator(source, "common.json", "#", theirs);
+	uri_resolver_add_validator(source, "item.json", "#", theirs);
+
+	// Different definitions of the same document: nothing is merged
+	EXPECT_FALSE(uri_resolver_steal_documents(u, source));
+	EXPECT_FALSE(uri_resolver_copy_documents(u, source));
+	EXPECT_EQ(ours, uri_resolver_lookup_validator(u, "common.json", "#"));
+	EXPECT_EQ(NULL, uri_resolver_lookup_validator(u, "item.json", "#"));
+	EXPECT_EQ(theirs, uri_resolver_lookup_validator(source, "common.json", "#"));
+	EXPECT_EQ(theirs, uri_resolver_lookup_validator(source, "item.json", "#"));
+
+	// Shared definitions of the same document are merged
+	UriResolver *shared = uri_resolver_new();
+	EXPECT_TRUE(uri_resolver_copy_documents(shared, source));
+	EXPECT_TRUE(uri_resolver_steal_documents(shared, source));
+	EXPECT_EQ(theirs, uri_resolver_lookup_validator(shared, "common.json", "#"));
+	EXPECT_EQ(theirs, uri_resolver_lookup_validator(shared, "item.json", "#"));
+
+	validator_unref(ours);
+	validator_unref(theirs);
+	uri_resolver_free(shared);
+	uri_resolver_free(source);
+	uri_resolver_free(u);
+}
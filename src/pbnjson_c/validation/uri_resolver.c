@@ -125,42 +125,117 @@ char const *uri_resolver_get_unresolved(UriResolver *u)
 	return NULL;
 }
 
-bool uri_resolver_steal_documents(UriResolver *u, UriResolver *source)
+static GHashTable *_copy_fragments(GHashTable *fragments)
+{
+	GHashTable *copy = g_hash_table_new_full(g_str_hash, g_str_equal,
+	                                         g_free, _validator_release);
+	if (!fragments)
+		return copy;
+
+	GHashTableIter it;
+	g_hash_table_iter_init(&it, fragments);
+	char const *fragment = NULL;
+	Validator *v = NULL;
+	while (g_hash_table_iter_next(&it, (gpointer *) &fragment, (gpointer *) &v))
+		g_hash_table_insert(copy, g_strdup(fragment), validator_ref(v));
+	return copy;
+}
+
+// Tell whether two bunches of fragments of the same document can't be merged.
+// They're compatible only if both share the same validators (copied from one schema).
+static bool _conflicting_fragments(GHashTable *ours, GHashTable *theirs)
+{
+	if (!ours || !g_hash_table_size(ours) || !theirs || !g_hash_table_size(theirs))
+		return false;
+	if (g_hash_table_size(ours) != g_hash_table_size(theirs))
+		return true;
+
+	GHashTableIter it;
+	g_hash_table_iter_init(&it, theirs);
+	char const *fragment = NULL;
+	Validator *v = NULL;
+	while (g_hash_table_iter_next(&it, (gpointer *) &fragment, (gpointer *) &v))
+	{
+		if (g_hash_table_lookup(ours, fragment) != v)
+			return true;
+	}
+	return false;
+}
+
+static bool _merge_documents(UriResolver *u, UriResolver *source, bool steal)
 {
 	if (!source)
 		return true;
 
 	GHashTableIter it;
-	g_hash_table_iter_init(&it, source->documents);
 	char *document = NULL;
 	gpointer fragments = NULL;
+
+	// Check everything before merging anything. The validators of the source
+	// may be linked to its fragments already, so none of them may be dropped.
+	g_hash_table_iter_init(&it, source->documents);
+	while (g_hash_table_iter_next(&it, (gpointer *) &document, &fragments))
+	{
+		// If we've got two bunches of fragments of the same document,
+		// there's no way to merge them in (currently?).
+		if (*document != '\0' &&
+		    _conflicting_fragments(g_hash_table_lookup(u->documents, document), fragments))
+			return false;
+	}
+
+	g_hash_table_iter_init(&it, source->documents);
 	while (g_hash_table_iter_next(&it, (gpointer *) &document, &fragments))
 	{
 		// Skip the root fragment
 		if (*document == '\0')
 			continue;
 
+		// If the document has already been resolved, we can safely skip it now.
 		gpointer old_fragments = g_hash_table_lookup(u->documents, document);
-
-		// If the document has already been resolved,
 		if (old_fragments && g_hash_table_size(old_fragments))
-		{
-			// If we've got two bunches of fragments of the same document,
-			// there's no way to merge them in (currently?).
-			if (fragments && g_hash_table_size(fragments))
-				return false;
-			// Otherwise, the document has already been resolved, and we
-			// can safely skip it now.
 			continue;
-		}
 
-		g_hash_table_iter_steal(&it);
-		g_hash_table_replace(u->documents, document, fragments);
+		if (steal)
+		{
+			g_hash_table_iter_steal(&it);
+			g_hash_table_replace(u->documents, document, fragments);
+		}
+		else
+			g_hash_table_replace(u->documents, g_strdup(document), _copy_fragments(fragments));
 	}
 
 	return true;
 }
 
+bool uri_resolver_steal_documents(UriResolver *u, UriResolver *source)
+{
+	return _merge_documents(u, source, true);
+}
+
+bool uri_resolver_copy_documents(UriResolver *u, UriResolver *source)
+{
+	return _merge_documents(u, source, false);
+}
+
+bool uri_resolver_link(UriResolver *u)
+{
+	bool res = true;
+
+	GHashTableIter it1;
+	g_hash_table_iter_init(&it1, u->documents);
+	GHashTable *fragments = NULL;
+	while (g_hash_table_iter_next(&it1, NULL, (void **) &fragments))
+	{
+		GHashTableIter it2;
+		g_hash_table_iter_init(&it2, fragments);
+		Validator *v = NULL;
+		while (g_hash_table_iter_next(&it2, NULL, (void **) &v))
+			res = validator_link(v, u) && res;
+	}
+
+	return res;
+}
+
 char *uri_resolver_dump(UriResolver const *u)
 {
 	char *result = NULL;
@@ -86,9 +86,26 @@ Validator *uri_resolver_lookup_validator(UriResolver *u,
 /** @brief Get one of the unresolved documents */
 char const *uri_resolver_get_unresolved(UriResolver *u);
 
-/** @brief Move everything except root fragment from the source to us. */
+/** @brief Move everything except root fragment from the source to us.
+ *
+ * @return false if both resolvers have different fragments of the same document.
+ *         Nothing is moved then, the source stays intact.
+ */
 bool uri_resolver_steal_documents(UriResolver *u, UriResolver *source);
 
+/** @brief Share everything except root fragment of the source with us.
+ *
+ * Unlike uri_resolver_steal_documents() the source stays intact, the validators
+ * are referenced by both resolvers. Fails without changes like uri_resolver_steal_documents().
+ */
+bool uri_resolver_copy_documents(UriResolver *u, UriResolver *source);
+
+/** @brief Bind references of all the known validators to their targets.
+ *
+ * @return false if some reference points to a missing schema, see validator_link()
+ */
+bool uri_resolver_link(UriResolver *u);
+
 /** @brief Debug method */
 char *uri_resolver_dump(UriResolver const *u);
 
@@ -15,6 +15,10 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "validation_event.h"
+#include "number.h"
+#include <glib.h>
+#include <string.h>
+#include <math.h>
 
 ValidationEvent validation_event_null(void)
 {
@@ -52,6 +56,32 @@ ValidationEvent validation_event_number(const char *str, size_t len)
 	return e;
 }
 
+ValidationEvent validation_event_number_int64(int64_t val)
+{
+	ValidationEvent e =
+	{
+		.type = EV_NUM,
+		.number_format = EV_NUM_INT64,
+		.value = {
+			.integer = val
+		}
+	};
+	return e;
+}
+
+ValidationEvent validation_event_number_double(double val)
+{
+	ValidationEvent e =
+	{
+		.type = EV_NUM,
+		.number_format = EV_NUM_DOUBLE,
+		.value = {
+			.floating = val
+		}
+	};
+	return e;
+}
+
 ValidationEvent validation_event_string(char const *str, size_t len)
 {
 	ValidationEvent e =
@@ -117,3 +147,77 @@ ValidationEvent validation_event_arr_end(void)
 	};
 	return e;
 }
+
+int validation_event_get_number(ValidationEvent const *e, Number *n)
+{
+	switch (e->number_format)
+	{
+	case EV_NUM_INT64:
+		number_set_int64(n, e->value.integer);
+		return 0;
+	case EV_NUM_DOUBLE:
+		return number_set_double(n, e->value.floating);
+	default:
+		return number_set_n(n, e->value.string.ptr, e->value.string.len);
+	}
+}
+
+bool validation_event_get_int64(ValidationEvent const *e, int64_t *value)
+{
+	switch (e->number_format)
+	{
+	case EV_NUM_INT64:
+		*value = e->value.integer;
+		return true;
+	case EV_NUM_DOUBLE:
+		// Same as number_set_double(): only these doubles are taken exactly
+		if (e->value.floating != trunc(e->value.floating) || fabs(e->value.floating) >= 1e14)
+			return false;
+		*value = (int64_t) e->value.floating;
+		return true;
+	default:
+		return number_text_get_int64(e->value.string.ptr, e->value.string.len, value);
+	}
+}
+
+char* validation_event_get_number_key(Number const *n)
+{
+	char *canonical = number_get_canonical(n);
+	char *key = g_strconcat("d", canonical, NULL);
+	g_free(canonical);
+	return key;
+}
+
+char* validation_event_get_value_key(ValidationEvent const *e)
+{
+	switch (e->type)
+	{
+	case EV_NULL:
+		return g_strdup("n");
+	case EV_BOOL:
+		return g_strdup(e->value.boolean ? "t" : "f");
+	case EV_STR:
+	{
+		// Keys are C strings, the expected values of enums can't contain '\0' either.
+		if (memchr(e->value.string.ptr, 0, e->value.string.len))
+			return NULL;
+		char *key = g_malloc(e->value.string.len + 2);
+		key[0] = 's';
+		memcpy(key + 1, e->value.string.ptr, e->value.string.len);
+		key[e->value.string.len + 1] = '\0';
+		return key;
+	}
+	case EV_NUM:
+	{
+		Number n;
+		number_init(&n);
+		char *key = NULL;
+		if (!validation_event_get_number(e, &n))
+			key = validation_event_get_number_key(&n);
+		number_clear(&n);
+		return key;
+	}
+	default:
+		return NULL;
+	}
+}
@@ -18,11 +18,14 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef struct _Number Number;
+
 /** @brief Event types */
 typedef enum
 {
@@ -37,10 +40,19 @@ typedef enum
 	EV_ARR_END      /**< JSON end of array */
 } ValidationEventTypes;
 
+/** @brief Representation of a number in EV_NUM event */
+typedef enum
+{
+	EV_NUM_TEXT = 0,  /**< Number as text from the JSON source, see value.string */
+	EV_NUM_INT64,     /**< Integer number from DOM, see value.integer */
+	EV_NUM_DOUBLE     /**< Floating point number from DOM, see value.floating */
+} ValidationNumberFormat;
+
 /** @brief Validation event data */
 typedef struct _ValidationEvent
 {
 	ValidationEventTypes type;    /**< @brief Type of event */
+	ValidationNumberFormat number_format; /**< @brief Representation of the value for EV_NUM */
 	union
 	{
 		bool boolean;             /**< @brief Boolean parameter for JSON boolean */
@@ -49,6 +61,8 @@ typedef struct _ValidationEvent
 			char const *ptr;      /**< @brief Pointer to the start of a text */
 			size_t len;           /**< @brief Length of the text */
 		} string;                 /**< @brief String parameter for every JSON type except boolean */
+		int64_t integer;          /**< @brief Integer parameter for JSON number (EV_NUM_INT64) */
+		double floating;          /**< @brief Floating point parameter for JSON number (EV_NUM_DOUBLE) */
 	} value;                      /**< @brief Associated value */
 } ValidationEvent;
 
@@ -71,6 +85,22 @@ ValidationEvent validation_event_boolean(bool val);
  */
 ValidationEvent validation_event_number(const char *str, size_t len);
 
+/** @brief Create validation event for JSON number from integer.
+ *
+ * Lets validators use the value without formatting and parsing it.
+ *
+ * @param[in] val Integer value
+ * @return Event for validation_check()
+ */
+ValidationEvent validation_event_number_int64(int64_t val);
+
+/** @brief Create validation event for JSON number from floating point value.
+ *
+ * @param[in] val Floating point value
+ * @return Event for validation_check()
+ */
+ValidationEvent validation_event_number_double(double val);
+
 /** @brief Create validation event for JSON string.
  *
  * @param[in] str Pointer to the string source
@@ -111,6 +141,41 @@ ValidationEvent validation_event_arr_start(void);
  */
 ValidationEvent validation_event_arr_end(void);
 
+/** @brief Get value of number event.
+ *
+ * @param[in] e Event of EV_NUM type in any representation
+ * @param[out] n Initialized number to set
+ * @return 0 on success, -1 if the text of the number can't be parsed.
+ */
+int validation_event_get_number(ValidationEvent const *e, Number *n);
+
+/** @brief Get value of number event as 64-bit integer without allocations.
+ *
+ * @param[in] e Event of EV_NUM type in any representation
+ * @param[out] value The integer
+ * @return false if the number isn't an integer, or can't be taken exactly
+ *         without validation_event_get_number() (see number_text_get_int64())
+ */
+bool validation_event_get_int64(ValidationEvent const *e, int64_t *value);
+
+/** @brief Get canonical key of a scalar value.
+ *
+ * The key is a type tag followed by the canonical form of the value,
+ * so that equal JSON values get equal keys.
+ *
+ * @param[in] e Event of null, boolean, number or string
+ * @return Newly allocated string (release with g_free()) or NULL if the event
+ *         doesn't carry a scalar value, or the value can't be represented.
+ */
+char* validation_event_get_value_key(ValidationEvent const *e);
+
+/** @brief Get canonical key of a number value.
+ *
+ * @return Newly allocated string, same as validation_event_get_value_key()
+ *         for the number event of this value.
+ */
+char* validation_event_get_number_key(Number const *n);
+
 #ifdef __cplusplus
 }
 #endif
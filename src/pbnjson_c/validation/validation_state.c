@@ -43,6 +43,7 @@ void validation_state_init(ValidationState *s,
 	s->notify = notify;
 	s->validator_stack = NULL;
 	s->context_stack = NULL;
+	s->probing = NULL;
 
 	validation_state_push_validator(s, validator);
 }
@@ -53,6 +54,13 @@ void validation_state_clear(ValidationState *s)
 		validation_state_pop_validator(s);
 }
 
+void validation_state_reset(ValidationState *s, Validator *validator)
+{
+	validation_state_clear(s);
+	s->probing = NULL;
+	validation_state_push_validator(s, validator);
+}
+
 Validator *validation_state_get_validator(ValidationState *s)
 {
 	if (!s->validator_stack)
@@ -62,6 +70,12 @@ Validator *validation_state_get_validator(ValidationState *s)
 
 void validation_state_push_validator(ValidationState *s, Validator *v)
 {
+	// A linked reference would only push its target, skip it right away.
+	// Chains of references are followed by their init_state().
+	Validator *target = validator_get_target(v);
+	if (target)
+		v = target;
+
 	s->validator_stack = g_slist_prepend(s->validator_stack, v);
 	validator_init_state(v, s);
 }
@@ -88,6 +88,7 @@ typedef struct _ValidationState
 	Notification *notify;        /** @brief To notify errors, default values. */
 	GSList *validator_stack;     /** @brief Validators being processed, current on top. */
 	GSList *context_stack;       /** @brief Data, which may be stored by validators. */
+	GSList *probing;             /** @brief References being probed by validator_may_accept(), to stop at recursion. */
 } ValidationState;
 
 
@@ -126,6 +127,15 @@ void validation_state_init(ValidationState *s,
 /** @brief Deinitialize validation instance. Counterpart to validation_state_init(). */
 void validation_state_clear(ValidationState *s);
 
+/** @brief Prepare the instance for the validation of another value.
+ *
+ * What is left from the previous validation is dropped, and the root validator
+ * is pushed again. The resolver and the notification callbacks are kept.
+ * @param[in] s This object
+ * @param[in] validator Root validator that the validation should comply
+ */
+void validation_state_reset(ValidationState *s, Validator *validator);
+
 /** @brief Get current validator, which is in the top of the stack. */
 Validator *validation_state_get_validator(ValidationState *s);
 
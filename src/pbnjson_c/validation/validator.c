@@ -59,6 +59,22 @@ bool validator_equals(Validator *v, Validator *other)
 	return true;
 }
 
+char* validator_get_value_key(Validator *v)
+{
+	assert(v && v->vtable);
+	if (!v->vtable->get_value_key)
+		return NULL;
+	return v->vtable->get_value_key(v);
+}
+
+void validator_collect_tags(Validator *v, ValidatorTagFunc func, void *ctxt)
+{
+	assert(v && v->vtable);
+	if (!v->vtable->collect_tags)
+		return;
+	v->vtable->collect_tags(v, func, ctxt);
+}
+
 bool validator_check(Validator *v, ValidationEvent const *e, ValidationState *s, void *ctxt)
 {
 	assert(v && v->vtable && v->vtable->check);
@@ -91,6 +107,22 @@ void validator_reactivate(Validator *v, ValidationState *s)
 	v->vtable->reactivate(v, s);
 }
 
+bool validator_may_accept(Validator *v, ValidationEvent const *e, ValidationState *s)
+{
+	assert(v && v->vtable);
+	if (!v->vtable->may_accept)
+		return true;
+	return v->vtable->may_accept(v, e, s);
+}
+
+Validator* validator_get_target(Validator *v)
+{
+	assert(v && v->vtable);
+	if (!v->vtable->get_target)
+		return NULL;
+	return v->vtable->get_target(v);
+}
+
 Validator* validator_set_object_properties(Validator *v, ObjectProperties *p)
 {
 	assert(v && v->vtable);
@@ -293,6 +325,34 @@ void validator_collect_uri(Validator *v, char const *document, UriResolver *u)
 	uri_scope_free(uri_scope);
 }
 
+void _validator_link(char const *key, Validator *v, void *ctxt)
+{
+	assert(v && v->vtable);
+	if (!v->vtable->link)
+		return;
+	v->vtable->link(key, v, ctxt);
+}
+
+void _validator_link_exit(char const *key, Validator *v, void *ctxt, Validator **new_v)
+{
+	assert(v && v->vtable);
+	if (!v->vtable->link_exit)
+		return;
+	v->vtable->link_exit(key, v, ctxt, new_v);
+}
+
+bool validator_link(Validator *v, UriResolver *u)
+{
+	LinkContext ctxt = {
+		.uri_resolver = u,
+		.failed = false,
+	};
+	_validator_link(ROOT_FRAGMENT, v, &ctxt);
+	validator_visit(v, _validator_link, _validator_link_exit, &ctxt);
+	_validator_link_exit(ROOT_FRAGMENT, v, &ctxt, NULL);
+	return !ctxt.failed;
+}
+
 void _validator_dump_enter(char const *key, Validator *v, void *ctxt)
 {
 	assert(v && v->vtable);
@@ -329,6 +389,22 @@ void validator_dump(Validator *v, FILE *f)
 	_validator_dump_exit(NULL, v, f, NULL);
 }
 
+bool validator_serialize(Validator *v, BlobWriter *w)
+{
+	assert(v && v->vtable);
+	if (!v->vtable->serialize)
+		return false;
+	return v->vtable->serialize(v, w);
+}
+
+PlanNode* validator_compile_plan(Validator *v, PlanBuilder *b)
+{
+	assert(v && v->vtable);
+	if (!v->vtable->compile_plan)
+		return NULL;
+	return v->vtable->compile_plan(v, b);
+}
+
 Validator* validator_set_number_minimum(Validator *v, Number *n)
 {
 	assert(v && v->vtable);
@@ -35,8 +35,20 @@ typedef struct _ArrayItems ArrayItems;
 typedef struct _UriResolver UriResolver;
 typedef struct _Pattern Pattern;
 typedef struct _Number Number;
+typedef struct _BlobWriter BlobWriter;
+typedef struct _PlanBuilder PlanBuilder;
+typedef struct _PlanNode PlanNode;
 typedef struct jvalue* jvalue_ref;
 
+/** @brief Receiver of the tags of objects, see ValidatorVtable::collect_tags.
+ *
+ * @param[in] name Name of the required property
+ * @param[in] value_key Key of its only value (see validator_get_value_key()),
+ *                      to be released by the receiver with g_free()
+ * @param[in] ctxt Pointer supplied by the caller
+ */
+typedef void (*ValidatorTagFunc)(char const *name, char *value_key, void *ctxt);
+
 
 /**
  * Table of virtual functions of Validator
@@ -55,6 +67,23 @@ typedef struct _ValidatorVtable
 	/** @brief Check if two validators are equal */
 	bool (*equals)(Validator *v, Validator *other);
 
+	/** @brief Get canonical key of the only value accepted by the validator.
+	 *
+	 * Validators of constant scalar values (members of enum, single-value
+	 * enums) return a newly allocated string, which can be looked up by
+	 * validation_event_get_value_key(). So do "allOf" with such a subschema,
+	 * which accept that value at most. Other validators return NULL.
+	 */
+	char* (*get_value_key)(Validator *v);
+
+	/** @brief List the tags of the accepted objects.
+	 *
+	 * A tag is a required property, which accepts a single scalar value.
+	 * Object validators call @p func for every such property. Alternatives
+	 * use the tags to tell their subschemas of objects apart.
+	 */
+	void (*collect_tags)(Validator *v, ValidatorTagFunc func, void *ctxt);
+
 	/** @name Functions used during validation
 	 *  @{
 	 */
@@ -90,6 +119,24 @@ typedef struct _ValidatorVtable
 	 */
 	void (*reactivate)(Validator *v, ValidationState *s);
 
+	/** @brief Check quickly if a value starting with the given event can be accepted.
+	 *
+	 * The check is static: it doesn't change the validation state and doesn't
+	 * report errors. Combining validators use it to avoid creating states
+	 * for subschemas, which can't match the value anyway. The answer may be
+	 * optimistic, but never pessimistic: if it's false, #check is guaranteed
+	 * to fail for this event.
+	 */
+	bool (*may_accept)(Validator *v, ValidationEvent const *e, ValidationState *s);
+
+	/** @brief Get the validator, which does the job for this one.
+	 *
+	 * Linked references are transparent for validation: the ValidationState
+	 * pushes their targets instead of them, saving a stack frame and the
+	 * indirection per reference. Other validators return NULL.
+	 */
+	Validator* (*get_target)(Validator *v);
+
 	/** @} */
 
 
@@ -140,10 +187,34 @@ typedef struct _ValidatorVtable
 	/** @brief Return to previous URI scope. */
 	void (*collect_uri_exit)(char const *key, Validator *v, void *ctxt, Validator **new_v);
 
+	/** @brief Bind the validator to the validators it refers to.
+	 *
+	 * Traverse the tree using #visit after all the documents have been resolved,
+	 * so that nothing has to be looked up (and remembered) during validation.
+	 */
+	void (*link)(char const *key, Validator *v, void *ctxt);
+
+	/** @brief Finish binding the validator, after its children have been bound. */
+	void (*link_exit)(char const *key, Validator *v, void *ctxt, Validator **new_v);
+
 	/** \brief Dump validator for debugging purposes. */
 	void (*dump_enter)(char const *key, Validator *v, void *ctxt);
 	/** \brief Finish dumping validator for debugging purposes. */
 	void (*dump_exit)(char const *key, Validator *v, void *ctxt, Validator **new_v);
+	/** @brief Write the validator into a precompiled schema blob.
+	 *
+	 * The validator puts its BlobTag followed by its constraints with
+	 * blob_write_*() functions, see schema_blob.h. Validators without
+	 * the function can't be precompiled.
+	 */
+	bool (*serialize)(Validator *v, BlobWriter *w);
+
+	/** @brief Describe the shape of the accepted values for the serializer.
+	 *
+	 * See serialization_plan.h. Validators without the function leave the
+	 * values to the generic serializer.
+	 */
+	PlanNode* (*compile_plan)(Validator *v, PlanBuilder *b);
 
 	/** @} */
 
@@ -202,6 +273,21 @@ void validator_unref(Validator *v);
 /** @brief Check if two validators are equal */
 bool validator_equals(Validator *v, Validator *other);
 
+/** @brief Get canonical key of the constant scalar value expected by the validator.
+ *
+ * @return Newly allocated string (release with g_free()) or NULL if the validator
+ *         accepts more than one value.
+ */
+char* validator_get_value_key(Validator *v);
+
+/** @brief List the tags of the objects accepted by the validator.
+ *
+ * @param[in] v This object
+ * @param[in] func Receiver of the tags, see ValidatorTagFunc
+ * @param[in] ctxt Pointer passed to @p func
+ */
+void validator_collect_tags(Validator *v, ValidatorTagFunc func, void *ctxt);
+
 /** @} */
 
 
@@ -227,6 +313,21 @@ bool validator_init_state(Validator *v, ValidationState *s);
 void validator_cleanup_state(Validator *v, ValidationState *s);
 void validator_reactivate(Validator *v, ValidationState *s);
 
+/** @brief Check if the validator can accept a value starting with the given event.
+ *
+ * @param[in] v This validator
+ * @param[in] e The first event of a value
+ * @param[in] s Validation state, which the value belongs to
+ * @return false if the value is certainly rejected by the validator
+ */
+bool validator_may_accept(Validator *v, ValidationEvent const *e, ValidationState *s);
+
+/** @brief Get the validator to be pushed to the validation stack instead of this one.
+ *
+ * @return The target of a linked reference (see validator_link()) or NULL
+ */
+Validator* validator_get_target(Validator *v);
+
 /** @brief Visit validator and its descendants.
  *
  * Call enter_func and exit_func for every contained (descendant) validator of this one.
@@ -257,10 +358,42 @@ void _validator_collect_schemas(Validator *v, void *ctxt);
 void _validator_collect_uri_exit(char const *key, Validator *v, void *ctxt, Validator **new_v);
 void validator_collect_uri(Validator *v, char const *document, UriResolver *u);
 
+/** @brief Context of validator_link() */
+typedef struct _LinkContext
+{
+	UriResolver *uri_resolver;  /**< @brief Resolver with all the documents of the schema */
+	bool failed;                /**< @brief Some reference couldn't be bound to its target */
+} LinkContext;
+
+void _validator_link(char const *key, Validator *v, void *ctxt);
+void _validator_link_exit(char const *key, Validator *v, void *ctxt, Validator **new_v);
+
+/** @brief Bind all the references in the tree to their targets.
+ *
+ * After linking the tree is never modified by validation, and can be used
+ * from several threads simultaneously.
+ * @param[in] v Root validator
+ * @param[in] u URI resolver with all the documents resolved
+ * @return false if some reference points to a missing schema
+ */
+bool validator_link(Validator *v, UriResolver *u);
+
 void _validator_dump_enter(char const *key, Validator *v, void *ctxt);
 void _validator_dump_exit(char const *key, Validator *v, void *ctxt, Validator **new_v);
 void validator_dump(Validator *v, FILE *f);
 
+/** @brief Write the validator into a precompiled schema blob.
+ *
+ * @return false if the validator doesn't support serialization.
+ */
+bool validator_serialize(Validator *v, BlobWriter *w);
+
+/** @brief Compile the serialization plan for the values accepted by the validator.
+ *
+ * @return NULL if the validator doesn't narrow down the values.
+ */
+PlanNode* validator_compile_plan(Validator *v, PlanBuilder *b);
+
 Validator* validator_set_object_properties(Validator *v, ObjectProperties *p);
 Validator* validator_set_object_additional_properties(Validator *v, Validator *additional);
 Validator* validator_set_object_required(Validator *v, ObjectRequired *p);
@@ -36,6 +36,12 @@ JGenerator::~JGenerator()
 {
 }
 
+static bool appendOutput(void *ctxt, const char *data, size_t len)
+{
+	static_cast<std::string *>(ctxt)->append(data, len);
+	return true;
+}
+
 bool JGenerator::toString(const JValue &obj, const JSchema& schema, std::string &asStr)
 {
 	if (m_resolver) {
@@ -49,13 +55,16 @@ bool JGenerator::toString(const JValue &obj, const JSchema& schema, std::string
 			return false;
 		}
 	}
-	const char *str = jvalue_tostring(obj.peekRaw(), schema.peek());
+	JSchemaInfo schemainfo;
+	jschema_info_init(&schemainfo, schema.peek(), NULL, NULL);
 
-	if (str == NULL) {
+	// Serialize straight into the string without a cached copy in the value
+	asStr.clear();
+	if (!jvalue_check_schema(obj.peekRaw(), &schemainfo) ||
+	    !jvalue_stringify_sink(obj.peekRaw(), &appendOutput, &asStr)) {
 		asStr = "";
 		return false;
 	}
-	asStr = str;
 	return true;
 }
 
@@ -81,19 +90,19 @@ std::string JGenerator::serialize(const JValue &val, const JSchema &schema, JRes
 
 std::string JGenerator::serialize(const JValue &val, bool quoteSingleString)
 {
-	const char *str = jvalue_tostring_simple(val.peekRaw());
-	if (UNLIKELY(str == NULL)) {
+	std::string str;
+	if (UNLIKELY(!jvalue_stringify_sink(val.peekRaw(), &appendOutput, &str))) {
 		return "";
 	}
 
 	if (!quoteSingleString && val.isString())
 	{
-		size_t length = strlen(str);
+		size_t length = str.size();
 		if ( (length >= 2) &&
 			 (str[0] == '"') &&
 			 (str[length-1] == '"') )
 		{
-			 return std::string(str+1, length-2);
+			 return str.substr(1, length-2);
 		}
 	}
 
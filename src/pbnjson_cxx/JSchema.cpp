@@ -20,6 +20,7 @@
 #include "JSchemaResolverWrapper.h"
 
 #include <pbnjson.h>
+#include <memory>
 
 using namespace std;
 
@@ -108,6 +109,13 @@ JSchema JSchema::fromFile(const char *file)
 	return res;
 }
 
+JSchema JSchema::fromCompiledFile(const char *file)
+{
+	JSchema res;
+	res.set(jschema_fload_compiled(file, &res.error));
+	return res;
+}
+
 JSchema JSchema::fromJValue(const JValue &value)
 {
 	JSchema res;
@@ -125,6 +133,11 @@ bool JSchema::resolve(JResolver &resolver)
 	return jschema_resolve(schema, &schemaResolver);
 }
 
+bool JSchema::freeze()
+{
+	return jschema_freeze(schema, &error);
+}
+
 JResult JSchema::validate(const JValue &value) const
 {
 	JResult res;
@@ -132,6 +145,38 @@ JResult JSchema::validate(const JValue &value) const
 	return res;
 }
 
+vector<JResult> JSchema::validateBatch(const vector<JValue> &values, unsigned threads) const
+{
+	vector<JResult> results(values.size());
+	if (values.empty())
+		return results;
+
+	vector<jvalue_ref> vals(values.size());
+	for (size_t i = 0; i < values.size(); ++i)
+		vals[i] = values[i].peekRaw();
+
+	// vector<bool> can't give away its storage
+	unique_ptr<bool[]> valid(new bool[values.size()]);
+	vector<jerror *> errs(values.size());
+	jvalue_validate_batch(&vals[0], vals.size(), schema, valid.get(), &errs[0], threads);
+
+	// The results take over the errors
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		if (valid[i])
+		{
+			jerror_free(errs[i]);
+			continue;
+		}
+		results[i].error = errs[i];
+		// An invalid value needs an error in its result, check it once more
+		// to get one if the batch couldn't report it
+		if (!errs[i])
+			results[i] = validate(values[i]);
+	}
+	return results;
+}
+
 JResult JSchema::apply(JValue &value) const
 {
 	JResult res;
@@ -376,6 +376,16 @@ JValue JValue::duplicate() const
 	return jvalue_duplicate(this->peekRaw());
 }
 
+void JValue::freeze()
+{
+	jvalue_freeze(m_jval);
+}
+
+void JValue::thaw()
+{
+	jvalue_thaw(m_jval);
+}
+
 JValue Object()
 {
 	return jobject_create();
@@ -489,6 +499,33 @@ bool JValue::put(size_t index, const JValue& value)
 	return jarray_set(m_jval, safe_value, value.peekRaw());
 }
 
+bool JValue::put(size_t index, JValue&& value)
+{
+	if (index >= static_cast<unsigned long>(std::numeric_limits<long>::max()))
+	{
+		PJ_LOG_WARN("Warning: Value cannot be safely cast to int.");
+		return false;
+	}
+	// Both jarray_put and jobject_put take over the references, instead of
+	// copying them
+	return jarray_put(m_jval, static_cast<long>(index), value.grabOwnership());
+}
+
+bool JValue::put(const JValue& key, JValue&& value)
+{
+	return jobject_put(m_jval, jvalue_copy(key.m_jval), value.grabOwnership());
+}
+
+bool JValue::put(const std::string& key, JValue&& value)
+{
+	return jobject_put(m_jval, JValue(key).grabOwnership(), value.grabOwnership());
+}
+
+bool JValue::put(const char *key, JValue&& value)
+{
+	return jobject_put(m_jval, JValue(key).grabOwnership(), value.grabOwnership());
+}
+
 bool JValue::put(const std::string& key, const JValue& value)
 {
 	return put(JValue(key), value);
@@ -534,6 +571,13 @@ JValue& JValue::operator<<(const JValue& element)
 	return *this;
 }
 
+JValue& JValue::operator<<(JValue&& element)
+{
+	if (!append(std::move(element)))
+		return Null();
+	return *this;
+}
+
 JValue& JValue::operator<<(const KeyValue& pair)
 {
 	if (!put(pair.first, pair.second))
@@ -541,16 +585,36 @@ JValue& JValue::operator<<(const KeyValue& pair)
 	return *this;
 }
 
+JValue& JValue::operator<<(KeyValue&& pair)
+{
+	if (!put(pair.first, std::move(pair.second)))
+		return Null();
+	return *this;
+}
+
 bool JValue::append(const JValue& value)
 {
 	return jarray_set(m_jval, jarray_size(m_jval), value.peekRaw());
 }
 
-std::string JValue::stringify(const char *indent)
+bool JValue::append(JValue&& value)
+{
+	return jarray_put(m_jval, jarray_size(m_jval), value.grabOwnership());
+}
+
+static bool appendOutput(void *ctxt, const char *data, size_t len)
 {
-	const char *str = jvalue_prettify(m_jval, indent);
+	static_cast<std::string *>(ctxt)->append(data, len);
+	return true;
+}
 
-	return str ? str : "";
+std::string JValue::stringify(const char *indent)
+{
+	std::string result;
+	// The output goes straight into the string without a cached copy in the value
+	if (!jvalue_prettify_sink(m_jval, indent, &appendOutput, &result))
+		result.clear();
+	return result;
 }
 
 bool JValue::hasKey(const std::string& key) const
@@ -79,6 +79,8 @@ int main(int argc, char *argv[])
 
 	string file_name;
 	string schema_file;
+	string compiled_file;
+	bool precompiled = false;
 
 	try
 	{
@@ -91,6 +93,10 @@ int main(int argc, char *argv[])
 			 "JSON file to validate (skip for stdin)")
 			("schema,s", value<string>(&schema_file)->default_value(schema_file),
 			 "File with JSON schema")
+			("precompiled,p", bool_switch(&precompiled),
+			 "The schema file has been precompiled with --compile")
+			("compile,c", value<string>(&compiled_file)->default_value(compiled_file),
+			 "Precompile the schema into the file and exit")
 			;
 
 		positional_options_description p;
@@ -124,6 +130,15 @@ int main(int argc, char *argv[])
 		unique_ptr<JSchema> schema;
 		if (schema_file.empty())
 			schema.reset(new JSchemaFragment("{}"));
+		else if (precompiled)
+		{
+			schema.reset(new JSchema(JSchema::fromCompiledFile(schema_file.c_str())));
+			if (!schema->isInitialized())
+			{
+				cerr << "Failed to load precompiled JSON schema " << schema_file << endl;
+				return 1;
+			}
+		}
 		else
 		{
 			schema.reset(new JSchemaFile(schema_file, schema_file, &error_handler, NULL));
@@ -134,6 +149,20 @@ int main(int argc, char *argv[])
 			}
 		}
 
+		if (!compiled_file.empty())
+		{
+			jerror *err = NULL;
+			if (!jschema_fsave_compiled(schema->peek(), compiled_file.c_str(), &err))
+			{
+				char message[256];
+				jerror_to_string(err, message, sizeof(message));
+				cerr << "Failed to precompile JSON schema: " << message << endl;
+				jerror_free(err);
+				return 1;
+			}
+			return 0;
+		}
+
 		// Try to parse the file to validate
 		JDomParser parser;
 		if (file_name.empty())
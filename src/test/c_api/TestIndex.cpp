@@ -0,0 +1,140 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <pbnjson.h>
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "TestUtils.hpp"
+
+using namespace std;
+
+namespace {
+
+class TestIndex : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		jerror *err = nullptr;
+		doc = jdom_create(j_cstr_to_buffer(R"({"id": "x", "devices": [)"
+		                                   R"({"id": "x", "n": 1},)"
+		                                   R"({"id": "y", "n": 1.0, "sub": {"id": "x"}},)"
+		                                   R"({"id": 7, "n": "1"}]})"),
+		                  jschema_all(), &err);
+		ASSERT_TRUE(jis_valid(doc));
+		index = jindex_create(doc, J_CSTR_TO_BUF("id"));
+	}
+
+	void TearDown() override
+	{
+		jindex_free(index);
+		j_release(&doc);
+	}
+
+	ssize_t count(jvalue_ref value)
+	{
+		auto v = mk_ptr(value);
+		return jindex_count(index, v.get());
+	}
+
+	vector<string> query(char const *str)
+	{
+		vector<string> result;
+		jerror *err = nullptr;
+		jquery_ptr q = jquery_create(str, &err);
+		EXPECT_TRUE(q != nullptr);
+		EXPECT_TRUE(jquery_init(q, doc, &err));
+		for (jvalue_ref v = jquery_next(q); jis_valid(v); v = jquery_next(q))
+			result.push_back(jvalue_stringify(v));
+		jquery_free(q);
+		return result;
+	}
+
+	jvalue_ref devices()
+	{
+		return jobject_get(doc, J_CSTR_TO_BUF("devices"));
+	}
+
+	jvalue_ref doc;
+	jindex_ref index;
+};
+
+} // namespace
+
+TEST_F(TestIndex, Lookup)
+{
+	EXPECT_EQ(3, count(jstring_create("x")));
+	EXPECT_EQ(1, count(jstring_create("y")));
+	EXPECT_EQ(1, count(jnumber_create_i64(7)));
+	EXPECT_EQ(1, count(jnumber_create_f64(7.0)));
+	EXPECT_EQ(0, count(jstring_create("7")));
+	EXPECT_EQ(0, count(jstring_create("z")));
+
+	// Members of an object are visited in no particular order
+	auto x = mk_ptr(jstring_create("x"));
+	set<jvalue_ref> owners;
+	for (ssize_t i = 0; i < 3; ++i)
+		owners.insert(jindex_get(index, x.get(), i));
+	EXPECT_EQ(set<jvalue_ref>({ doc, jarray_get(devices(), 0), jobject_get(jarray_get(devices(), 1), J_CSTR_TO_BUF("sub")) }), owners);
+	EXPECT_FALSE(jis_valid(jindex_get(index, x.get(), 3)));
+	EXPECT_FALSE(jis_valid(jindex_get(index, x.get(), -1)));
+}
+
+TEST_F(TestIndex, NumbersAreComparedByValue)
+{
+	jindex_ref n = jindex_create(doc, J_CSTR_TO_BUF("n"));
+	auto one = mk_ptr(jnumber_create_i64(1));
+	EXPECT_EQ(2, jindex_count(n, one.get()));
+	jindex_free(n);
+}
+
+TEST_F(TestIndex, Invalidation)
+{
+	auto z = mk_ptr(jstring_create("z"));
+	jobject_set(jarray_get(devices(), 0), J_CSTR_TO_BUF("id"), z.get());
+	EXPECT_EQ(2, count(jstring_create("x")));
+	EXPECT_EQ(1, count(jstring_create("z")));
+
+	jarray_append(devices(), jobject_create_var(jkeyval(J_CSTR_TO_JVAL("id"), jstring_create("x")), J_END_OBJ_DECL));
+	EXPECT_EQ(3, count(jstring_create("x")));
+
+	jarray_remove(devices(), 1);
+	EXPECT_EQ(2, count(jstring_create("x")));
+	EXPECT_EQ(0, count(jstring_create("y")));
+
+	jobject_remove(doc, J_CSTR_TO_BUF("devices"));
+	EXPECT_EQ(1, count(jstring_create("x")));
+	EXPECT_EQ(0, count(jnumber_create_i64(7)));
+}
+
+TEST_F(TestIndex, Query)
+{
+	vector<string> indexed = query(".id:val(\"x\")");
+	jindex_free(index);
+	index = nullptr;
+	EXPECT_EQ(query(".id:val(\"x\")"), indexed);
+	EXPECT_EQ(3u, indexed.size());
+
+	// The query sees the modifications too
+	index = jindex_create(doc, J_CSTR_TO_BUF("id"));
+	jobject_remove(doc, J_CSTR_TO_BUF("devices"));
+	EXPECT_EQ(vector<string>({ "\"x\"" }), query(".id:val(\"x\")"));
+	EXPECT_EQ(vector<string>({ "\"x\"" }), query(".id"));
+}
@@ -0,0 +1,203 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <pbnjson.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace {
+
+bool validate(char const *input, jschema_ref schema)
+{
+	jerror *err = nullptr;
+	bool res = jsax_parse_with_callbacks(j_cstr_to_buffer(input), schema, nullptr, nullptr, &err);
+	jerror_free(err);
+	return res;
+}
+
+class TestSchemaBatch : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		char tmpl[] = "/tmp/TestSchemaBatch.XXXXXX";
+		ASSERT_TRUE(mkdtemp(tmpl));
+		dir = tmpl;
+		mkdir((dir + "/net").c_str(), 0700);
+	}
+
+	void TearDown() override
+	{
+		for (auto const &f : written)
+			unlink((dir + "/" + f).c_str());
+		rmdir((dir + "/net").c_str());
+		rmdir(dir.c_str());
+	}
+
+	void write(string const &name, char const *text)
+	{
+		ofstream(dir + "/" + name) << text;
+		written.push_back(name);
+	}
+
+	string dir;
+	vector<string> written;
+};
+
+} // namespace
+
+TEST_F(TestSchemaBatch, CrossReferences)
+{
+	write("common.json", R"({"definitions": {"id": {"type": "integer", "minimum": 0}}})");
+	write("item.json", R"({
+		"type": "object",
+		"properties": {
+			"id": {"$ref": "common.json#/definitions/id"},
+			"owner": {"$ref": "net/config.json"}
+		}
+	})");
+	write("net/config.json", R"({
+		"type": "object",
+		"properties": {
+			"id": {"$ref": "../common.json#/definitions/id"},
+			"items": {"type": "array", "items": {"$ref": "../item.json"}}
+		}
+	})");
+
+	const char *files[] = {"common.json", "item.json", "net/config.json"};
+	jschema_ref schemas[3] = {};
+	jerror *err = nullptr;
+	ASSERT_TRUE(jschema_fcreate_batch(dir.c_str(), files, 3, schemas, nullptr, &err));
+	EXPECT_TRUE(err == nullptr);
+
+	EXPECT_TRUE(validate(R"({"id": 1, "owner": {"id": 2, "items": [{"id": 3}]}})", schemas[1]));
+	EXPECT_FALSE(validate(R"({"id": 1, "owner": {"id": 2, "items": [{"id": -3}]}})", schemas[1]));
+	EXPECT_TRUE(validate(R"({"items": [{"owner": {"id": 0}}]})", schemas[2]));
+	EXPECT_FALSE(validate(R"({"items": [{"owner": {"id": "a"}}]})", schemas[2]));
+
+	for (auto &s : schemas)
+		jschema_release(&s);
+}
+
+TEST_F(TestSchemaBatch, Missing)
+{
+	write("a.json", R"({"$ref": "b.json"})");
+
+	const char *files[] = {"a.json"};
+	jschema_ref schemas[1] = {};
+	jerror *err = nullptr;
+	EXPECT_FALSE(jschema_fcreate_batch(dir.c_str(), files, 1, schemas, nullptr, &err));
+	EXPECT_TRUE(err != nullptr);
+	EXPECT_TRUE(schemas[0] == nullptr);
+	jerror_free(err);
+}
+
+TEST_F(TestSchemaBatch, Fallback)
+{
+	write("a.json", R"({"type": "array", "items": {"$ref": "b.json"}})");
+
+	JSchemaResolver resolver{};
+	resolver.m_resolve = [](JSchemaResolverRef, jschema_ref *resolved) {
+		*resolved = jschema_create(j_cstr_to_buffer(R"({"type": "string"})"), nullptr);
+		return SCHEMA_RESOLVED;
+	};
+
+	const char *files[] = {"a.json"};
+	jschema_ref schemas[1] = {};
+	ASSERT_TRUE(jschema_fcreate_batch(dir.c_str(), files, 1, schemas, &resolver, nullptr));
+	EXPECT_TRUE(validate(R"(["a"])", schemas[0]));
+	EXPECT_FALSE(validate(R"([1])", schemas[0]));
+	jschema_release(&schemas[0]);
+}
+
+TEST_F(TestSchemaBatch, ParseError)
+{
+	write("good.json", R"({"type": "null"})");
+	write("bad.json", R"({"type": )");
+
+	const char *files[] = {"good.json", "bad.json", "absent.json"};
+	jschema_ref schemas[3] = {};
+	jerror *err = nullptr;
+	EXPECT_FALSE(jschema_fcreate_batch(dir.c_str(), files, 3, schemas, nullptr, &err));
+	EXPECT_TRUE(err != nullptr);
+	for (auto s : schemas)
+		EXPECT_TRUE(s == nullptr);
+	jerror_free(err);
+}
+
+TEST_F(TestSchemaBatch, ValidateValues)
+{
+	jschema_ref schema = jschema_create(j_cstr_to_buffer(R"({
+		"type": "object",
+		"properties": {"id": {"type": "integer", "minimum": 0}},
+		"required": ["id"]
+	})"), nullptr);
+	ASSERT_TRUE(schema != nullptr);
+
+	vector<jvalue_ref> vals;
+	for (int i = 0; i < 100; ++i)
+		vals.push_back(jobject_create_var(jkeyval(J_CSTR_TO_JVAL("id"), jnumber_create_i32(i % 10 == 9 ? -i : i)),
+		                                  J_END_OBJ_DECL));
+	vals.push_back(jarray_create(nullptr));
+
+	for (unsigned threads : {0u, 1u, 4u})
+	{
+		unique_ptr<bool[]> results(new bool[vals.size()]);
+		vector<jerror *> errs(vals.size());
+		EXPECT_EQ(90u, jvalue_validate_batch(vals.data(), vals.size(), schema,
+		                                     results.get(), errs.data(), threads));
+		for (size_t i = 0; i < vals.size(); ++i)
+		{
+			bool valid = i < 100 && i % 10 != 9;
+			EXPECT_EQ(valid, results[i]) << i;
+			EXPECT_EQ(valid, errs[i] == nullptr) << i;
+			jerror_free(errs[i]);
+		}
+	}
+
+	for (auto &v : vals)
+		j_release(&v);
+	jschema_release(&schema);
+}
+
+TEST_F(TestSchemaBatch, ValidateTexts)
+{
+	jschema_ref schema = jschema_create(j_cstr_to_buffer(R"({"type": "array", "items": {"type": "string"}})"), nullptr);
+	ASSERT_TRUE(schema != nullptr);
+
+	raw_buffer inputs[] = {
+		j_cstr_to_buffer(R"(["a", "b"])"),
+		j_cstr_to_buffer(R"(["a", 1])"),
+		j_cstr_to_buffer(R"(["a")"),
+		j_cstr_to_buffer(R"([])"),
+	};
+	bool results[4];
+	EXPECT_EQ(2u, jsax_validate_batch(inputs, 4, schema, results, nullptr, 2));
+	EXPECT_TRUE(results[0]);
+	EXPECT_FALSE(results[1]);
+	EXPECT_FALSE(results[2]);
+	EXPECT_TRUE(results[3]);
+
+	jschema_release(&schema);
+}
@@ -0,0 +1,158 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <pbnjson.h>
+
+namespace {
+
+jschema_ref child_schema = nullptr;
+
+JSchemaResolutionResult ChildResolver(JSchemaResolverRef resolver, jschema_ref *resolved)
+{
+	*resolved = jschema_copy(child_schema);
+	return SCHEMA_RESOLVED;
+}
+
+bool validate(char const *input, jschema_ref schema)
+{
+	jerror *err = nullptr;
+	bool res = jsax_parse_with_callbacks(j_cstr_to_buffer(input), schema, nullptr, nullptr, &err);
+	jerror_free(err);
+	return res;
+}
+
+} // namespace
+
+TEST(TestSchemaCache, SameText)
+{
+	jschema_ref s1 = jschema_create(j_cstr_to_buffer(R"({"type": "integer"})"), nullptr);
+	jschema_ref s2 = jschema_create(j_cstr_to_buffer(R"({"type": "integer"})"), nullptr);
+	jschema_ref s3 = jschema_parse(j_cstr_to_buffer(R"({"type": "integer"})"), 0, nullptr);
+	jschema_ref s4 = jschema_create(j_cstr_to_buffer(R"({"type": "string"})"), nullptr);
+	ASSERT_TRUE(s1 && s2 && s3 && s4);
+
+	EXPECT_EQ(s1, s2);
+	EXPECT_EQ(s1, s3);
+	EXPECT_NE(s1, s4);
+
+	EXPECT_TRUE(validate("1", s2));
+	EXPECT_FALSE(validate("\"a\"", s2));
+
+	jschema_release(&s1);
+	jschema_release(&s2);
+	jschema_release(&s3);
+	jschema_release(&s4);
+}
+
+TEST(TestSchemaCache, Clear)
+{
+	jschema_ref s1 = jschema_create(j_cstr_to_buffer(R"({"type": "boolean"})"), nullptr);
+	ASSERT_TRUE(s1 != nullptr);
+
+	jschema_cache_clear();
+
+	jschema_ref s2 = jschema_create(j_cstr_to_buffer(R"({"type": "boolean"})"), nullptr);
+	ASSERT_TRUE(s2 != nullptr);
+	EXPECT_NE(s1, s2);
+
+	EXPECT_TRUE(validate("true", s1));
+	EXPECT_FALSE(validate("null", s1));
+
+	jschema_release(&s1);
+	jschema_release(&s2);
+}
+
+TEST(TestSchemaCache, LeastRecentlyUsedEvicted)
+{
+	jschema_cache_clear();
+	jschema_cache_set_capacity(2);
+
+	auto create = [](char const *text) { return jschema_create(j_cstr_to_buffer(text), nullptr); };
+	jschema_ref a = create(R"({"type": "integer"})");
+	jschema_ref b = create(R"({"type": "string"})");
+	jschema_ref a2 = create(R"({"type": "integer"})");  // "a" is used again
+	jschema_ref c = create(R"({"type": "boolean"})");   // "b" is dropped
+	ASSERT_TRUE(a && b && a2 && c);
+	EXPECT_EQ(a, a2);
+
+	jschema_ref a3 = create(R"({"type": "integer"})");
+	jschema_ref b2 = create(R"({"type": "string"})");
+	EXPECT_EQ(a, a3);
+	EXPECT_NE(b, b2);
+
+	// The dropped schema stays valid for its owner
+	EXPECT_TRUE(validate("\"a\"", b));
+	EXPECT_FALSE(validate("1", b));
+
+	// Nothing is cached without capacity
+	jschema_cache_set_capacity(0);
+	jschema_ref c2 = create(R"({"type": "boolean"})");
+	jschema_ref c3 = create(R"({"type": "boolean"})");
+	EXPECT_NE(c, c2);
+	EXPECT_NE(c2, c3);
+
+	jschema_cache_set_capacity(JSCHEMA_CACHE_DEFAULT_CAPACITY);
+	for (jschema_ref s : { a, b, a2, c, a3, b2, c2, c3 })
+		jschema_release(&s);
+}
+
+TEST(TestSchemaCache, ErrorsReportedEveryTime)
+{
+	for (int i = 0; i < 2; ++i)
+	{
+		jerror *err = nullptr;
+		jschema_ref s = jschema_create(j_cstr_to_buffer(R"({"type": "foo"})"), &err);
+		EXPECT_TRUE(s == nullptr);
+		EXPECT_TRUE(err != nullptr);
+		jerror_free(err);
+	}
+}
+
+TEST(TestSchemaCache, UnresolvedNotShared)
+{
+	const char *text = R"({"$ref": "child.json"})";
+	jschema_ref s1 = jschema_create(j_cstr_to_buffer(text), nullptr);
+	jschema_ref s2 = jschema_create(j_cstr_to_buffer(text), nullptr);
+	ASSERT_TRUE(s1 && s2);
+	EXPECT_NE(s1, s2);
+
+	jschema_release(&s1);
+	jschema_release(&s2);
+}
+
+TEST(TestSchemaCache, SharedChildSurvivesResolution)
+{
+	child_schema = jschema_create(j_cstr_to_buffer(
+		R"({"definitions": {"a": {"type": "string"}}, "$ref": "#/definitions/a"})"), nullptr);
+	ASSERT_TRUE(child_schema != nullptr);
+
+	JSchemaResolver resolver{};
+	resolver.m_resolve = &ChildResolver;
+
+	jschema_ref parent = jschema_create(j_cstr_to_buffer(
+		R"({"type": "array", "items": {"$ref": "child.json"}})"), nullptr);
+	ASSERT_TRUE(parent != nullptr);
+	ASSERT_TRUE(jschema_resolve(parent, &resolver));
+
+	EXPECT_TRUE(validate(R"(["a", "b"])", parent));
+	EXPECT_FALSE(validate(R"(["a", 1])", parent));
+	jschema_release(&parent);
+
+	EXPECT_TRUE(validate("\"a\"", child_schema));
+	EXPECT_FALSE(validate("1", child_schema));
+	jschema_release(&child_schema);
+}
@@ -0,0 +1,195 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <pbnjson.h>
+#include <fstream>
+#include <string>
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+bool validate(char const *input, jschema_ref schema)
+{
+	jerror *err = nullptr;
+	bool res = jsax_parse_with_callbacks(j_cstr_to_buffer(input), schema, nullptr, nullptr, &err);
+	jerror_free(err);
+	return res;
+}
+
+class TestSchemaCompiled : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		file = "TestSchemaCompiled." + to_string(getpid()) + ".bin";
+	}
+
+	void TearDown() override
+	{
+		unlink(file.c_str());
+	}
+
+	jschema_ref roundtrip(char const *text)
+	{
+		jschema_ref schema = jschema_create(j_cstr_to_buffer(text), nullptr);
+		EXPECT_TRUE(schema != nullptr);
+		if (!schema)
+			return nullptr;
+
+		jerror *err = nullptr;
+		EXPECT_TRUE(jschema_fsave_compiled(schema, file.c_str(), &err));
+		jerror_free(err);
+		jschema_release(&schema);
+
+		jschema_ref loaded = jschema_fload_compiled(file.c_str(), &err);
+		EXPECT_TRUE(err == nullptr);
+		jerror_free(err);
+		return loaded;
+	}
+
+	string file;
+};
+
+} // namespace
+
+TEST_F(TestSchemaCompiled, Scalars)
+{
+	jschema_ref schema = roundtrip(R"({
+		"type": "object",
+		"properties": {
+			"i": {"type": "integer", "minimum": -5, "maximum": 10, "exclusiveMaximum": true},
+			"n": {"type": "number", "multipleOf": 0.25},
+			"s": {"type": "string", "minLength": 2, "maxLength": 4, "pattern": "^a"},
+			"b": {"type": "boolean"},
+			"e": {"enum": ["x", 1, null]}
+		},
+		"required": ["i"],
+		"additionalProperties": false
+	})");
+	ASSERT_TRUE(schema != nullptr);
+
+	EXPECT_TRUE(validate(R"({"i": 9})", schema));
+	EXPECT_FALSE(validate(R"({"i": 10})", schema));
+	EXPECT_FALSE(validate(R"({"i": -6})", schema));
+	EXPECT_FALSE(validate(R"({"i": 1.5})", schema));
+	EXPECT_FALSE(validate(R"({})", schema));
+	EXPECT_FALSE(validate(R"({"i": 1, "z": 1})", schema));
+	EXPECT_TRUE(validate(R"({"i": 1, "n": 1.75})", schema));
+	EXPECT_FALSE(validate(R"({"i": 1, "n": 1.3})", schema));
+	EXPECT_TRUE(validate(R"({"i": 1, "s": "abc"})", schema));
+	EXPECT_FALSE(validate(R"({"i": 1, "s": "bbc"})", schema));
+	EXPECT_FALSE(validate(R"({"i": 1, "s": "abcde"})", schema));
+	EXPECT_TRUE(validate(R"({"i": 1, "b": false})", schema));
+	EXPECT_TRUE(validate(R"({"i": 1, "e": null})", schema));
+	EXPECT_FALSE(validate(R"({"i": 1, "e": "y"})", schema));
+
+	jschema_release(&schema);
+}
+
+TEST_F(TestSchemaCompiled, ReferencesAndCombinators)
+{
+	jschema_ref schema = roundtrip(R"({
+		"definitions": {
+			"node": {
+				"type": "object",
+				"properties": {
+					"value": {"anyOf": [{"type": "integer"}, {"type": "string"}]},
+					"next": {"$ref": "#/definitions/node"}
+				},
+				"patternProperties": {"^x-": {"not": {"type": "null"}}}
+			}
+		},
+		"type": "array",
+		"items": {"$ref": "#/definitions/node"},
+		"minItems": 1,
+		"uniqueItems": true
+	})");
+	ASSERT_TRUE(schema != nullptr);
+
+	EXPECT_TRUE(validate(R"([{"value": 1, "next": {"value": "a"}}])", schema));
+	EXPECT_FALSE(validate(R"([{"value": 1, "next": {"value": true}}])", schema));
+	EXPECT_FALSE(validate(R"([])", schema));
+	EXPECT_FALSE(validate(R"([{"value": 1}, {"value": 1}])", schema));
+	EXPECT_TRUE(validate(R"([{"x-a": 1}])", schema));
+	EXPECT_FALSE(validate(R"([{"x-a": null}])", schema));
+
+	jschema_release(&schema);
+}
+
+TEST_F(TestSchemaCompiled, Defaults)
+{
+	jschema_ref schema = roundtrip(R"({
+		"type": "object",
+		"properties": {"a": {"type": "integer", "default": 42}}
+	})");
+	ASSERT_TRUE(schema != nullptr);
+
+	jvalue_ref parsed = jdom_create(j_cstr_to_buffer("{}"), schema, nullptr);
+	ASSERT_TRUE(jis_object(parsed));
+	int32_t a = 0;
+	EXPECT_EQ(CONV_OK, jnumber_get_i32(jobject_get(parsed, J_CSTR_TO_BUF("a")), &a));
+	EXPECT_EQ(42, a);
+	j_release(&parsed);
+
+	jschema_release(&schema);
+}
+
+TEST_F(TestSchemaCompiled, Corrupted)
+{
+	jschema_ref schema = roundtrip(R"({"type": "string", "pattern": "^a"})");
+	ASSERT_TRUE(schema != nullptr);
+	jschema_release(&schema);
+
+	string data;
+	{
+		ifstream in(file, ios::binary);
+		data.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+	}
+	ASSERT_GT(data.size(), 16u);
+
+	for (size_t len : {data.size() - 1, size_t(16), size_t(0)})
+	{
+		ofstream(file, ios::binary | ios::trunc).write(data.data(), len);
+		jerror *err = nullptr;
+		EXPECT_TRUE(jschema_fload_compiled(file.c_str(), &err) == nullptr);
+		EXPECT_TRUE(err != nullptr);
+		jerror_free(err);
+	}
+
+	string bad_magic = data;
+	bad_magic[0] ^= 0xff;
+	ofstream(file, ios::binary | ios::trunc).write(bad_magic.data(), bad_magic.size());
+	jerror *err = nullptr;
+	EXPECT_TRUE(jschema_fload_compiled(file.c_str(), &err) == nullptr);
+	jerror_free(err);
+}
+
+TEST_F(TestSchemaCompiled, UnresolvedRejected)
+{
+	jschema_ref schema = jschema_create(j_cstr_to_buffer(R"({"$ref": "other.json"})"), nullptr);
+	ASSERT_TRUE(schema != nullptr);
+
+	jerror *err = nullptr;
+	EXPECT_FALSE(jschema_fsave_compiled(schema, file.c_str(), &err));
+	EXPECT_TRUE(err != nullptr);
+	jerror_free(err);
+
+	jschema_release(&schema);
+}
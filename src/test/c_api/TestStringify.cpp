@@ -17,6 +17,8 @@
 #include <pbnjson.h>
 #include <gtest/gtest.h>
 #include <jvalue_stringify.h>
+#include <string>
+#include <vector>
 
 TEST(JStringify, jvalue_prettify)
 {
@@ -50,3 +52,257 @@ TEST(JStringify, jvalue_prettify)
 
 	j_release(&json);
 }
+
+TEST(JStringify, escaping)
+{
+	jvalue_ref json = jstring_create_copy(j_cstr_to_buffer("long enough to be scanned by words \"\\/\b\f\n\r\t\x01\x1f\x7f \xc3\xa9"));
+	EXPECT_STREQ("\"long enough to be scanned by words \\\"\\\\/\\b\\f\\n\\r\\t\\u0001\\u001F\x7f \xc3\xa9\"",
+	             jvalue_stringify(json));
+	j_release(&json);
+
+	json = jstring_create_copy(j_str_to_buffer("a\0b", 3));
+	EXPECT_STREQ("\"a\\u0000b\"", jvalue_stringify(json));
+	j_release(&json);
+
+	json = jobject_create_var(jkeyval(J_CSTR_TO_JVAL("k\"ey"), jarray_create_var(NULL, jnull(), jboolean_create(true),
+	                                                                                jboolean_create(false), J_END_ARRAY_DECL)),
+	                          jkeyval(J_CSTR_TO_JVAL("e"), jobject_create()),
+	                          J_END_OBJ_DECL);
+	const char *json_str = jvalue_stringify(json);
+	EXPECT_TRUE(strcmp(json_str, "{\"k\\\"ey\":[null,true,false],\"e\":{}}") == 0 ||
+	            strcmp(json_str, "{\"e\":{},\"k\\\"ey\":[null,true,false]}") == 0);
+	j_release(&json);
+}
+
+TEST(JStringify, numbers)
+{
+	jvalue_ref json = jarray_create_var(NULL,
+	                                    jnumber_create_i64(0),
+	                                    jnumber_create_i64(-7),
+	                                    jnumber_create_i64(INT64_MAX),
+	                                    jnumber_create_i64(INT64_MIN),
+	                                    jnumber_create_f64(2.0),
+	                                    jnumber_create_f64(-0.0),
+	                                    jnumber_create_f64(42323.0234234),
+	                                    jnumber_create_f64(1e20),
+	                                    jnumber_create(j_cstr_to_buffer("1.50")),
+	                                    J_END_ARRAY_DECL);
+	EXPECT_STREQ("[0,-7,9223372036854775807,-9223372036854775808,2,-0,42323.0234234,1e+20,1.50]",
+	             jvalue_stringify(json));
+	j_release(&json);
+}
+
+namespace {
+
+bool collect(void *ctxt, const char *data, size_t len)
+{
+	static_cast<std::string *>(ctxt)->append(data, len);
+	return true;
+}
+
+bool refuse(void *ctxt, const char *data, size_t len)
+{
+	return false;
+}
+
+} // namespace
+
+TEST(JStringify, to_buffer)
+{
+	jvalue_ref json = jobject_create_var(jkeyval(J_CSTR_TO_JVAL("a"), jnumber_create_i64(12)), J_END_OBJ_DECL);
+
+	char buf[16];
+	size_t len = 0;
+	EXPECT_TRUE(jvalue_stringify_to(json, buf, sizeof(buf), &len));
+	EXPECT_STREQ("{\"a\":12}", buf);
+	EXPECT_EQ(8u, len);
+
+	EXPECT_TRUE(jvalue_stringify_to(json, buf, 9, &len));
+	EXPECT_STREQ("{\"a\":12}", buf);
+
+	len = 0;
+	EXPECT_FALSE(jvalue_stringify_to(json, buf, 8, &len));
+	EXPECT_EQ(8u, len);
+	EXPECT_FALSE(jvalue_stringify_to(json, nullptr, 0, &len));
+	EXPECT_EQ(8u, len);
+
+	EXPECT_FALSE(jvalue_stringify_to(nullptr, buf, sizeof(buf), &len));
+
+	j_release(&json);
+}
+
+TEST(JStringify, to_sink)
+{
+	std::string long_str(10000, 'x');
+	jvalue_ref json = jarray_create_var(NULL, jstring_create_copy(j_str_to_buffer(long_str.data(), long_str.size())),
+	                                    jnumber_create_i64(1), J_END_ARRAY_DECL);
+
+	std::string out;
+	EXPECT_TRUE(jvalue_stringify_sink(json, &collect, &out));
+	EXPECT_EQ("[\"" + long_str + "\",1]", out);
+
+	EXPECT_FALSE(jvalue_stringify_sink(json, &refuse, nullptr));
+	EXPECT_FALSE(jvalue_stringify_sink(nullptr, &collect, &out));
+
+	j_release(&json);
+}
+
+TEST(JStringify, drop)
+{
+	jvalue_ref json = jnumber_create_i64(5);
+	EXPECT_STREQ("5", jvalue_stringify(json));
+	jvalue_stringify_drop(json);
+	jvalue_stringify_drop(nullptr);
+	EXPECT_STREQ("5", jvalue_stringify(json));
+	j_release(&json);
+}
+
+TEST(JStringify, serializer)
+{
+	std::string long_str(10000, 'x');
+	long_str[5000] = '\n';
+	jvalue_ref json = jobject_create_var(
+		jkeyval(J_CSTR_TO_JVAL("s"), jstring_create_copy(j_str_to_buffer(long_str.data(), long_str.size()))),
+		jkeyval(J_CSTR_TO_JVAL("a"), jarray_create_var(NULL, jarray_create(NULL), jobject_create(),
+		                                               J_CSTR_TO_JVAL(""), jnumber_create_f64(0.5), J_END_ARRAY_DECL)),
+		J_END_OBJ_DECL);
+	std::string expected = jvalue_stringify(json);
+
+	for (size_t chunk : {1, 7, 4096, 100000})
+	{
+		jserializer_ref serializer = jserializer_new(json);
+		ASSERT_TRUE(serializer != nullptr);
+
+		std::string out;
+		std::vector<char> buf(chunk);
+		ssize_t len;
+		while ((len = jserializer_read(serializer, buf.data(), buf.size())) > 0)
+		{
+			out.append(buf.data(), len);
+			if (static_cast<size_t>(len) < chunk)
+				break;
+		}
+		EXPECT_GE(len, 0);
+		EXPECT_EQ(0, jserializer_read(serializer, buf.data(), buf.size()));
+		EXPECT_EQ(expected, out);
+
+		jserializer_release(&serializer);
+		EXPECT_TRUE(serializer == nullptr);
+	}
+
+	j_release(&json);
+}
+
+TEST(JStringify, serializer_keeps_value)
+{
+	jvalue_ref json = jarray_create_var(NULL, jnumber_create_i64(1), jnumber_create_i64(2), J_END_ARRAY_DECL);
+	jserializer_ref serializer = jserializer_new(json);
+	j_release(&json);
+
+	char buf[16];
+	ASSERT_EQ(5, jserializer_read(serializer, buf, sizeof(buf)));
+	EXPECT_EQ("[1,2]", std::string(buf, 5));
+	jserializer_release(&serializer);
+}
+
+TEST(JStringify, incremental)
+{
+	jvalue_ref inner = jobject_create_var(jkeyval(J_CSTR_TO_JVAL("x"), jnumber_create_i64(1)), J_END_OBJ_DECL);
+	jvalue_ref list = jarray_create_var(NULL, jnumber_create_i64(1), jarray_create(NULL), J_END_ARRAY_DECL);
+	jvalue_ref json = jobject_create_var(jkeyval(J_CSTR_TO_JVAL("inner"), jvalue_copy(inner)),
+	                                     jkeyval(J_CSTR_TO_JVAL("list"), jvalue_copy(list)),
+	                                     jkeyval(J_CSTR_TO_JVAL("s"), J_CSTR_TO_JVAL("text")),
+	                                     J_END_OBJ_DECL);
+
+	auto check = [json]() {
+		std::string incremental = jvalue_stringify_incremental(json);
+		EXPECT_EQ(std::string(jvalue_stringify(json)), incremental);
+	};
+
+	check();
+	check();
+
+	jobject_set(inner, J_CSTR_TO_BUF("x"), jnumber_create_i64(2));
+	check();
+	EXPECT_TRUE(std::string(jvalue_stringify_incremental(json)).find("\"x\":2") != std::string::npos);
+
+	jarray_append(jarray_get(list, 1), J_CSTR_TO_JVAL("nested"));
+	check();
+
+	jarray_put(list, 0, jobject_create());
+	check();
+
+	jarray_remove(list, 1);
+	check();
+
+	jobject_remove(json, J_CSTR_TO_BUF("s"));
+	check();
+
+	jvalue_ref other = jarray_create_var(NULL, jnumber_create_i64(7), J_END_ARRAY_DECL);
+	jarray_splice_append(other, list, SPLICE_TRANSFER);
+	check();
+	j_release(&other);
+
+	jvalue_stringify_drop(json);
+	check();
+
+	j_release(&inner);
+	j_release(&list);
+	j_release(&json);
+}
+
+TEST(JStringify, planned)
+{
+	jschema_ref schema = jschema_create(j_cstr_to_buffer(R"({
+		"type": "object",
+		"properties": {
+			"name": {"type": "string"},
+			"quo\"ted": {"type": "integer"},
+			"items": {"type": "array", "items": {"$ref": "#/definitions/item"}}
+		},
+		"definitions": {
+			"item": {"type": "object", "properties": {"id": {"type": "number"}, "next": {"$ref": "#/definitions/item"}}}
+		}
+	})"), nullptr);
+	ASSERT_TRUE(schema != nullptr);
+
+	jstringify_plan_ref plan = jstringify_plan_new(schema, nullptr);
+	ASSERT_TRUE(plan != nullptr);
+	jschema_release(&schema);
+
+	const char *inputs[] = {
+		R"({"name": "a\nb", "quo\"ted": 1, "items": [{"id": 1.5, "next": {"id": 2}}, {"id": "x"}], "extra": [true, null]})",
+		// Types don't match the plan
+		R"({"name": 1, "quo\"ted": "s", "items": {"id": 1}})",
+		R"([1, "a"])",
+		R"("text")",
+	};
+	for (const char *input : inputs)
+	{
+		jvalue_ref json = jdom_create(j_cstr_to_buffer(input), jschema_all(), nullptr);
+		ASSERT_TRUE(jis_valid(json));
+		std::string expected = jvalue_stringify(json);
+		EXPECT_EQ(expected, jvalue_stringify_planned(json, plan));
+		j_release(&json);
+	}
+
+	// Keys created by hand aren't interned
+	jvalue_ref json = jobject_create_var(jkeyval(jstring_create("name"), J_CSTR_TO_JVAL("b")), J_END_OBJ_DECL);
+	EXPECT_STREQ("{\"name\":\"b\"}", jvalue_stringify_planned(json, plan));
+	j_release(&json);
+
+	jstringify_plan_release(&plan);
+	EXPECT_TRUE(plan == nullptr);
+}
+
+TEST(JStringify, planned_unresolved)
+{
+	jschema_ref schema = jschema_create(j_cstr_to_buffer(R"({"$ref": "other.json"})"), nullptr);
+	ASSERT_TRUE(schema != nullptr);
+
+	jerror *err = nullptr;
+	EXPECT_TRUE(jstringify_plan_new(schema, &err) == nullptr);
+	EXPECT_TRUE(err != nullptr);
+	jerror_free(err);
+	jschema_release(&schema);
+}
@@ -0,0 +1,235 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <pbnjson.h>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "TestUtils.hpp"
+
+using namespace std;
+
+namespace {
+
+const char *input = R"({"a": [1, "two", {"b": null}], "c": {"d": true}, "e": [], "f": {}, "g": -1.5e3, "": "",)"
+                    R"( "items": [{"id": 1, "kind": "lamp"}, {"id": 2, "kind": "lamp"}, {"id": 3, "kind": "switch"}]})";
+
+class TestTape : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		jerror *err = nullptr;
+		tape = jtape_create(j_cstr_to_buffer(input), jschema_all(), &err);
+		ASSERT_TRUE(tape != nullptr);
+		root = jtape_root(tape);
+	}
+
+	void TearDown() override
+	{
+		jtape_free(tape);
+	}
+
+	jtape_cursor get(char const *key)
+	{
+		return jtape_object_get(root, j_cstr_to_buffer(key));
+	}
+
+	static string text(raw_buffer buf)
+	{
+		return buf.m_str ? string(buf.m_str, buf.m_len) : "<null>";
+	}
+
+	jtape_ref tape;
+	jtape_cursor root;
+};
+
+} // namespace
+
+TEST_F(TestTape, Navigation)
+{
+	EXPECT_EQ(JV_OBJECT, jtape_type(root));
+	EXPECT_EQ(7, jtape_size(root));
+	EXPECT_FALSE(jtape_is_valid(jtape_next(root)));
+
+	jtape_cursor a = get("a");
+	EXPECT_EQ(JV_ARRAY, jtape_type(a));
+	EXPECT_EQ(3, jtape_size(a));
+	EXPECT_EQ("a", text(jtape_key(a)));
+	EXPECT_EQ("two", text(jtape_get_string(jtape_array_get(a, 1))));
+	EXPECT_EQ("<null>", text(jtape_key(jtape_array_get(a, 1))));
+	EXPECT_EQ(JV_NULL, jtape_type(jtape_object_get(jtape_array_get(a, 2), J_CSTR_TO_BUF("b"))));
+	EXPECT_TRUE(jtape_is_valid(jtape_object_get(jtape_array_get(a, 2), J_CSTR_TO_BUF("b"))));
+	EXPECT_TRUE(jtape_get_bool(jtape_object_get(get("c"), J_CSTR_TO_BUF("d"))));
+	EXPECT_EQ("", text(jtape_get_string(get(""))));
+
+	EXPECT_FALSE(jtape_is_valid(jtape_array_get(a, 3)));
+	EXPECT_FALSE(jtape_is_valid(jtape_array_get(a, -1)));
+	EXPECT_FALSE(jtape_is_valid(jtape_array_get(root, 0)));
+	EXPECT_FALSE(jtape_is_valid(get("missing")));
+	EXPECT_EQ(-1, jtape_size(get("missing")));
+
+	EXPECT_EQ(0, jtape_size(get("e")));
+	EXPECT_FALSE(jtape_is_valid(jtape_first(get("e"))));
+	EXPECT_EQ(0, jtape_size(get("f")));
+	EXPECT_FALSE(jtape_is_valid(jtape_first(get("f"))));
+}
+
+TEST_F(TestTape, Iteration)
+{
+	vector<string> keys;
+	for (jtape_cursor c = jtape_first(root); jtape_is_valid(c); c = jtape_next(c))
+		keys.push_back(text(jtape_key(c)));
+	EXPECT_EQ(vector<string>({ "a", "c", "e", "f", "g", "", "items" }), keys);
+
+	vector<string> kinds;
+	for (jtape_cursor c = jtape_first(get("items")); jtape_is_valid(c); c = jtape_next(c))
+		kinds.push_back(text(jtape_get_string(jtape_object_get(c, J_CSTR_TO_BUF("kind")))));
+	EXPECT_EQ(vector<string>({ "lamp", "lamp", "switch" }), kinds);
+}
+
+TEST_F(TestTape, ManyMembers)
+{
+	// The keys of the bigger objects are looked up by a table
+	string json = "{";
+	for (int i = 19; i >= 0; --i)
+		json += "\"k" + to_string(i) + "\": " + to_string(i) + ", ";
+	json += "\"k3\": 333, \"\": -1}";
+
+	jtape_ref many = jtape_create(j_cstr_to_buffer(json.c_str()), jschema_all(), nullptr);
+	ASSERT_TRUE(many != nullptr);
+	jtape_cursor top = jtape_root(many);
+	EXPECT_EQ(22, jtape_size(top));
+	for (int i = 0; i < 20; ++i)
+	{
+		string key = "k" + to_string(i);
+		jtape_cursor member = jtape_object_get(top, j_cstr_to_buffer(key.c_str()));
+		EXPECT_EQ(key, text(jtape_key(member)));
+		EXPECT_EQ(to_string(i), text(jtape_get_number_raw(member)));
+	}
+	EXPECT_EQ("-1", text(jtape_get_number_raw(jtape_object_get(top, J_CSTR_TO_BUF("")))));
+	EXPECT_FALSE(jtape_is_valid(jtape_object_get(top, J_CSTR_TO_BUF("k"))));
+	EXPECT_FALSE(jtape_is_valid(jtape_object_get(top, J_CSTR_TO_BUF("k20"))));
+
+	// The members keep their order
+	vector<string> keys;
+	for (jtape_cursor c = jtape_first(top); jtape_is_valid(c); c = jtape_next(c))
+		keys.push_back(text(jtape_key(c)));
+	ASSERT_EQ(22u, keys.size());
+	EXPECT_EQ("k19", keys.front());
+	EXPECT_EQ("k3", keys[20]);
+	jtape_free(many);
+}
+
+TEST_F(TestTape, Numbers)
+{
+	int64_t i = 0;
+	double d = 0;
+	EXPECT_EQ(CONV_OK, jtape_get_i64(jtape_array_get(get("a"), 0), &i));
+	EXPECT_EQ(1, i);
+	EXPECT_EQ(CONV_OK, jtape_get_f64(get("g"), &d));
+	EXPECT_EQ(-1500.0, d);
+	EXPECT_EQ("-1.5e3", text(jtape_get_number_raw(get("g"))));
+
+	EXPECT_EQ(CONV_BAD_ARGS, jtape_get_i64(get("c"), &i));
+	EXPECT_EQ("<null>", text(jtape_get_number_raw(get("c"))));
+	EXPECT_EQ("<null>", text(jtape_get_string(get("g"))));
+}
+
+TEST_F(TestTape, ToJValue)
+{
+	jerror *err = nullptr;
+	auto dom = mk_ptr(jdom_create(j_cstr_to_buffer(input), jschema_all(), &err));
+	ASSERT_TRUE(jis_valid(dom.get()));
+
+	auto back = mk_ptr(jtape_to_jvalue(root));
+	EXPECT_TRUE(jvalue_equal(dom.get(), back.get()));
+
+	auto two = mk_ptr(jtape_to_jvalue(jtape_array_get(get("a"), 1)));
+	EXPECT_TRUE(jstring_equal2(two.get(), J_CSTR_TO_BUF("two")));
+	EXPECT_FALSE(jis_valid(jtape_to_jvalue(get("missing"))));
+}
+
+TEST_F(TestTape, ToJValueDeep)
+{
+	// The conversion doesn't recurse, the depth is only limited by the DOM itself
+	const int depth = 10000;
+	string deep;
+	for (int i = 0; i < depth; ++i)
+		deep += i % 2 ? "{\"a\": " : "[";
+	deep += "null";
+	for (int i = depth - 1; i >= 0; --i)
+		deep += i % 2 ? "}" : "]";
+
+	jtape_ref deep_tape = jtape_create(j_str_to_buffer(deep.data(), deep.size()), jschema_all(), nullptr);
+	ASSERT_TRUE(deep_tape != nullptr);
+	auto dom = mk_ptr(jtape_to_jvalue(jtape_root(deep_tape)));
+	jtape_free(deep_tape);
+
+	int levels = 0;
+	for (jvalue_ref v = dom.get(); jis_valid(v); ++levels)
+		v = jis_array(v) ? jarray_get(v, 0) : jobject_get(v, J_CSTR_TO_BUF("a"));
+	EXPECT_EQ(depth + 1, levels);
+}
+
+TEST_F(TestTape, Image)
+{
+	raw_buffer image = jtape_image(tape);
+	vector<uint64_t> copy((image.m_len + 7) / 8);
+	memcpy(copy.data(), image.m_str, image.m_len);
+
+	jtape_ref opened = jtape_open(j_str_to_buffer(reinterpret_cast<char *>(copy.data()), image.m_len), nullptr);
+	ASSERT_TRUE(opened != nullptr);
+	auto back = mk_ptr(jtape_to_jvalue(jtape_root(opened)));
+	auto orig = mk_ptr(jtape_to_jvalue(root));
+	EXPECT_TRUE(jvalue_equal(orig.get(), back.get()));
+	jtape_free(opened);
+
+	jerror *err = nullptr;
+	EXPECT_EQ(nullptr, jtape_open(j_str_to_buffer(reinterpret_cast<char *>(copy.data()), image.m_len - 1), &err));
+	EXPECT_TRUE(err != nullptr);
+	jerror_free(err);
+
+	EXPECT_EQ(nullptr, jtape_open(j_str_to_buffer(reinterpret_cast<char *>(copy.data()) + 1, image.m_len - 1), nullptr));
+
+	EXPECT_EQ(nullptr, jtape_image(nullptr).m_str);
+	EXPECT_EQ(0u, jtape_image(nullptr).m_len);
+
+	// Damaged words are never followed out of the image. The words go after
+	// the three words of the header, the key "a" is the third one.
+	copy[5] = ~uint64_t(0);
+	opened = jtape_open(j_str_to_buffer(reinterpret_cast<char *>(copy.data()), image.m_len), nullptr);
+	ASSERT_TRUE(opened != nullptr);
+	auto damaged = mk_ptr(jtape_to_jvalue(jtape_root(opened)));
+	jtape_free(opened);
+}
+
+TEST_F(TestTape, Errors)
+{
+	jerror *err = nullptr;
+	EXPECT_EQ(nullptr, jtape_create(J_CSTR_TO_BUF("{\"a\": [1, }"), jschema_all(), &err));
+	EXPECT_TRUE(err != nullptr);
+	jerror_free(err);
+
+	auto schema = mk_ptr(jschema_create(J_CSTR_TO_BUF(R"({"type": "array"})"), nullptr));
+	EXPECT_EQ(nullptr, jtape_create(J_CSTR_TO_BUF("{}"), schema.get(), nullptr));
+
+	EXPECT_EQ(nullptr, jtape_fopen("/nonexistent/tape", nullptr));
+}
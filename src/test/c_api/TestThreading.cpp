@@ -102,3 +102,157 @@ TEST(Threading, schema)
 
 	EXPECT_TRUE(jvalue_validate(value.get(), schema.get(), &error)) << toText(error);
 }
+
+TEST(Threading, frozenSchema)
+{
+	const size_t nthreads = 8, nsteps = 1000;
+	auto schema_buf = J_CSTR_TO_BUF(R"({
+		"definitions": {
+			"node": {
+				"type": "object",
+				"properties": {
+					"value": {"anyOf": [{"type": "integer"}, {"$ref": "#/definitions/node"}]},
+					"children": {"type": "array", "items": {"$ref": "#/definitions/node"}}
+				},
+				"patternProperties": {"^x": {"type": "string"}, "^xy": {"minLength": 1}}
+			}
+		},
+		"$ref": "#/definitions/node"
+	})");
+
+	jerror *error = nullptr;
+	auto schema = mk_ptr(jschema_create(schema_buf, &error));
+	ASSERT_FALSE(error) << toText(error);
+	ASSERT_TRUE(jschema_freeze(schema.get(), &error)) << toText(error);
+
+	auto valid = J_CSTR_TO_BUF(R"({"value": {"value": 1}, "xy": "a",
+		"children": [{"value": 2, "children": [{"value": {"children": []}}]}]})");
+	auto invalid = J_CSTR_TO_BUF(R"({"children": [{"value": {"value": "a"}}]})");
+
+	const auto f = [&]() {
+		for (size_t step = 0; step < nsteps; ++step)
+		{
+			auto copy = mk_ptr(jschema_copy(schema.get()));
+			// Freezing again doesn't touch the schema being used
+			EXPECT_TRUE(jschema_freeze(copy.get(), nullptr));
+			jerror *err = nullptr;
+			EXPECT_TRUE(jsax_parse_with_callbacks(valid, copy.get(), nullptr, nullptr, &err)) << toText(err);
+			jerror_free(err), err = nullptr;
+			EXPECT_FALSE(jsax_parse_with_callbacks(invalid, copy.get(), nullptr, nullptr, &err));
+			jerror_free(err);
+		}
+	};
+
+	std::array<std::thread, nthreads> threads;
+	for (auto &thread : threads) thread = std::thread(f);
+	for (auto &thread : threads) thread.join();
+}
+
+TEST(Threading, freezeUnresolved)
+{
+	auto schema = mk_ptr(jschema_create(J_CSTR_TO_BUF(R"({"$ref": "other.json"})"), nullptr));
+	ASSERT_TRUE(schema.get());
+
+	jerror *error = nullptr;
+	EXPECT_FALSE(jschema_freeze(schema.get(), &error));
+	EXPECT_TRUE(error);
+	jerror_free(error);
+}
+
+TEST(Threading, confinedDom)
+{
+	const size_t nthreads = 8, nsteps = 1000;
+
+	jerror *error = nullptr;
+	auto dom = mk_ptr(jdom_create_ex(J_CSTR_TO_BUF(R"({"a": [1, "two", {"b": null}], "c": {"d": true}})"),
+	                                 jschema_all(), DOMOPT_THREAD_CONFINED, &error));
+	ASSERT_TRUE(jis_valid(dom.get())) << toText(error);
+
+	// The owner thread counts the references as usual
+	for (size_t step = 0; step < nsteps; ++step)
+	{
+		auto copy = mk_ptr(jvalue_copy(jobject_get(dom.get(), J_CSTR_TO_BUF("a"))));
+		ASSERT_EQ(3, jarray_size(copy.get()));
+	}
+
+	// A part of the DOM put into a shared container is shared with it
+	auto shared = mk_ptr(jobject_create());
+	ASSERT_TRUE(jobject_set(shared.get(), J_CSTR_TO_BUF("c"), jobject_get(dom.get(), J_CSTR_TO_BUF("c"))));
+
+	jvalue_share(dom.get());
+
+	const auto f = [&]() {
+		for (size_t step = 0; step < nsteps; ++step)
+		{
+			auto a = mk_ptr(jvalue_copy(jobject_get(dom.get(), J_CSTR_TO_BUF("a"))));
+			auto two = mk_ptr(jvalue_copy(jarray_get(a.get(), 1)));
+			ASSERT_TRUE(jstring_equal2(two.get(), J_CSTR_TO_BUF("two")));
+			auto c = mk_ptr(jvalue_copy(jobject_get(shared.get(), J_CSTR_TO_BUF("c"))));
+			ASSERT_TRUE(jis_object(c.get()));
+		}
+	};
+
+	std::array<std::thread, nthreads> threads;
+	for (auto &thread : threads) thread = std::thread(f);
+	for (auto &thread : threads) thread.join();
+}
+
+TEST(Threading, frozenDom)
+{
+	const size_t nthreads = 8, nsteps = 1000;
+
+	jerror *error = nullptr;
+	auto dom = mk_ptr(jdom_create(J_CSTR_TO_BUF(R"({"a": [1, "two", {"b": null}], "c": {"d": true}})"),
+	                              jschema_all(), &error));
+	ASSERT_TRUE(jis_valid(dom.get())) << toText(error);
+
+	jvalue_freeze(dom.get());
+	EXPECT_TRUE(jvalue_is_frozen(jobject_get(dom.get(), J_CSTR_TO_BUF("a"))));
+
+	// The keys are interned, and shared with other DOMs, they stay counted
+	jobject_iter it;
+	jobject_key_value key_value;
+	ASSERT_TRUE(jobject_iter_init(&it, dom.get()));
+	ASSERT_TRUE(jobject_iter_next(&it, &key_value));
+	EXPECT_FALSE(jvalue_is_frozen(key_value.key));
+
+	// Frozen containers can't be modified
+	jvalue_ref a = jobject_get(dom.get(), J_CSTR_TO_BUF("a"));
+	EXPECT_FALSE(jobject_remove(dom.get(), J_CSTR_TO_BUF("c")));
+	EXPECT_FALSE(jobject_put(dom.get(), J_CSTR_TO_JVAL("e"), jnumber_create_i64(1)));
+	EXPECT_FALSE(jarray_remove(a, 0));
+	EXPECT_FALSE(jarray_append(a, jnull()));
+	EXPECT_FALSE(jarray_insert(a, 0, jnull()));
+	EXPECT_EQ(3, jarray_size(a));
+	EXPECT_EQ(2u, jobject_size(dom.get()));
+
+	// Nothing is stored within the frozen values
+	EXPECT_TRUE(jindex_create(dom.get(), J_CSTR_TO_BUF("b")) == nullptr);
+
+	// A duplicate is an ordinary value
+	auto dup = mk_ptr(jvalue_duplicate(dom.get()));
+	EXPECT_FALSE(jvalue_is_frozen(dup.get()));
+	EXPECT_TRUE(jvalue_equal(dom.get(), dup.get()));
+	EXPECT_TRUE(jobject_remove(dup.get(), J_CSTR_TO_BUF("c")));
+
+	const auto f = [&]() {
+		for (size_t step = 0; step < nsteps; ++step)
+		{
+			auto root = mk_ptr(jvalue_copy(dom.get()));
+			auto two = mk_ptr(jvalue_copy(jarray_get(jobject_get(root.get(), J_CSTR_TO_BUF("a")), 1)));
+			ASSERT_TRUE(jstring_equal2(two.get(), J_CSTR_TO_BUF("two")));
+			char buf[64];
+			ASSERT_TRUE(jvalue_stringify_to(jobject_get(root.get(), J_CSTR_TO_BUF("c")), buf, sizeof(buf), nullptr));
+			ASSERT_STREQ(R"({"d":true})", buf);
+		}
+	};
+
+	std::array<std::thread, nthreads> threads;
+	for (auto &thread : threads) thread = std::thread(f);
+	for (auto &thread : threads) thread.join();
+
+	// The snapshot is released as usual after it's thawed
+	jvalue_thaw(dom.get());
+	EXPECT_FALSE(jvalue_is_frozen(a));
+	EXPECT_TRUE(jarray_append(a, jnull()));
+}
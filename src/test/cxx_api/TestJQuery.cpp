@@ -16,6 +16,8 @@
 
 #include <gtest/gtest.h>
 #include <pbnjson.hpp>
+#include <thread>
+#include <vector>
 
 using namespace std;
 using namespace pbnjson;
@@ -82,3 +84,88 @@ TEST(TestJQuery, TestCPP11)
 	}
 	ASSERT_EQ(0, cnt);
 }
+
+TEST(TestJQuery, TestIndependentIterators)
+{
+	JQuery q { "string.k1" };
+	ASSERT_TRUE((bool)q);
+
+	// Every iterator walks the JSON on its own
+	auto first = q.begin(json);
+	auto second = q.begin(json);
+	ASSERT_TRUE(first != q.end());
+	ASSERT_TRUE(second != q.end());
+	EXPECT_EQ(*first, *second);
+
+	++first;
+	ASSERT_TRUE(first != q.end());
+	EXPECT_EQ(JValue("zxc"), *first);
+	EXPECT_EQ(JValue("qwe"), *second);
+
+	++first;
+	EXPECT_FALSE(first != q.end());
+
+	// A copy starts at the same position, but moves on its own
+	auto copy = second;
+	++copy;
+	ASSERT_TRUE(copy != q.end());
+	EXPECT_EQ(JValue("zxc"), *copy);
+	EXPECT_EQ(JValue("qwe"), *second);
+	++second;
+	EXPECT_FALSE(copy != second);
+}
+
+TEST(TestJQuery, TestThreads)
+{
+	const JQuery q { ":has(number) > .k2, string.k1" };
+	ASSERT_TRUE((bool)q);
+
+	vector<int> counts(4, 0);
+	vector<thread> threads;
+	for (size_t i = 0; i < counts.size(); ++i)
+	{
+		threads.emplace_back([&q, &counts, i]()
+		{
+			for (int n = 0; n < 100; ++n)
+				for (auto it = q.begin(json); it != q.end(); ++it)
+					++counts[i];
+		});
+	}
+	for (auto &t : threads)
+		t.join();
+
+	for (auto c : counts)
+		EXPECT_EQ(100 * 4, c);
+}
+
+TEST(TestJQuery, TestThreadsIndex)
+{
+	auto doc = JDomParser::fromString(R"([{ "k1": "zxc" }, { "k1": "qwe" }, { "k1": "zxc", "k2": 1 }])");
+	jindex_ref index = jindex_create(doc.peekRaw(), J_CSTR_TO_BUF("k1"));
+	ASSERT_TRUE(index != nullptr);
+
+	// The index is dropped, the threads race to build it again
+	ASSERT_TRUE(doc.append(JObject{{"k1", "zxc"}}));
+
+	const JQuery q { ".k1:val(\"zxc\")" };
+	ASSERT_TRUE((bool)q);
+
+	vector<int> counts(4, 0);
+	vector<thread> threads;
+	for (size_t i = 0; i < counts.size(); ++i)
+	{
+		threads.emplace_back([&q, &doc, &counts, i]()
+		{
+			for (int n = 0; n < 100; ++n)
+				for (auto it = q.begin(doc); it != q.end(); ++it)
+					++counts[i];
+		});
+	}
+	for (auto &t : threads)
+		t.join();
+
+	for (auto c : counts)
+		EXPECT_EQ(100 * 3, c);
+
+	jindex_free(index);
+}
@@ -163,6 +163,40 @@ TEST(JValue, jarray_remove)
 	EXPECT_EQ(R"(["item1","item2"])", array.stringify());
 }
 
+TEST(JValue, move_into_containers)
+{
+	pj::JValue array = pj::Array();
+	pj::JValue item = pj::JArray{1, 2};
+	EXPECT_TRUE(array.append(std::move(item)));
+	EXPECT_TRUE(item.isNull());
+	EXPECT_TRUE(array.put(1, pj::JValue("second")));
+	EXPECT_TRUE(array.put(size_t(4), pj::JValue(true)));
+	EXPECT_FALSE(array.put(-1, pj::JValue(false)));
+	array << pj::JValue(3) << 4;
+	EXPECT_EQ(R"([[1,2],"second",null,null,true,3,4])", array.stringify());
+
+	// The moved value is shared by the container, not copied
+	pj::JValue obj = pj::Object();
+	pj::JValue nested = pj::Object();
+	pj::JValue alias = nested;
+	const pj::JValue key("key");
+	EXPECT_TRUE(obj.put(key, std::move(nested)));
+	EXPECT_TRUE(obj.put(std::string("s"), pj::JValue("v")));
+	EXPECT_TRUE(obj.put("n", pj::JValue(1)));
+	obj << pj::JValue::KeyValue("kv", pj::JValue(2));
+	alias.put("a", pj::JValue(nullptr));
+	EXPECT_EQ(pj::JObject({{"key", pj::JObject{{"a", nullptr}}}, {"s", "v"}, {"n", 1}, {"kv", 2}}), obj);
+
+	// The value is taken over, even if it can't be put
+	pj::JValue number(1);
+	pj::JValue lost(2);
+	EXPECT_FALSE(number.put("k", std::move(lost)));
+	EXPECT_TRUE(lost.isNull());
+	lost = pj::JValue(3);
+	EXPECT_FALSE(number.append(std::move(lost)));
+	EXPECT_TRUE(lost.isNull());
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
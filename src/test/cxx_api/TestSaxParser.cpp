@@ -0,0 +1,122 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <pbnjson.hpp>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace pbnjson;
+
+namespace {
+
+const char *input = R"({"null": null, "bool": true, "number": -1.5e3, "string": "a\"b", "array": [1, "qwerty", {}]})";
+
+struct Recorder : JSaxParser<Recorder>
+{
+	Recorder(const JSchema &schema = JSchema::AllSchema())
+		: JSaxParser<Recorder>(schema)
+	{}
+
+	vector<string> events;
+
+	bool jsonObjectOpen() { events.push_back("{"); return true; }
+	bool jsonObjectKey(raw_buffer key) { events.push_back("k:" + string(key.m_str, key.m_len)); return true; }
+	bool jsonObjectClose() { events.push_back("}"); return true; }
+	bool jsonArrayOpen() { events.push_back("["); return true; }
+	bool jsonArrayClose() { events.push_back("]"); return true; }
+	bool jsonString(raw_buffer s) { events.push_back("s:" + string(s.m_str, s.m_len)); return true; }
+	bool jsonNumber(raw_buffer n) { events.push_back("n:" + string(n.m_str, n.m_len)); return true; }
+	bool jsonBoolean(bool truth) { events.push_back(truth ? "true" : "false"); return true; }
+	bool jsonNull() { events.push_back("null"); return true; }
+};
+
+const vector<string> expected = {
+	"{", "k:null", "null", "k:bool", "true", "k:number", "n:-1.5e3", "k:string", "s:a\"b",
+	"k:array", "[", "n:1", "s:qwerty", "{", "}", "]", "}",
+};
+
+// Only the keys are interesting, the rest is accepted by the defaults
+struct KeyCounter : JSaxParser<KeyCounter>
+{
+	size_t count = 0;
+	bool jsonObjectKey(raw_buffer key) { ++count; return true; }
+};
+
+} // namespace
+
+TEST(JSaxParser, Events)
+{
+	Recorder r;
+	EXPECT_TRUE(r.parse(input));
+	EXPECT_EQ(expected, r.events);
+}
+
+TEST(JSaxParser, DefaultCallbacks)
+{
+	KeyCounter k;
+	EXPECT_TRUE(k.parse(input));
+	EXPECT_EQ(5u, k.count);
+
+	EXPECT_FALSE(k.parse(R"({"a": )"));
+}
+
+TEST(JSaxParser, Stream)
+{
+	Recorder r;
+	string text(input);
+	for (size_t i = 0; i < text.size(); i += 7)
+		ASSERT_TRUE(r.feed(JInput(text.data() + i, min<size_t>(7, text.size() - i))));
+	EXPECT_TRUE(r.end());
+	EXPECT_EQ(expected, r.events);
+
+	// The next document after reset
+	r.reset();
+	r.events.clear();
+	EXPECT_TRUE(r.feed("[null]"));
+	EXPECT_TRUE(r.end());
+	EXPECT_EQ(vector<string>({ "[", "null", "]" }), r.events);
+
+	r.reset();
+	EXPECT_FALSE(r.feed("[nul}"));
+	EXPECT_NE(nullptr, r.getError());
+}
+
+TEST(JSaxParser, Schema)
+{
+	JSchema schema = JSchema::fromString(R"({"type": "object", "properties": {"a": {"type": "string"}}})");
+	ASSERT_TRUE(schema.isInitialized());
+
+	Recorder good(schema);
+	EXPECT_TRUE(good.parse(R"({"a": "b"})"));
+	EXPECT_EQ(vector<string>({ "{", "k:a", "s:b", "}" }), good.events);
+
+	Recorder bad(schema);
+	EXPECT_FALSE(bad.parse(R"({"a": 1})"));
+}
+
+TEST(JSaxParser, Abort)
+{
+	struct Stop : JSaxParser<Stop>
+	{
+		size_t strings = 0;
+		bool jsonString(raw_buffer s) { return ++strings < 2; }
+	} stop;
+
+	EXPECT_FALSE(stop.parse(R"(["a", "b", "c"])"));
+	EXPECT_EQ(2u, stop.strings);
+}
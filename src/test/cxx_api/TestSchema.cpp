@@ -298,4 +298,21 @@ TEST(TestSchema, FromJValue)
 	EXPECT_EQ("2.718", value["toggleBits"].stringify());
 }
 
+TEST(TestSchema, ValidateBatch)
+{
+	auto schema = JSchema::fromString(R"({"type": "integer", "minimum": 0})");
+	ASSERT_FALSE(schema.isError()) << "Schema error: " << schema.errorString();
+
+	std::vector<JValue> values { JValue(1), JValue(-1), JValue("a"), JValue(42) };
+	for (unsigned threads : {0u, 2u})
+	{
+		auto results = schema.validateBatch(values, threads);
+		ASSERT_EQ(values.size(), results.size());
+		EXPECT_FALSE(results[0].isError());
+		EXPECT_TRUE(results[1].isError());
+		EXPECT_TRUE(results[2].isError());
+		EXPECT_FALSE(results[3].isError());
+	}
+}
+
 // ex: set noet ts=4 sw=4 tw=80: